@@ -1,12 +1,20 @@
 @echo off
 
 set CommonCompilerFlags= -MTd -Gm- -GR- -WX -nologo -Od -Oi -Zi -DMVM_DEBUG_MEMORY=1
+set BenchCompilerFlags= -MT -Gm- -GR- -WX -nologo -O2 -Oi -Zi -DMVM_DEBUG_MEMORY=1
+set AnalyzerCompilerFlags= -MT -Gm- -GR- -WX -nologo -O2 -Oi -Zi
 set CommonLinkerFlags=/INCREMENTAL:NO 
 
 set CompiledFiles=..\mvm_debug_memory_test.c
+set RingTestFiles=..\mvm_debug_memory_ring_test.c
+set BenchFiles=..\mvm_debug_memory_bench.c
+set AnalyzerFiles=..\mvm_debug_memory_analyzer.c
 
 IF NOT EXIST .\build mkdir .\build
 pushd .\build
 del *.pdb > NUL 2> NUL
 cl %CommonCompilerFlags% %CompiledFiles% /link %CommonLinkerFlags% 
+cl %CommonCompilerFlags% %RingTestFiles% /link %CommonLinkerFlags% 
+cl %BenchCompilerFlags% %BenchFiles% /link %CommonLinkerFlags% 
+cl %AnalyzerCompilerFlags% %AnalyzerFiles% /link %CommonLinkerFlags% 
 popd
@@ -0,0 +1,24 @@
+#!/bin/sh
+
+CommonCompilerFlags="-g -O0 -Wall -DMVM_DEBUG_MEMORY=1"
+BenchCompilerFlags="-g -O2 -Wall -DMVM_DEBUG_MEMORY=1"
+AnalyzerCompilerFlags="-g -O2 -Wall"
+PreloadCompilerFlags="-g -O2 -Wall -shared -fPIC -fno-omit-frame-pointer -ftls-model=initial-exec"
+CommonLinkerFlags="-lm -pthread"
+
+CompiledFiles=../mvm_debug_memory_test.c
+RingTestFiles=../mvm_debug_memory_ring_test.c
+BenchFiles=../mvm_debug_memory_bench.c
+AnalyzerFiles=../mvm_debug_memory_analyzer.c
+PreloadFiles=../mvm_debug_memory_preload.c
+
+CC=${CC:-cc}
+
+mkdir -p ./build
+cd ./build
+$CC $CommonCompilerFlags $CompiledFiles -o mvm_debug_memory_test $CommonLinkerFlags
+$CC $CommonCompilerFlags $RingTestFiles -o mvm_debug_memory_ring_test $CommonLinkerFlags
+$CC $BenchCompilerFlags $BenchFiles -o mvm_debug_memory_bench $CommonLinkerFlags
+$CC $AnalyzerCompilerFlags $AnalyzerFiles -o mvm_debug_memory_analyzer $CommonLinkerFlags
+$CC $PreloadCompilerFlags $PreloadFiles -o libmvm_debug_memory.so -ldl $CommonLinkerFlags
+cd ..
@@ -5,1223 +5,8705 @@
 /*
     TODO(Marko): A list of things that would be nice to have:
                  
-                 - I think I need a linked list/growable array structure to 
-                   store history for specific debug memory info to e.g. pair 
-                   malloc() with realloc() and free(), and to pair turn-on 
-                   with turn-off
-                 - A file-writing system that can write memory information to 
-                   logs. 
-                 - Print should also tell you how many bytes of memory the 
-                   GlobalDebugInfoList is using in total. (Currently just tells 
-                   you how many list elements were allocated on the heap). 
-                 - Store the address of the variable that is allocated or 
-                   freed. Possibly include old and new addresses for realloc?
-                 - Track reallocations! Make sure you trace the same variable 
-                   as it gets repeatedly allocated
-                 - A configurable "max number of debug information" so that we  
-                   eventually stop adding to the list, thereby preventing 
-                   unfettered growth of the debug info
-                 - Explicit way to free the GlobalDebugInfoList -- perf reasons
-                   (Granular API design)
-                 - Heap Corruption detection? Like Page-aligned malloc. Perhaps 
-                   this is too heavyweight and deserving of its status as a 
-                   separate tool. 
+                 - Guard pages in front of a block as well, as an option, so 
+                   that underruns fault as they happen too. Right now only 
+                   the canaries in front of a guarded block catch them. 
 
 */
 
-#define DEBUG_STRING_INITIAL_SIZE 32
-#define DEBUG_INFO_LIST_INITIAL_SIZE 8
-#define DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE 4
-#define FREED_NOT_APPLICABLE -1
-
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include <errno.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <malloc.h>
+    #include <io.h>
+    #include <dbghelp.h>
+    #if defined(_MSC_VER)
+        #pragma comment(lib, "dbghelp.lib")
+    #endif
+#else
+    #include <sys/mman.h>
+    #include <signal.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <time.h>
+    #include <sched.h>
+    #include <pthread.h>
+    #if defined(__GLIBC__) || defined(__APPLE__)
+        #include <execinfo.h>
+    #endif
+    #if defined(__APPLE__)
+        #include <malloc/malloc.h>
+    #elif defined(__linux__)
+        #include <malloc.h>
+    #endif
+    #if defined(__GLIBC__) && !defined(_GNU_SOURCE)
+        // NOTE(Marko): Only declared by <pthread.h> under _GNU_SOURCE. 
+        int pthread_getattr_np(pthread_t Thread, pthread_attr_t *Attributes);
+    #endif
+#endif
+
+#if defined(__cplusplus) && defined(MVM_DEBUG_MEMORY) && \
+    defined(MVM_DEBUG_MEMORY_NEW)
+    #include <new>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+// NOTE(Marko): The allocator underneath the tool. Override these before 
+//              including the header when the names malloc/realloc/free etc. 
+//              do not reach the C library directly, as in the LD_PRELOAD 
+//              build. 
+#if !defined(MVM_DEBUG_REAL_MALLOC)
+    #define MVM_DEBUG_REAL_MALLOC(Size) malloc(Size)
+    #define MVM_DEBUG_REAL_REALLOC(Memory, Size) realloc(Memory, Size)
+    #define MVM_DEBUG_REAL_FREE(Memory) free(Memory)
+#endif
+#if !defined(MVM_DEBUG_REAL_CALLOC)
+    #define MVM_DEBUG_REAL_CALLOC(Count, Size) calloc(Count, Size)
+#endif
+#if defined(_WIN32)
+    #if !defined(MVM_DEBUG_REAL_ALIGNED_MALLOC)
+        #define MVM_DEBUG_REAL_ALIGNED_MALLOC(Size, Alignment) \
+            _aligned_malloc(Size, Alignment)
+        #define MVM_DEBUG_REAL_ALIGNED_FREE(Memory) _aligned_free(Memory)
+    #endif
+#elif !defined(MVM_DEBUG_REAL_POSIX_MEMALIGN)
+    #define MVM_DEBUG_REAL_POSIX_MEMALIGN(Memory, Alignment, Size) \
+        posix_memalign(Memory, Alignment, Size)
+#endif
 
 /* 
     NOTE(Marko): USAGE: #define DEBUG_MEMORY 
                         #include "mvm_debug_memory.h"
 
                         OR pass DDEBUG_MEMORY=1 as a compiler flag. 
+
+                        malloc, calloc, realloc, reallocarray, free, strdup, 
+                        strndup, and aligned_alloc/posix_memalign (POSIX) or 
+                        _aligned_malloc/_aligned_free/_strdup (Windows) are 
+                        tracked in every file that includes the header. 
+
+                        To bound the tool's memory, or to sample instead of 
+                        tracking every allocation, fill in an 
+                        mvm_debug_memory_config and pass it to 
+                        MVMDebugMemoryInitialize() before the first 
+                        MVMTurnOnDebugInfo(). 
+
+                        On POSIX systems link with -lm. 
 */
 
 //
-// NOTE(Marko): Debug string for internal use.
+// NOTE(Marko): Platform layer. The handful of OS and compiler services the 
+//              tool needs: pages, atomics, a spin lock, thread-local storage, 
+//              threads, files and a cheap timestamp. 
 //
 
-typedef struct mvm_debug_memory_string
-{
-    size_t Length;
-    size_t MemoryAllocated;
-    char *Contents;
+#if defined(_MSC_VER)
+    #define MVM_DEBUG_THREAD_LOCAL __declspec(thread)
+    #define MVM_DEBUG_NOINLINE __declspec(noinline)
+#else
+    #define MVM_DEBUG_THREAD_LOCAL __thread
+    #define MVM_DEBUG_NOINLINE __attribute__((noinline))
+#endif
+
+// NOTE(Marko): Frame-pointer stack walking needs the frame record layout 
+//              {saved frame pointer, return address}, which GCC and Clang use 
+//              on these targets when frame pointers are kept. 
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+    #define MVM_DEBUG_FRAME_POINTER_WALK 1
+#else
+    #define MVM_DEBUG_FRAME_POINTER_WALK 0
+#endif
 
-} mvm_debug_memory_string;
+// NOTE(Marko): SSE2 is part of every x86-64 target, so using it needs no 
+//              compiler flags. 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define MVM_DEBUG_SSE2 1
+#else
+    #define MVM_DEBUG_SSE2 0
+#endif
 
+#define DEBUG_LOCK_SPINS_BEFORE_YIELD 64
 
-mvm_debug_memory_string ConstStringToMVMDebugMemoryString(const char *String)
+
+void *MVMPlatformAllocatePages(size_t Size)
 {
-    mvm_debug_memory_string Result;
-    Result.Length = strlen(String);
-    Result.MemoryAllocated = 1;
-    while(Result.MemoryAllocated <= Result.Length)
+    void *Result = 0;
+#if defined(_WIN32)
+    Result = VirtualAlloc(0, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    Result = mmap(0, Size, 
+                  PROT_READ | PROT_WRITE, 
+                  MAP_PRIVATE | MAP_ANONYMOUS, 
+                  -1, 0);
+    if(Result == MAP_FAILED)
     {
-        Result.MemoryAllocated *= 2;
+        Result = 0;
     }
+#endif
+    return(Result);
+}
 
-    Result.Contents = (char *)malloc(Result.MemoryAllocated);
 
-    int CharIndex = 0;
-    while(String[CharIndex])
-    {
-        Result.Contents[CharIndex] = String[CharIndex];
-        CharIndex++;
-    }
+void MVMPlatformFreePages(void *Memory, size_t Size)
+{
+#if defined(_WIN32)
+    VirtualFree(Memory, 0, MEM_RELEASE);
+#else
+    munmap(Memory, Size);
+#endif
+}
 
-    // NOTE(Marko): Null terminate
-    Result.Contents[CharIndex] = '\0';
 
-    return Result;
+size_t MVMPlatformGetPageSize(void)
+{
+    size_t Result = 0;
+#if defined(_WIN32)
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    Result = SystemInfo.dwPageSize;
+#else
+    Result = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    return(Result);
 }
 
 
-mvm_debug_memory_string *CreateEmptyMVMDebugString(void)
+// NOTE(Marko): Makes pages from MVMPlatformAllocatePages() fault on any 
+//              access. Returns 0 on failure. 
+int MVMPlatformProtectPages(void *Memory, size_t Size)
 {
-    mvm_debug_memory_string *Result = (mvm_debug_memory_string *)malloc(sizeof *Result);
+#if defined(_WIN32)
+    DWORD OldProtection;
+    return(VirtualProtect(Memory, Size, PAGE_NOACCESS, &OldProtection) != 0);
+#else
+    return(mprotect(Memory, Size, PROT_NONE) == 0);
+#endif
+}
 
-    if(Result)
-    {
-        Result->Length = 0;
-        Result->MemoryAllocated = DEBUG_STRING_INITIAL_SIZE;
-        Result->Contents = (char *)malloc(Result->MemoryAllocated);
-        if(!Result->Contents)
-        {
-            Result->MemoryAllocated = 0;
-            Result->Contents = 0;
-            printf("malloc failed while allocating memory for contents of memory debug string.\n\tAttempted to allocate %d bytes.\n\tFile: %s\n\tLine %d\n",
-            Result->MemoryAllocated,
-            __FILE__, 
-            __LINE__);
-        }
-    }
-    else
-    {
-        printf("malloc failed while allocating memory for mvm_debug_memory_string struct.\n\tAttempted to allocate %d bytes.\n\tFile: %s\n\tLine: %d\n", 
-            (sizeof *Result), 
-            __FILE__, 
-            __LINE__);
-    }
 
-    return Result;
+// NOTE(Marko): Bytes the C library actually reserved for a block from the 
+//              allocator underneath the tool, or 0 where that cannot be 
+//              asked. Alignment is what the block was requested with, or 0 
+//              for plain malloc() blocks. 
+size_t MVMPlatformUsableSize(void *Memory, size_t Alignment)
+{
+    size_t Result = 0;
+#if defined(_WIN32)
+    Result = Alignment ? _aligned_msize(Memory, Alignment, 0) : _msize(Memory);
+#elif defined(__APPLE__)
+    (void)Alignment;
+    Result = malloc_size(Memory);
+#elif defined(__linux__)
+    (void)Alignment;
+    Result = malloc_usable_size(Memory);
+#else
+    (void)Memory;
+    (void)Alignment;
+#endif
+    return(Result);
 }
 
 
-void ZeroInitializeEmptyMVMDebugString(mvm_debug_memory_string *MVMDebugString)
+uint64_t MVMReadTimestamp(void)
 {
-    MVMDebugString->Length = 0;
-    MVMDebugString->MemoryAllocated = DEBUG_STRING_INITIAL_SIZE;
-    MVMDebugString->Contents = (char *)malloc(MVMDebugString->MemoryAllocated);
-    if(!MVMDebugString->Contents)
-    {
-        printf("malloc() failed when allocating memory for a string\n");
-        MVMDebugString->MemoryAllocated = 0;
-    }
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return (uint64_t)Time.tv_sec*1000000000ULL + (uint64_t)Time.tv_nsec;
+#endif
+}
+
+
+// NOTE(Marko): Returns the value before the addition. 
+uint64_t MVMAtomicAddU64(volatile uint64_t *Value, uint64_t Addend)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64 *)Value, 
+                                              (LONG64)Addend);
+#else
+    return __atomic_fetch_add(Value, Addend, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+// NOTE(Marko): Returns the value before the exchange. The exchange happened 
+//              if that equals Expected. 
+uint32_t MVMAtomicCompareExchangeU32(volatile uint32_t *Value, 
+                                     uint32_t Expected, 
+                                     uint32_t New)
+{
+#if defined(_MSC_VER)
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)Value, 
+                                                (LONG)New, 
+                                                (LONG)Expected);
+#else
+    return __sync_val_compare_and_swap(Value, Expected, New);
+#endif
+}
+
+
+// NOTE(Marko): Returns the value before the exchange. 
+uint64_t MVMAtomicCompareExchangeU64(volatile uint64_t *Value, 
+                                     uint64_t Expected, 
+                                     uint64_t New)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)Value, 
+                                                  (LONG64)New, 
+                                                  (LONG64)Expected);
+#else
+    return __sync_val_compare_and_swap(Value, Expected, New);
+#endif
+}
+
+
+void MVMAtomicStoreU64(volatile uint64_t *Value, uint64_t New)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64 *)Value, (LONG64)New);
+#else
+    __atomic_store_n(Value, New, __ATOMIC_RELEASE);
+#endif
+}
+
+
+void MVMAtomicStoreU32(volatile uint32_t *Value, uint32_t New)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange((volatile LONG *)Value, (LONG)New);
+#else
+    __atomic_store_n(Value, New, __ATOMIC_RELEASE);
+#endif
+}
+
+
+uint64_t MVMAtomicLoadU64(volatile uint64_t *Value)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)Value, 
+                                                  0, 0);
+#else
+    return __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+#endif
 }
 
 
-void AppendConstStringToMVMDebugMemoryString(const char *Source,
-                                             mvm_debug_memory_string *Dest)
+// NOTE(Marko): Raises *Value to New if it is lower. Returns 1 if it did. 
+int MVMAtomicMaxU64(volatile uint64_t *Value, uint64_t New)
 {
-    int SourceStringLength = strlen(Source);
-    if(Dest->MemoryAllocated <= (Dest->Length + SourceStringLength))
+    uint64_t Current = MVMAtomicLoadU64(Value);
+    while(Current < New)
     {
-        while(Dest->MemoryAllocated <= (Dest->Length + SourceStringLength))
+        uint64_t Previous = MVMAtomicCompareExchangeU64(Value, Current, New);
+        if(Previous == Current)
         {
-            Dest->MemoryAllocated *= 2;
+            return(1);
         }
-        Dest->Contents = (char *)realloc(Dest->Contents, 
-                                         Dest->MemoryAllocated);
+        Current = Previous;
     }
+    return(0);
+}
 
-    int SourceStringIndex = 0;
-    while(Source[SourceStringIndex])
-    {
-        Dest->Contents[Dest->Length++] = Source[SourceStringIndex++];
-    }
-    Dest->Contents[Dest->Length] = '\0';
+
+uint32_t MVMAtomicLoadU32(volatile uint32_t *Value)
+{
+#if defined(_MSC_VER)
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)Value, 0, 0);
+#else
+    return __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+
+// NOTE(Marko): Index of the highest set bit. Value must not be 0. 
+uint32_t MVMFloorLog2U64(uint64_t Value)
+{
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanReverse64(&Index, Value);
+    return (uint32_t)Index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(Value);
+#endif
+}
+
+
+void MVMPlatformYield(void)
+{
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
 }
 
 
-void MVMAppendDebugString(mvm_debug_memory_string SourceMVMDebugString,
-                          mvm_debug_memory_string AppendedMVMDebugString)
+typedef struct mvm_debug_memory_lock
 {
-    size_t SourceMVMDebugStringCurrentIndex = SourceMVMDebugString.Length;
+    volatile uint32_t Locked;
 
-    SourceMVMDebugString.Length += AppendedMVMDebugString.Length;
+} mvm_debug_memory_lock;
 
-    if(SourceMVMDebugString.MemoryAllocated <= SourceMVMDebugString.Length)
+
+void MVMLockAcquire(mvm_debug_memory_lock *Lock)
+{
+    while(MVMAtomicCompareExchangeU32(&Lock->Locked, 0, 1) != 0)
     {
-        // NOTE(Marko): Grow the string if the memory allocated is too small to 
-        //              fit the addition of the appended string
-        while(SourceMVMDebugString.MemoryAllocated <= 
-              SourceMVMDebugString.Length)
+        // NOTE(Marko): Spin on a plain read so waiters do not hammer the 
+        //              cache line, and give the CPU away if the holder has 
+        //              been descheduled. 
+        int Spins = 0;
+        while(MVMAtomicLoadU32(&Lock->Locked))
         {
-            SourceMVMDebugString.MemoryAllocated *= 2;
+            if(++Spins >= DEBUG_LOCK_SPINS_BEFORE_YIELD)
+            {
+                MVMPlatformYield();
+                Spins = 0;
+            }
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
         }
-        SourceMVMDebugString.Contents = 
-            realloc(SourceMVMDebugString.Contents, 
-                    SourceMVMDebugString.MemoryAllocated);
-    }
-
-    for(int AppendedMVMDebugStringCurrentIndex = 0;
-        AppendedMVMDebugStringCurrentIndex < AppendedMVMDebugString.Length;
-        ++AppendedMVMDebugStringCurrentIndex, 
-        ++SourceMVMDebugStringCurrentIndex)
-    {
-        SourceMVMDebugString.Contents[SourceMVMDebugStringCurrentIndex] = 
-        AppendedMVMDebugString.Contents[AppendedMVMDebugStringCurrentIndex];
     }
 }
 
 
-typedef enum memory_operation_type
+// NOTE(Marko): Returns 1 if the lock was taken, 0 if someone else holds it. 
+int MVMLockTryAcquire(mvm_debug_memory_lock *Lock)
 {
-    MemoryOperationType_NotAssigned = 0,
+    return(MVMAtomicCompareExchangeU32(&Lock->Locked, 0, 1) == 0);
+}
 
-    MemoryOperationType_InitialAllocation,
-    MemoryOperationType_ReAllocation,
-    MemoryOperationType_Free,
-    MemoryOperationType_Comment,
-    MemoryOperationType_TurnOn,
-    MemoryOperationType_TurnOff,
 
+void MVMLockRelease(mvm_debug_memory_lock *Lock)
+{
+    MVMAtomicStoreU32(&Lock->Locked, 0);
+}
 
-} memory_operation_type;
 
+typedef void mvm_debug_memory_thread_proc(void *Parameter);
 
-typedef struct mvm_debug_memory_info
+typedef struct mvm_debug_memory_thread
 {
-    int DebugInfoOpCount;
-
-    // NOTE(Marko): Growable array to store the number of bytes (de)allocated 
-    //              using memory allocation ops. Negative values correspond 
-    //              with freed amounts. 
-    int ByteCountArrayCount;
-    int ByteCountArrayAllocated;
-    int *ByteCountArray;
-
-    int FilenamesCount;
-    int FilenamesAllocated;
-    mvm_debug_memory_string *Filenames;
-
-    int LineNumbersCount;
-    int LineNumbersAllocated;
-    int *LineNumbers;
-
-    // TODO(Marko): Implement sort on the current address. This may make 
-    //              finding addresses easier as we can use binary search. 
-    // NOTE(Marko): - For malloc(), realloc(), stores the current address of 
-    //                the pointer. 
-    //              - For TurnOn and TurnOff, stores 0
-    //              - When freed, stores -1
-    void *CurrentAddress;
-    // NOTE(Marko): PreviousAddress = 0 if not applicable.
-    // NOTE(Marko): PreviousAddress used to check for usage after free. 
-    void *PreviousAddress;
+    mvm_debug_memory_thread_proc *Proc;
+    void *Parameter;
+#if defined(_WIN32)
+    HANDLE Handle;
+#else
+    pthread_t Handle;
+#endif
 
-    void *InitialAddress;
+} mvm_debug_memory_thread;
 
-    // NOTE(Marko): Indicator to show whether or not memory has been freed. -1 
-    //              if it does not apply. 
-    int Freed;
 
-    int MemoryOperationTypesAllocated;
-    int MemoryOperationTypesCount;
-    memory_operation_type *MemoryOperationTypes;
+#if defined(_WIN32)
+DWORD WINAPI MVMPlatformThreadEntry(LPVOID Parameter)
+{
+    mvm_debug_memory_thread *Thread = (mvm_debug_memory_thread *)Parameter;
+    Thread->Proc(Thread->Parameter);
+    return 0;
+}
+#else
+void *MVMPlatformThreadEntry(void *Parameter)
+{
+    mvm_debug_memory_thread *Thread = (mvm_debug_memory_thread *)Parameter;
+    Thread->Proc(Thread->Parameter);
+    return 0;
+}
+#endif
 
-    // NOTE(Marko): Store current address of allocation for easier search. 
-    //              This is to ensure that reallocations are easier to find
-    int AddressesAllocated;
-    int AddressesCount;
-    void **Addresses; 
 
-} mvm_debug_memory_info;
+// NOTE(Marko): Thread must stay alive until MVMPlatformJoinThread(). 
+//              Returns 0 on failure. 
+int MVMPlatformCreateThread(mvm_debug_memory_thread *Thread, 
+                            mvm_debug_memory_thread_proc *Proc, 
+                            void *Parameter)
+{
+    Thread->Proc = Proc;
+    Thread->Parameter = Parameter;
+#if defined(_WIN32)
+    Thread->Handle = CreateThread(0, 0, MVMPlatformThreadEntry, Thread, 0, 0);
+    return(Thread->Handle != 0);
+#else
+    return(pthread_create(&Thread->Handle, 0, MVMPlatformThreadEntry, 
+                          Thread) == 0);
+#endif
+}
 
 
-typedef struct mvm_debug_memory_list
+void MVMPlatformJoinThread(mvm_debug_memory_thread *Thread)
 {
-    size_t TurnOnCount;
-    size_t DebugInfoUnitsCount;
-    size_t DebugInfoUnitsAllocated;
-    mvm_debug_memory_info *DebugInfoList;
-    
-} mvm_debug_memory_list;
+#if defined(_WIN32)
+    WaitForSingleObject(Thread->Handle, INFINITE);
+    CloseHandle(Thread->Handle);
+#else
+    pthread_join(Thread->Handle, 0);
+#endif
+}
 
 
-// NOTE(Marko): Global Variable to hold the debug info. 
-mvm_debug_memory_list *GlobalDebugInfoList = 0;
+void MVMPlatformSleepMilliseconds(uint32_t Milliseconds)
+{
+#if defined(_WIN32)
+    Sleep(Milliseconds);
+#else
+    struct timespec Time;
+    Time.tv_sec = Milliseconds / 1000;
+    Time.tv_nsec = (long)(Milliseconds % 1000) * 1000000L;
+    nanosleep(&Time, 0);
+#endif
+}
 
 
-mvm_debug_memory_info *
-MVMSearchDebugInfoListByCurrentAddress(void *SearchedAddress)
+// NOTE(Marko): Address range of the calling thread's stack. Returns 0 where 
+//              it is not known, which disables frame-pointer walking. 
+int MVMPlatformGetStackBounds(uintptr_t *Low, uintptr_t *High)
 {
-    mvm_debug_memory_info *Result = 0;   
-    if (GlobalDebugInfoList)
+    int Result = 0;
+#if defined(__GLIBC__)
+    pthread_attr_t Attributes;
+    if(pthread_getattr_np(pthread_self(), &Attributes) == 0)
     {
-        for(int DebugInfoUnitIndex = 0; 
-            DebugInfoUnitIndex < GlobalDebugInfoList->DebugInfoUnitsCount; 
-            DebugInfoUnitIndex++)
+        void *StackAddress = 0;
+        size_t StackSize = 0;
+        if(pthread_attr_getstack(&Attributes, &StackAddress, &StackSize) == 0)
         {
-            mvm_debug_memory_info *DebugInfoUnit = GlobalDebugInfoList->DebugInfoList + DebugInfoUnitIndex;
-            if(DebugInfoUnit->CurrentAddress == SearchedAddress)
-            {
-                Result = DebugInfoUnit;
-                break;
-            }
+            *Low = (uintptr_t)StackAddress;
+            *High = (uintptr_t)StackAddress + StackSize;
+            Result = 1;
         }
+        pthread_attr_destroy(&Attributes);
     }
+#elif defined(__APPLE__)
+    *High = (uintptr_t)pthread_get_stackaddr_np(pthread_self());
+    *Low = *High - pthread_get_stacksize_np(pthread_self());
+    Result = 1;
+#else
+    (void)Low;
+    (void)High;
+#endif
     return(Result);
 }
 
 
-void MVMTurnOnDebugInfo(const char *Filename,
-                        int LineNumber)
+// NOTE(Marko): Fills Frames with up to MaxFrames return addresses using the 
+//              system unwinder, which does not need frame pointers. Skips 
+//              its own frame plus SkipFrames more. Returns the count. 
+MVM_DEBUG_NOINLINE 
+uint32_t MVMPlatformUnwindStack(void **Frames, 
+                                uint32_t MaxFrames, 
+                                uint32_t SkipFrames)
 {
-    
-    if(!GlobalDebugInfoList)
+    uint32_t Result = 0;
+#if defined(_WIN32)
+    Result = RtlCaptureStackBackTrace(SkipFrames + 1, MaxFrames, Frames, 0);
+#elif defined(__GLIBC__) || defined(__APPLE__)
+    void *AllFrames[128];
+    uint32_t MaxAllFrames = MaxFrames + SkipFrames + 1;
+    if(MaxAllFrames > 128)
     {
-        // NOTE(Marko): If GlobalDebugInfo hasn't been initialized yet, 
-        //              initialize it. 
-        GlobalDebugInfoList = 
-            (mvm_debug_memory_list *)malloc((sizeof *GlobalDebugInfoList));
-        if(GlobalDebugInfoList)
-        {
-            *GlobalDebugInfoList = (mvm_debug_memory_list){0};
-            GlobalDebugInfoList->TurnOnCount = 1;
-            GlobalDebugInfoList->DebugInfoUnitsCount = 0;
-            GlobalDebugInfoList->DebugInfoUnitsAllocated = DEBUG_INFO_LIST_INITIAL_SIZE;
+        MaxAllFrames = 128;
+    }
+    int AllFramesCount = backtrace(AllFrames, (int)MaxAllFrames);
+    for(int FrameIndex = (int)SkipFrames + 1; 
+        (FrameIndex < AllFramesCount) && (Result < MaxFrames); 
+        FrameIndex++)
+    {
+        Frames[Result++] = AllFrames[FrameIndex];
+    }
+#else
+    (void)Frames;
+    (void)MaxFrames;
+    (void)SkipFrames;
+#endif
+    return(Result);
+}
+
 
-            GlobalDebugInfoList->DebugInfoList = 
-                (mvm_debug_memory_info *)malloc(
-                    (sizeof *GlobalDebugInfoList->DebugInfoList) * 
-                GlobalDebugInfoList->DebugInfoUnitsAllocated);
+// NOTE(Marko): Report time only: may allocate and read debug information. 
+//              Prints one indented line per frame. 
+void MVMPlatformPrintStackFrames(void **Frames, uint32_t FramesCount)
+{
+#if defined(_WIN32)
+    static int SymbolsInitialized = 0;
+    HANDLE Process = GetCurrentProcess();
+    if(!SymbolsInitialized)
+    {
+        SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+        SymbolsInitialized = SymInitialize(Process, 0, TRUE) ? 1 : -1;
+    }
+    for(uint32_t FrameIndex = 0; FrameIndex < FramesCount; FrameIndex++)
+    {
+        DWORD64 Address = (DWORD64)(uintptr_t)Frames[FrameIndex];
+        uint8_t SymbolBuffer[sizeof(SYMBOL_INFO) + 256];
+        SYMBOL_INFO *Symbol = (SYMBOL_INFO *)SymbolBuffer;
+        memset(SymbolBuffer, 0, sizeof(SymbolBuffer));
+        Symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        Symbol->MaxNameLen = 255;
+        DWORD64 Displacement = 0;
+        IMAGEHLP_LINE64 Line = {0};
+        Line.SizeOfStruct = sizeof(Line);
+        DWORD LineDisplacement = 0;
+        if((SymbolsInitialized > 0) && 
+           SymFromAddr(Process, Address, &Displacement, Symbol))
+        {
+            if(SymGetLineFromAddr64(Process, Address, &LineDisplacement, &Line))
+            {
+                printf("\t\t%s  %s:%lu\n", 
+                       Symbol->Name, 
+                       Line.FileName, 
+                       (unsigned long)Line.LineNumber);
+            }
+            else
+            {
+                printf("\t\t%s+0x%llx\n", 
+                       Symbol->Name, 
+                       (unsigned long long)Displacement);
+            }
         }
         else
         {
-            printf("malloc() failed when attempting to initially allocate the global mvm_debug_memory_list\n");
+            printf("\t\t0x%llx\n", (unsigned long long)Address);
         }
     }
-    else
-    {
-        GlobalDebugInfoList->TurnOnCount++;        
-    }
-
-    // NOTE(Marko): Add this turn on call to the GlobalDebugInfoList. 
-    int DebugInfoIndex = GlobalDebugInfoList->DebugInfoUnitsCount;
-    GlobalDebugInfoList->DebugInfoUnitsCount++;
-
-    if(GlobalDebugInfoList->DebugInfoUnitsAllocated <= 
-       GlobalDebugInfoList->DebugInfoUnitsCount)
+#elif defined(__GLIBC__) || defined(__APPLE__)
+    // NOTE(Marko): Names of functions in the executable itself need it to be 
+    //              linked with -rdynamic. 
+    char **Symbols = backtrace_symbols(Frames, (int)FramesCount);
+    for(uint32_t FrameIndex = 0; FrameIndex < FramesCount; FrameIndex++)
     {
-        // NOTE(Marko): Grow the size of the list since we've run out of 
-        //              memory. 
-        while(GlobalDebugInfoList->DebugInfoUnitsAllocated <= 
-              GlobalDebugInfoList->DebugInfoUnitsCount)
+        if(Symbols)
         {
-            GlobalDebugInfoList->DebugInfoUnitsAllocated *= 2;
+            printf("\t\t%s\n", Symbols[FrameIndex]);
         }
-
-        GlobalDebugInfoList->DebugInfoList = 
-            (mvm_debug_memory_info *)realloc(
-                GlobalDebugInfoList->DebugInfoList,
-                (sizeof GlobalDebugInfoList->DebugInfoList) * 
-                GlobalDebugInfoList->DebugInfoUnitsAllocated);
+        else
+        {
+            printf("\t\t%p\n", Frames[FrameIndex]);
+        }
+    }
+    free(Symbols);
+#else
+    for(uint32_t FrameIndex = 0; FrameIndex < FramesCount; FrameIndex++)
+    {
+        printf("\t\t%p\n", Frames[FrameIndex]);
     }
+#endif
+}
 
-    mvm_debug_memory_info *DebugInfo = 
-        GlobalDebugInfoList->DebugInfoList + DebugInfoIndex;
 
-    *DebugInfo = (mvm_debug_memory_info){0};
+// NOTE(Marko): Called with the faulting address on an access violation, in 
+//              the faulting thread, before the fault goes on to whatever 
+//              handled it before. 
+typedef void mvm_debug_memory_fault_proc(void *Address);
 
-    DebugInfo->DebugInfoOpCount = 1;
+mvm_debug_memory_fault_proc *GlobalPlatformFaultProc = 0;
 
-    // NOTE(Marko): This is not a memory allocation -- no bytes allocated. 
-    DebugInfo->ByteCountArrayCount = 0;
-    DebugInfo->ByteCountArrayAllocated = 0;
-    DebugInfo->ByteCountArray = 0;
+#if defined(_WIN32)
 
-    // NOTE(Marko): MVMTurnOnDebugInfo() can only ever be associated 
-    //              with one filename and one line number!
-    DebugInfo->FilenamesAllocated = 1; 
-    DebugInfo->Filenames = 
-        (mvm_debug_memory_string *)malloc((sizeof *DebugInfo->Filenames) *
-                                          DebugInfo->FilenamesAllocated);
-    if(DebugInfo->Filenames)
-    {        
-        DebugInfo->FilenamesCount = 1;
-        ZeroInitializeEmptyMVMDebugString(DebugInfo->Filenames);
-        AppendConstStringToMVMDebugMemoryString(Filename,
-                                                DebugInfo->Filenames);
-    }
-    else
+LONG WINAPI MVMPlatformFaultHandler(EXCEPTION_POINTERS *Exception)
+{
+    EXCEPTION_RECORD *Record = Exception->ExceptionRecord;
+    if(Record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION)
     {
-        printf("malloc() failed while allocating debug string structs\n");
-        DebugInfo->FilenamesAllocated = 0;
-        DebugInfo->FilenamesCount = 0;
+        GlobalPlatformFaultProc((void *)Record->ExceptionInformation[1]);
     }
+    return(EXCEPTION_CONTINUE_SEARCH);
+}
 
-    DebugInfo->LineNumbersAllocated = 1; 
-    DebugInfo->LineNumbers = 
-        (int *)malloc((sizeof *DebugInfo->LineNumbers) * 
-                      DebugInfo->LineNumbersAllocated);
-    if(DebugInfo->LineNumbers)
-    {
-        DebugInfo->LineNumbers[0] = LineNumber;
-        DebugInfo->LineNumbersCount = 1;
-    }
-    else
-    {
-        printf("malloc() failed while allocating array for line numbers\n");
-        DebugInfo->LineNumbersAllocated = 0; 
-        DebugInfo->LineNumbersCount = 0; 
-    }
+#else
 
-    DebugInfo->InitialAddress = 0;
-    DebugInfo->CurrentAddress = 0;
-    DebugInfo->PreviousAddress = 0;
-    DebugInfo->Freed = FREED_NOT_APPLICABLE;
+struct sigaction GlobalPlatformPreviousSegvAction;
+struct sigaction GlobalPlatformPreviousBusAction;
 
-    // NOTE(Marko): TurnOn op only ever has one operation associated with it. 
-    DebugInfo->MemoryOperationTypesAllocated = 1;
-    DebugInfo->MemoryOperationTypes = 
-        (memory_operation_type *)malloc(sizeof *DebugInfo->MemoryOperationTypes);
-    if(DebugInfo->MemoryOperationTypes)
+void MVMPlatformFaultHandler(int Signal, siginfo_t *Info, void *Context)
+{
+    struct sigaction *Previous = (Signal == SIGBUS) ? 
+        &GlobalPlatformPreviousBusAction : &GlobalPlatformPreviousSegvAction;
+    GlobalPlatformFaultProc(Info->si_addr);
+    if(Previous->sa_flags & SA_SIGINFO)
+    {
+        Previous->sa_sigaction(Signal, Info, Context);
+    }
+    else if((Previous->sa_handler != SIG_DFL) && 
+            (Previous->sa_handler != SIG_IGN))
     {
-        DebugInfo->MemoryOperationTypes[0] = MemoryOperationType_TurnOn;
-        DebugInfo->MemoryOperationTypesCount = 1;
+        Previous->sa_handler(Signal);
     }
     else
     {
-        printf("malloc() failed while allocating array for memory op types\n");
-        DebugInfo->MemoryOperationTypesAllocated = 0;
-        DebugInfo->MemoryOperationTypesCount = 0;
+        // NOTE(Marko): Returning retries the access, which then faults again 
+        //              with the default action in place. 
+        sigaction(Signal, Previous, 0);
     }
+}
+
+#endif
+
+
+// NOTE(Marko): Call once per process. Returns 0 on failure. 
+int MVMPlatformInstallFaultHandler(mvm_debug_memory_fault_proc *Proc)
+{
+    GlobalPlatformFaultProc = Proc;
+#if defined(_WIN32)
+    return(AddVectoredExceptionHandler(1, MVMPlatformFaultHandler) != 0);
+#else
+    struct sigaction Action;
+    memset(&Action, 0, sizeof Action);
+    Action.sa_sigaction = MVMPlatformFaultHandler;
+    Action.sa_flags = SA_SIGINFO;
+    sigemptyset(&Action.sa_mask);
+    return((sigaction(SIGSEGV, &Action, &GlobalPlatformPreviousSegvAction) == 0) && 
+           (sigaction(SIGBUS, &Action, &GlobalPlatformPreviousBusAction) == 0));
+#endif
+}
 
-    DebugInfo->AddressesAllocated = 0;
-    DebugInfo->AddressesCount = 0;
-    DebugInfo->Addresses = 0;
+
+// NOTE(Marko): Monotonic wall clock, used to calibrate MVMReadTimestamp(). 
+uint64_t MVMPlatformReadNanoseconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER Counter;
+    LARGE_INTEGER Frequency;
+    QueryPerformanceCounter(&Counter);
+    QueryPerformanceFrequency(&Frequency);
+    return (uint64_t)((double)Counter.QuadPart * 1e9 / 
+                      (double)Frequency.QuadPart);
+#else
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return (uint64_t)Time.tv_sec*1000000000ULL + (uint64_t)Time.tv_nsec;
+#endif
 }
 
 
+#define DEBUG_TIMESTAMP_CALIBRATION_NS 10000000
 
-void MVMTurnOffDebugInfo(const char *Filename,
-                         int LineNumber)
+// NOTE(Marko): Spins for DEBUG_TIMESTAMP_CALIBRATION_NS to find how many 
+//              MVMReadTimestamp() ticks make a second. Also returns the 
+//              timestamp and monotonic time at which the measurement began. 
+uint64_t MVMCalibrateTimestampFrequency(uint64_t *StartTimestamp, 
+                                        uint64_t *StartNanoseconds)
 {
-    if(GlobalDebugInfoList)
+    *StartNanoseconds = MVMPlatformReadNanoseconds();
+    *StartTimestamp = MVMReadTimestamp();
+    uint64_t EndNanoseconds = *StartNanoseconds;
+    while(EndNanoseconds - *StartNanoseconds < DEBUG_TIMESTAMP_CALIBRATION_NS)
     {
-        if(GlobalDebugInfoList->TurnOnCount > 0)
-        {
-            GlobalDebugInfoList->TurnOnCount--;
-            // NOTE(Marko): Add this turn off call to the debuginfolist. 
-            int DebugInfoIndex = GlobalDebugInfoList->DebugInfoUnitsCount;
-            GlobalDebugInfoList->DebugInfoUnitsCount++;
+        EndNanoseconds = MVMPlatformReadNanoseconds();
+    }
+    uint64_t EndTimestamp = MVMReadTimestamp();
+    return (uint64_t)((double)(EndTimestamp - *StartTimestamp) * 1e9 / 
+                      (double)(EndNanoseconds - *StartNanoseconds));
+}
 
-            if(GlobalDebugInfoList->DebugInfoUnitsAllocated <= 
-               GlobalDebugInfoList->DebugInfoUnitsCount)
-            {
-                // NOTE(Marko): Grow the size of the list since we've run out 
-                //              of memory. 
-                while(GlobalDebugInfoList->DebugInfoUnitsAllocated <=
-                      GlobalDebugInfoList->DebugInfoUnitsCount)
-                {
-                    GlobalDebugInfoList->DebugInfoUnitsAllocated *= 2;
-                }
-                GlobalDebugInfoList->DebugInfoList = 
-                    (mvm_debug_memory_info *)realloc(
-                        GlobalDebugInfoList->DebugInfoList,
-                        (sizeof *GlobalDebugInfoList->DebugInfoList) * 
-                        GlobalDebugInfoList->DebugInfoUnitsAllocated);
-            }
-
-            mvm_debug_memory_info *DebugInfo = 
-                &GlobalDebugInfoList->DebugInfoList[DebugInfoIndex];
-
-            *DebugInfo = (mvm_debug_memory_info){0};
-
-            DebugInfo->DebugInfoOpCount = 1;
-
-            // NOTE(Marko): This is not a memory allocation -- no bytes are 
-            //              allocated.
-            DebugInfo->ByteCountArrayCount = 0; 
-            DebugInfo->ByteCountArrayAllocated = 0; 
-            DebugInfo->ByteCountArray = 0; 
-
-            // NOTE(Marko): MVMTurnOffDebugInfo() can only ever be associated 
-            //              with one filename and one line number!
-            DebugInfo->FilenamesAllocated = 1; 
-            DebugInfo->Filenames = 
-                (mvm_debug_memory_string *)malloc((sizeof *DebugInfo->Filenames) *
-                                                  DebugInfo->FilenamesAllocated);
-            if(DebugInfo->Filenames)
-            {        
-                DebugInfo->FilenamesCount = 1;
-                ZeroInitializeEmptyMVMDebugString(DebugInfo->Filenames);
-                AppendConstStringToMVMDebugMemoryString(Filename,
-                                                        DebugInfo->Filenames);
-            }
-            else
-            {
-                printf("malloc() failed while allocating debug string structs\n");
-                DebugInfo->FilenamesAllocated = 0;
-                DebugInfo->FilenamesCount = 0;
-            }
 
-            DebugInfo->LineNumbersAllocated = 1; 
-            DebugInfo->LineNumbers = 
-                (int *)malloc((sizeof *DebugInfo->LineNumbers) * 
-                              DebugInfo->LineNumbersAllocated);
-            if(DebugInfo->LineNumbers)
-            {
-                DebugInfo->LineNumbers[0] = LineNumber;
-                DebugInfo->LineNumbersCount = 1;
-            }
-            else
-            {
-                printf("malloc() failed while allocating array for line numbers\n");
-                DebugInfo->LineNumbersAllocated = 0; 
-                DebugInfo->LineNumbersCount = 0; 
-            }
+typedef struct mvm_debug_memory_file
+{
+#if defined(_WIN32)
+    HANDLE Handle;
+#else
+    int Descriptor;
+#endif
 
-            DebugInfo->InitialAddress = 0;
-            DebugInfo->CurrentAddress = 0;
-            DebugInfo->PreviousAddress = 0;
-            DebugInfo->Freed = FREED_NOT_APPLICABLE;
+} mvm_debug_memory_file;
+
+
+// NOTE(Marko): Creates or truncates Filename. Returns 0 on failure. 
+int MVMPlatformOpenFileForWriting(mvm_debug_memory_file *File, 
+                                  const char *Filename)
+{
+#if defined(_WIN32)
+    File->Handle = CreateFileA(Filename, GENERIC_WRITE, FILE_SHARE_READ, 0, 
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    return(File->Handle != INVALID_HANDLE_VALUE);
+#else
+    File->Descriptor = open(Filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return(File->Descriptor >= 0);
+#endif
+}
 
-            // NOTE(Marko): TurnOff op only ever has one operation associated 
-            //              with it. 
-            DebugInfo->MemoryOperationTypesAllocated = 1;
-            DebugInfo->MemoryOperationTypes = 
-                (memory_operation_type *)malloc(sizeof *DebugInfo->MemoryOperationTypes);
-            if(DebugInfo->MemoryOperationTypes)
-            {
-                DebugInfo->MemoryOperationTypes[0] = 
-                    MemoryOperationType_TurnOff;
-                DebugInfo->MemoryOperationTypesCount = 1;
-            }
-            else
-            {
-                printf("malloc() failed while allocating array for memory op types\n");
-                DebugInfo->MemoryOperationTypesAllocated = 0;
-                DebugInfo->MemoryOperationTypesCount = 0;
-            }
 
-            DebugInfo->AddressesAllocated = 0;
-            DebugInfo->AddressesCount = 0;
-            DebugInfo->Addresses = 0;
+// NOTE(Marko): Writes all of Size bytes. Returns 0 on failure. 
+int MVMPlatformWriteFile(mvm_debug_memory_file *File, 
+                         const void *Memory, 
+                         size_t Size)
+{
+    const uint8_t *Bytes = (const uint8_t *)Memory;
+    while(Size)
+    {
+#if defined(_WIN32)
+        DWORD ChunkSize = (Size > 0x40000000) ? 0x40000000 : (DWORD)Size;
+        DWORD BytesWritten = 0;
+        if(!WriteFile(File->Handle, Bytes, ChunkSize, &BytesWritten, 0))
+        {
+            return(0);
         }
-        else
+#else
+        ssize_t BytesWritten = write(File->Descriptor, Bytes, Size);
+        if(BytesWritten < 0)
         {
-            printf("TurnOffDebugInfo() called without corresponding TurnOnDebugInfo()\n");
-            printf("TurnOffDebugInfo called in %s at line %d\n", 
-                   Filename, 
-                   LineNumber);
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return(0);
         }
+#endif
+        Bytes += BytesWritten;
+        Size -= (size_t)BytesWritten;
     }
-    else
-    {
-        printf("TurnOffDebugInfo() called before ever calling TurnOnDebugInfo()\n");
-        printf("TurnOffDebugInfo called in %s at line %d\n", 
-               Filename, 
-               LineNumber);
-    }
+    return(1);
 }
 
 
+// NOTE(Marko): Wraps a descriptor the caller already has open, such as 1 
+//              for stdout. The caller keeps ownership; do not close it 
+//              through File. Returns 0 if the descriptor is not valid. 
+int MVMPlatformFileFromDescriptor(mvm_debug_memory_file *File, 
+                                  int Descriptor)
+{
+#if defined(_WIN32)
+    File->Handle = (HANDLE)_get_osfhandle(Descriptor);
+    return(File->Handle != INVALID_HANDLE_VALUE);
+#else
+    File->Descriptor = Descriptor;
+    return(Descriptor >= 0);
+#endif
+}
+
 
-void *MVMDebugMalloc(size_t MemorySize, 
-                     const char *Filename, 
-                     int LineNumber)
+void MVMPlatformCloseFile(mvm_debug_memory_file *File)
 {
-    void *Result = 0;
-    Result = malloc(MemorySize);
+#if defined(_WIN32)
+    CloseHandle(File->Handle);
+#else
+    close(File->Descriptor);
+#endif
+}
 
-    // TODO(Marko): and else-if clauses that examine which thing in particular 
-    //              failed: did malloc() fail, or was the GlobalDebugInfoList 
-    //              not initialized, or was it not yet turned on? 
-    if(Result && GlobalDebugInfoList && (GlobalDebugInfoList->TurnOnCount > 0))
-    {
-        // NOTE(Marko): Only commit information to the debug information list 
-        //              if 
-        //              1) malloc() succeeded 
-        //              2) GlobalDebugInfoList has been initialized 
-        //              3) the debug memory tool has been turned on. 
 
-        int DebugInfoIndex = GlobalDebugInfoList->DebugInfoUnitsCount;
-        GlobalDebugInfoList->DebugInfoUnitsCount++;
+//
+// NOTE(Marko): Tracker arena. Every piece of bookkeeping the tool keeps comes 
+//              from here instead of malloc(), so the metadata neither shows 
+//              up in nor perturbs the heap we are trying to observe. Memory 
+//              comes straight from the OS in DEBUG_ARENA_CHUNK_SIZE chunks. 
+//              Blocks are rounded up to a power-of-two size class and freed 
+//              blocks go onto a per-class free list, which keeps the growable 
+//              arrays from leaking their old storage. Anything bigger than 
+//              DEBUG_ARENA_LARGEST_SIZE_CLASS gets a mapping of its own. 
+//              MVMArenaRelease() hands all of it back in one go. 
+//
+
+#define DEBUG_ARENA_CHUNK_SIZE (1 << 20)
+#define DEBUG_ARENA_CHUNK_HEADER_SIZE 64
+#define DEBUG_ARENA_SMALLEST_SIZE_CLASS_SHIFT 4
+#define DEBUG_ARENA_LARGEST_SIZE_CLASS_SHIFT 17
+#define DEBUG_ARENA_LARGEST_SIZE_CLASS (1 << DEBUG_ARENA_LARGEST_SIZE_CLASS_SHIFT)
 
-        if(GlobalDebugInfoList->DebugInfoUnitsAllocated <= 
-           GlobalDebugInfoList->DebugInfoUnitsCount)
-        {
-            // NOTE(Marko): Grow the debug info list if we've run out of 
-            //              memory. 
-            while(GlobalDebugInfoList->DebugInfoUnitsAllocated <=
-                  GlobalDebugInfoList->DebugInfoUnitsCount)      
-            {
-                GlobalDebugInfoList->DebugInfoUnitsAllocated *= 2;    
-            }        
-            GlobalDebugInfoList->DebugInfoList = 
-                (mvm_debug_memory_info *)realloc(
-                    GlobalDebugInfoList->DebugInfoList,
-                    (sizeof *GlobalDebugInfoList->DebugInfoList) * 
-                    GlobalDebugInfoList->DebugInfoUnitsAllocated);
-        }
+typedef struct mvm_debug_memory_arena_chunk
+{
+    struct mvm_debug_memory_arena_chunk *Next;
+    struct mvm_debug_memory_arena_chunk *Previous;
+    // NOTE(Marko): Size of the whole mapping, header included. 
+    size_t Size;
+    size_t Used;
 
-        mvm_debug_memory_info *DebugInfo = 
-            &GlobalDebugInfoList->DebugInfoList[DebugInfoIndex];
+} mvm_debug_memory_arena_chunk;
 
-        *DebugInfo = (mvm_debug_memory_info){0};
 
-        // NOTE(Marko): malloc() is supposed to be the first op. 
-        DebugInfo->DebugInfoOpCount = 1;
+typedef struct mvm_debug_memory_arena_free_block
+{
+    struct mvm_debug_memory_arena_free_block *Next;
 
-        // NOTE(Marko): malloc() is supposed to be associated with an 
-        //              *initial* allocation. As such, we expect to be 
-        //              allocating space for a series of reallocations and a 
-        //              free at some point in the future. 
-
-        //
-        // NOTE(Marko): Initialize Byte Count Array to keep track of the 
-        //              number of bytes allocated each time.
-        //
-        DebugInfo->ByteCountArrayAllocated = 
-            DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE;
-        DebugInfo->ByteCountArray = 
-            (int *)malloc((sizeof *DebugInfo->ByteCountArray) * 
-                          DebugInfo->ByteCountArrayCount);
-        if(DebugInfo->ByteCountArray)
-        {
-            for(int i = 0; i < DebugInfo->ByteCountArrayAllocated; i++)
-            {
-                DebugInfo->ByteCountArray[i] = 0;
-            }            
-            DebugInfo->ByteCountArray[0] = (int)MemorySize;
-            DebugInfo->ByteCountArrayCount = 1;
-        }
-        else
-        {
-            printf("malloc failed while allocating array for memory sizes\n");
-            DebugInfo->ByteCountArrayAllocated = 0;
-            DebugInfo->ByteCountArrayCount = 0;
+} mvm_debug_memory_arena_free_block;
+
+
+typedef struct mvm_debug_memory_arena
+{
+    // NOTE(Marko): Allocation is rare next to the operations being tracked 
+    //              (tables grow geometrically), so a single lock is enough. 
+    mvm_debug_memory_lock Lock;
+
+    // NOTE(Marko): The first chunk in the list is the one being bumped. 
+    //              Dedicated large-block mappings are linked in behind it. 
+    mvm_debug_memory_arena_chunk *Chunks;
+
+    size_t BytesMapped;
+    size_t BytesInUse;
+
+    mvm_debug_memory_arena_free_block *
+        FreeLists[DEBUG_ARENA_LARGEST_SIZE_CLASS_SHIFT + 1];
+
+} mvm_debug_memory_arena;
+
+
+// NOTE(Marko): Lives in static storage so that it can own everything else, 
+//              including GlobalDebugInfoList itself. 
+mvm_debug_memory_arena GlobalDebugArena = {0};
+
+
+int MVMArenaSizeClassShift(size_t Size)
+{
+    int Result = DEBUG_ARENA_SMALLEST_SIZE_CLASS_SHIFT;
+    while(((size_t)1 << Result) < Size)
+    {
+        Result++;
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_arena_chunk *MVMArenaMapChunk(mvm_debug_memory_arena *Arena, 
+                                               size_t Size)
+{
+    mvm_debug_memory_arena_chunk *Result = 
+        (mvm_debug_memory_arena_chunk *)MVMPlatformAllocatePages(Size);
+    if(Result)
+    {
+        Result->Size = Size;
+        Result->Used = DEBUG_ARENA_CHUNK_HEADER_SIZE;
+        Result->Previous = 0;
+        Result->Next = 0;
+        Arena->BytesMapped += Size;
+    }
+    else
+    {
+        printf("Unable to map %zu bytes of memory for the debug arena.\n", 
+               Size);
+    }
+    return(Result);
+}
 
-        }
 
+void *MVMArenaAllocateUnlocked(mvm_debug_memory_arena *Arena, size_t Size)
+{
+    void *Result = 0;
 
-        //
-        // NOTE(Marko): Initialize Filenames array
-        //
-        DebugInfo->FilenamesAllocated = DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE;
-        DebugInfo->Filenames = 
-            (mvm_debug_memory_string *)malloc((sizeof *DebugInfo->Filenames) * 
-                                              DebugInfo->FilenamesAllocated);
-        if(DebugInfo->Filenames)
+    if(Size > DEBUG_ARENA_LARGEST_SIZE_CLASS)
+    {
+        // NOTE(Marko): Large blocks get their own mapping, linked in behind 
+        //              the chunk currently being bumped. 
+        size_t MappingSize = DEBUG_ARENA_CHUNK_HEADER_SIZE + Size;
+        mvm_debug_memory_arena_chunk *Chunk = 
+            MVMArenaMapChunk(Arena, MappingSize);
+        if(Chunk)
         {
-            for(int FilenameIndex = 0; 
-                FilenameIndex < DebugInfo->FilenamesAllocated; 
-                FilenameIndex++)
+            Chunk->Used = MappingSize;
+            if(Arena->Chunks)
             {
-                    mvm_debug_memory_string *CurrentFilename = 
-                    DebugInfo->Filenames + FilenameIndex;
-                ZeroInitializeEmptyMVMDebugString(CurrentFilename);
+                Chunk->Previous = Arena->Chunks;
+                Chunk->Next = Arena->Chunks->Next;
+                if(Chunk->Next)
+                {
+                    Chunk->Next->Previous = Chunk;
+                }
+                Arena->Chunks->Next = Chunk;
             }
-            // NOTE(Marko): Fill in the first filename, since this is an 
-            //              initial allocation. 
-            AppendConstStringToMVMDebugMemoryString(Filename,
-                                                    DebugInfo->Filenames + 0);
-            DebugInfo->FilenamesCount = 1;
-        }
-        else
-        {
-            printf("malloc() failed while allocating debug string structs.\n");
-            DebugInfo->FilenamesAllocated = 0;
-            DebugInfo->FilenamesCount = 0;
+            else
+            {
+                Arena->Chunks = Chunk;
+            }
+            Arena->BytesInUse += Size;
+            Result = (uint8_t *)Chunk + DEBUG_ARENA_CHUNK_HEADER_SIZE;
         }
+        return(Result);
+    }
 
-        //
-        // NOTE(Marko): Initialize line numbers array
-        //
-        DebugInfo->LineNumbersAllocated = 
-            DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE;
-        DebugInfo->LineNumbers = 
-            (int *)malloc((sizeof *DebugInfo->LineNumbers) * 
-                           DebugInfo->LineNumbersAllocated);
-        if(DebugInfo->LineNumbers)
+    int SizeClassShift = MVMArenaSizeClassShift(Size);
+    size_t SizeClass = (size_t)1 << SizeClassShift;
+
+    if(Arena->FreeLists[SizeClassShift])
+    {
+        mvm_debug_memory_arena_free_block *FreeBlock = 
+            Arena->FreeLists[SizeClassShift];
+        Arena->FreeLists[SizeClassShift] = FreeBlock->Next;
+        memset(FreeBlock, 0, SizeClass);
+        Result = FreeBlock;
+    }
+    else
+    {
+        mvm_debug_memory_arena_chunk *Chunk = Arena->Chunks;
+        if(!Chunk || ((Chunk->Size - Chunk->Used) < SizeClass))
         {
-            for(int LineNumbersArrayIndex = 0;
-                LineNumbersArrayIndex < DebugInfo->LineNumbersAllocated;
-                LineNumbersArrayIndex++)
+            // NOTE(Marko): Whatever is left in the old chunk is simply 
+            //              abandoned. It is less than one size class. 
+            Chunk = MVMArenaMapChunk(Arena, DEBUG_ARENA_CHUNK_SIZE);
+            if(!Chunk)
             {
-                DebugInfo->LineNumbers[LineNumbersArrayIndex] = 0;
+                return(Result);
             }
-            DebugInfo->LineNumbersCount = 1;
-            DebugInfo->LineNumbers[0] = LineNumber;
-        }
-        else
-        {
-            printf("malloc() failed while allocating line number array.\n");
-            DebugInfo->LineNumbersCount = 0;
-            DebugInfo->LineNumbersAllocated = 0;
+            Chunk->Next = Arena->Chunks;
+            if(Arena->Chunks)
+            {
+                Arena->Chunks->Previous = Chunk;
+            }
+            Arena->Chunks = Chunk;
         }
+        // NOTE(Marko): Fresh pages from the OS are already zeroed. 
+        Result = (uint8_t *)Chunk + Chunk->Used;
+        Chunk->Used += SizeClass;
+    }
 
+    Arena->BytesInUse += SizeClass;
+    return(Result);
+}
 
-        //
-        // NOTE(Marko): Record the addresses
-        //
-        DebugInfo->CurrentAddress = Result;
-        DebugInfo->InitialAddress = Result;
-        DebugInfo->PreviousAddress = 0;
-        DebugInfo->Freed = 0;
 
+void MVMArenaFreeUnlocked(mvm_debug_memory_arena *Arena, 
+                          void *Memory, 
+                          size_t Size)
+{
+    if(!Memory)
+    {
+        return;
+    }
 
-        //
-        // NOTE(Marko): Initialize the Memory Operation Types array to 
-        //              NotAssigned enum first
-        //
-        DebugInfo->MemoryOperationTypesAllocated = 
-            DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE;
-        DebugInfo->MemoryOperationTypesCount = 1;
-        DebugInfo->MemoryOperationTypes = 
-            (memory_operation_type *)malloc((sizeof *DebugInfo->MemoryOperationTypes)*DebugInfo->MemoryOperationTypesAllocated);
-        if(DebugInfo->MemoryOperationTypes)
+    if(Size > DEBUG_ARENA_LARGEST_SIZE_CLASS)
+    {
+        mvm_debug_memory_arena_chunk *Chunk = 
+            (mvm_debug_memory_arena_chunk *)((uint8_t *)Memory - 
+                                             DEBUG_ARENA_CHUNK_HEADER_SIZE);
+        if(Chunk->Previous)
         {
-            for(int MemOpIndex = 0;
-                MemOpIndex < DebugInfo->MemoryOperationTypesAllocated;
-                MemOpIndex++)
-            {
-                DebugInfo->MemoryOperationTypes[MemOpIndex] = 
-                    MemoryOperationType_NotAssigned;
-            }
-            DebugInfo->MemoryOperationTypes[0] = 
-                MemoryOperationType_InitialAllocation;
-            DebugInfo->MemoryOperationTypesCount = 1;
+            Chunk->Previous->Next = Chunk->Next;
         }
         else
         {
-            printf("malloc() failed while allocating array for memory op types\n");
-            DebugInfo->MemoryOperationTypesCount = 0;
-            DebugInfo->MemoryOperationTypesAllocated = 0;
-        }
-
-        //
-        // NOTE(Marko): Initialize array to hold memory addresses to 0 
-        // 
-        DebugInfo->AddressesAllocated =  DEBUG_INFO_INTERNAL_ARRAY_INITIAL_SIZE;
-        DebugInfo->Addresses = 
-            malloc((sizeof *DebugInfo->Addresses)*DebugInfo->AddressesAllocated); 
-        if(DebugInfo->Addresses)
-        {
-            for(int AddressIndex = 0; 
-                AddressIndex < DebugInfo->AddressesAllocated; 
-                AddressIndex++)
-            {
-                DebugInfo->Addresses[AddressIndex] = 0;
-            }
-            DebugInfo->AddressesCount = 1;
-            DebugInfo->Addresses[0] = Result;
+            Arena->Chunks = Chunk->Next;
         }
-        else
+        if(Chunk->Next)
         {
-            printf("malloc failed while allocating array for memory addresses\n");
-            DebugInfo->AddressesCount = 0;
-            DebugInfo->AddressesAllocated = 0;
-
+            Chunk->Next->Previous = Chunk->Previous;
         }
+        Arena->BytesMapped -= Chunk->Size;
+        Arena->BytesInUse -= Size;
+        MVMPlatformFreePages(Chunk, Chunk->Size);
+    }
+    else
+    {
+        int SizeClassShift = MVMArenaSizeClassShift(Size);
+        mvm_debug_memory_arena_free_block *FreeBlock = 
+            (mvm_debug_memory_arena_free_block *)Memory;
+        FreeBlock->Next = Arena->FreeLists[SizeClassShift];
+        Arena->FreeLists[SizeClassShift] = FreeBlock;
+        Arena->BytesInUse -= (size_t)1 << SizeClassShift;
     }
-    return Result;
-
 }
 
 
+// NOTE(Marko): Always returns zeroed memory. 
+void *MVMArenaAllocate(mvm_debug_memory_arena *Arena, size_t Size)
+{
+    MVMLockAcquire(&Arena->Lock);
+    void *Result = MVMArenaAllocateUnlocked(Arena, Size);
+    MVMLockRelease(&Arena->Lock);
+    return(Result);
+}
+
 
-void *MVMDebugRealloc(void *Buffer, 
-                      size_t MemorySize, 
-                      const char *Filename, 
-                      int LineNumber)
+void MVMArenaFree(mvm_debug_memory_arena *Arena, void *Memory, size_t Size)
 {
-    void *Result = realloc(Buffer, MemorySize);
+    MVMLockAcquire(&Arena->Lock);
+    MVMArenaFreeUnlocked(Arena, Memory, Size);
+    MVMLockRelease(&Arena->Lock);
+}
 
-    if(Result && GlobalDebugInfoList && (GlobalDebugInfoList->TurnOnCount > 0))
+
+void *MVMArenaReallocate(mvm_debug_memory_arena *Arena, 
+                         void *Memory, 
+                         size_t OldSize, 
+                         size_t NewSize)
+{
+    void *Result = 0;
+    if(Memory && 
+       (OldSize <= DEBUG_ARENA_LARGEST_SIZE_CLASS) && 
+       (NewSize <= DEBUG_ARENA_LARGEST_SIZE_CLASS) && 
+       (MVMArenaSizeClassShift(OldSize) == MVMArenaSizeClassShift(NewSize)))
     {
-        // NOTE(Marko): Only commit information to the debug information list 
-        //              if 
-        //              1) realloc() succeeded 
-        //              2) GlobalDebugInfoList has been initialized 
-        //              3) the debug memory tool has been turned on. 
-        mvm_debug_memory_info *DebugInfo = 
-            MVMSearchDebugInfoListByCurrentAddress(Buffer);
-        if(DebugInfo)
-        {
-            DebugInfo->DebugInfoOpCount++;
-
-            //
-            // NOTE(Marko): Add byte amount allocated to byte array
-            //
-            int ByteCountArrayIndex = DebugInfo->ByteCountArrayCount;
-            DebugInfo->ByteCountArrayCount++;
-            if(DebugInfo->ByteCountArrayAllocated <= 
-               DebugInfo->ByteCountArrayCount)
-            {
-                while(DebugInfo->ByteCountArrayAllocated <= 
-                      DebugInfo->ByteCountArrayCount)
-                {
-                    DebugInfo->ByteCountArrayAllocated *= 2;
-                }
-                DebugInfo->ByteCountArray = 
-                    (int *)realloc(DebugInfo->ByteCountArray,
-                                   (sizeof *DebugInfo->ByteCountArray) * 
-                                   DebugInfo->ByteCountArrayAllocated);
-            }
-            DebugInfo->ByteCountArray[ByteCountArrayIndex] = (int)MemorySize;
-
-            //
-            // NOTE(Marko): Add filename to array
-            //
-            int FilenameIndex = DebugInfo->FilenamesCount; 
-            DebugInfo->FilenamesCount++;
-            if(DebugInfo->FilenamesAllocated < DebugInfo->FilenamesCount)
-            {
-                // NOTE(Marko): Increase size of filenames array if necessary
-                while(DebugInfo->FilenamesAllocated <= 
-                      DebugInfo->FilenamesCount)
-                {
-                    DebugInfo->FilenamesAllocated *= 2;
-                }
-                DebugInfo->Filenames = 
-                    (mvm_debug_memory_string *)realloc(
-                        DebugInfo->Filenames,
-                        (sizeof *DebugInfo->Filenames) * 
-                        DebugInfo->FilenamesAllocated);
-                // NOTE(Marko): Zero-initialize the newly allocated empty 
-                //              strings
-                for(int NewAllocatedFilenameIndex = FilenameIndex;
-                    NewAllocatedFilenameIndex < DebugInfo->FilenamesAllocated;
-                    NewAllocatedFilenameIndex++)
-                {
-                    mvm_debug_memory_string *CurrentFilename = 
-                        DebugInfo->Filenames + NewAllocatedFilenameIndex;
-                    ZeroInitializeEmptyMVMDebugString(CurrentFilename);
-                }
-            }
-            AppendConstStringToMVMDebugMemoryString(Filename,
-                                                    DebugInfo->Filenames + 
-                                                    FilenameIndex);
-
-            //
-            // NOTE(Marko): Add Line number to array
-            //
-            int LineNumberIndex = DebugInfo->LineNumbersCount;
-            DebugInfo->LineNumbersCount++;
-            if(DebugInfo->LineNumbersAllocated <= DebugInfo->LineNumbersCount)
-            {
-                // NOTE(Marko): Increase size of line numbers array if 
-                //              necessary
-                while(DebugInfo->LineNumbersAllocated <= 
-                      DebugInfo->LineNumbersCount)
-                {
-                    DebugInfo->LineNumbersAllocated *= 2;
-                }
-                DebugInfo->LineNumbers = 
-                    (int *)realloc(
-                        DebugInfo->LineNumbers,
-                        (sizeof *DebugInfo->LineNumbers) * 
-                        DebugInfo->LineNumbersAllocated);
-            }
-            DebugInfo->LineNumbers[LineNumberIndex] = LineNumber;
-
-            //
-            // NOTE(Marko): Update the current and previous address
-            //
-            DebugInfo->PreviousAddress = DebugInfo->CurrentAddress;
-            DebugInfo->CurrentAddress = Result;
-            DebugInfo->Freed = 0;
-
-            //
-            // NOTE(Marko): Add memory operation type to array
-            //
-            int MemoryOperationTypeIndex = 
-                DebugInfo->MemoryOperationTypesCount;
-            DebugInfo->MemoryOperationTypesCount++;
-            if(DebugInfo->MemoryOperationTypesAllocated <=
-               DebugInfo->MemoryOperationTypesCount)
-            {
-                while(DebugInfo->MemoryOperationTypesAllocated <=
-                      DebugInfo->MemoryOperationTypesCount)
-                {
-                    DebugInfo->MemoryOperationTypesAllocated *= 2;
-                }
-                DebugInfo->MemoryOperationTypes = 
-                    (memory_operation_type *)realloc(
-                        DebugInfo->MemoryOperationTypes,
-                        (sizeof *DebugInfo->MemoryOperationTypes) * 
-                        DebugInfo->MemoryOperationTypesAllocated);
-            }
-            DebugInfo->MemoryOperationTypes[MemoryOperationTypeIndex] =
-                MemoryOperationType_ReAllocation;
-
-            // 
-            // NOTE(Marko): Add address to array
-            //
-            int AddressesIndex = DebugInfo->AddressesCount;
-            DebugInfo->AddressesCount++;
-            if(DebugInfo->AddressesAllocated <= 
-                DebugInfo->AddressesCount)
-            {
-                // NOTE(Marko): Grow the addresses array if necessary
-                while(DebugInfo->AddressesAllocated <=
-                      DebugInfo->AddressesCount)
-                {
-                    DebugInfo->AddressesAllocated *= 2;
-                }
-                DebugInfo->Addresses = 
-                    (void *)realloc(
-                        DebugInfo->Addresses,
-                        (sizeof *DebugInfo->Addresses) * 
-                        DebugInfo->AddressesAllocated);
-            }
-            DebugInfo->Addresses[AddressesIndex] = 
-                DebugInfo->CurrentAddress;
-        }
-        else
+        // NOTE(Marko): Still fits in the block we already have. 
+        Result = Memory;
+    }
+    else
+    {
+        Result = MVMArenaAllocate(Arena, NewSize);
+        if(Result && Memory)
         {
-            printf("Unable to find allocated memory located at %p in the debug info list.\n");
+            memcpy(Result, Memory, (OldSize < NewSize) ? OldSize : NewSize);
+            MVMArenaFree(Arena, Memory, OldSize);
         }
-
     }
-
-    return Result;
-
+    return(Result);
 }
 
-void MVMDebugFree(void *Buffer,
-                  const char *Filename,
-                  int LineNumber)
+
+void MVMArenaRelease(mvm_debug_memory_arena *Arena)
 {
-    // TODO(Marko): Separate this operation into two parts:
-    //              1) Insert a new piece of information into the debug info 
-    //                 list
-    //              2) Search the Debug Info List for the memory operation 
-    //                 that corresponds to the current address, and fill in 
-    //                 the information there. 
-    if(Buffer && GlobalDebugInfoList && (GlobalDebugInfoList->TurnOnCount > 0))
+    mvm_debug_memory_arena_chunk *Chunk = Arena->Chunks;
+    while(Chunk)
     {
-        // NOTE(Marko): Only write to the debug info list if: 
-        //              1) We are freeing actual memory, and not a null 
-        //              pointer 
-        //              2) The GlobalDebugInfoList has been initialized
-        //              3) We are currently in a Turned-On state for the Debug 
-        //                 Memory tool. 
+        mvm_debug_memory_arena_chunk *NextChunk = Chunk->Next;
+        MVMPlatformFreePages(Chunk, Chunk->Size);
+        Chunk = NextChunk;
+    }
+    *Arena = (mvm_debug_memory_arena){0};
+}
 
-        // NOTE(Marko): free() is supposed to free something that currently 
-        //              exists. So we search via the current address.
 
-        mvm_debug_memory_info *DebugInfo = 
-            MVMSearchDebugInfoListByCurrentAddress(Buffer);
+//
+// NOTE(Marko): Call-site registry. __FILE__ is a string literal with static 
+//              lifetime, so a (Filename, LineNumber) pair can be interned 
+//              once into a compact 32-bit site ID and every memory operation 
+//              only has to store that ID. 
+//
 
-        if(DebugInfo)
-        {
-            DebugInfo->DebugInfoOpCount++;
+#define DEBUG_SITE_TABLE_INITIAL_SIZE 256
+#define DEBUG_SITE_ID_NONE 0
+// NOTE(Marko): Events pack the site ID into 24 bits. 
+#define DEBUG_SITE_TABLE_MAX_SITES (1 << 24)
 
-            int ByteCountArrayIndex = DebugInfo->ByteCountArrayCount;
-            DebugInfo->ByteCountArrayCount++;
-            if(DebugInfo->ByteCountArrayAllocated <= 
-               DebugInfo->ByteCountArrayCount)
-            {
-                while(DebugInfo->ByteCountArrayAllocated <= 
-                      DebugInfo->ByteCountArrayCount)
-                {
-                    DebugInfo->ByteCountArrayAllocated *= 2;
-                }
-                DebugInfo->ByteCountArray = 
-                    (int *)realloc(DebugInfo->ByteCountArray,
-                                   (sizeof *DebugInfo->ByteCountArray) * 
-                                   DebugInfo->ByteCountArrayAllocated);
-            }
-            // NOTE(Marko): Store negative number for freed memory
-            DebugInfo->ByteCountArray[ByteCountArrayIndex] = 
-                -DebugInfo->ByteCountArray[ByteCountArrayIndex-1];
+typedef struct mvm_debug_memory_site
+{
+    const char *Filename;
+    int LineNumber;
 
+} mvm_debug_memory_site;
 
-            int FilenameIndex = DebugInfo->FilenamesCount; 
-            DebugInfo->FilenamesCount++;
-            if(DebugInfo->FilenamesAllocated < DebugInfo->FilenamesCount)
-            {
-                // NOTE(Marko): Increase size of filenames array if necessary
-                while(DebugInfo->FilenamesAllocated <= 
-                      DebugInfo->FilenamesCount)
-                {
-                    DebugInfo->FilenamesAllocated *= 2;
-                }
-                DebugInfo->Filenames = 
-                    (mvm_debug_memory_string *)realloc(
-                        DebugInfo->Filenames,
-                        (sizeof *DebugInfo->Filenames) * 
-                        DebugInfo->FilenamesAllocated);
-                // NOTE(Marko): Zero-initialize the newly allocated empty 
-                //              strings
-                for(int NewAllocatedFilenameIndex = FilenameIndex;
-                    NewAllocatedFilenameIndex < DebugInfo->FilenamesAllocated;
-                    NewAllocatedFilenameIndex++)
-                {
-                    mvm_debug_memory_string *CurrentFilename = 
-                        DebugInfo->Filenames + NewAllocatedFilenameIndex;
-                    ZeroInitializeEmptyMVMDebugString(CurrentFilename);
-                }
-            }
-            AppendConstStringToMVMDebugMemoryString(Filename,
-                                                    DebugInfo->Filenames + 
-                                                    FilenameIndex);
 
-            int LineNumberIndex = DebugInfo->LineNumbersCount;
-            DebugInfo->LineNumbersCount++;
-            if(DebugInfo->LineNumbersAllocated <= DebugInfo->LineNumbersCount)
-            {
-                // NOTE(Marko): Increase size of line numbers array if 
-                //              necessary
-                while(DebugInfo->LineNumbersAllocated <= 
-                      DebugInfo->LineNumbersCount)
-                {
-                    DebugInfo->LineNumbersAllocated *= 2;
-                }
-                DebugInfo->LineNumbers = 
-                    (int *)realloc(
-                        DebugInfo->LineNumbers,
-                        (sizeof *DebugInfo->LineNumbers) * 
-                        DebugInfo->LineNumbersAllocated);
-            }
-            DebugInfo->LineNumbers[LineNumberIndex] = LineNumber;
-
-            DebugInfo->PreviousAddress = DebugInfo->CurrentAddress;
-            // NOTE(Marko): Once freed, set current address to -1
-            DebugInfo->CurrentAddress = (void *)-1;    
-            DebugInfo->Freed = 1;
-
-            int MemoryOperationTypeIndex = 
-                DebugInfo->MemoryOperationTypesCount;
-            DebugInfo->MemoryOperationTypesCount++;
-            if(DebugInfo->MemoryOperationTypesAllocated <=
-               DebugInfo->MemoryOperationTypesCount)
-            {
-                while(DebugInfo->MemoryOperationTypesAllocated <=
-                      DebugInfo->MemoryOperationTypesCount)
-                {
-                    DebugInfo->MemoryOperationTypesAllocated *= 2;
-                }
-                DebugInfo->MemoryOperationTypes = 
-                    (memory_operation_type *)realloc(
-                        DebugInfo->MemoryOperationTypes,
-                        (sizeof *DebugInfo->MemoryOperationTypes) * 
-                        DebugInfo->MemoryOperationTypesAllocated);
-            }
-            DebugInfo->MemoryOperationTypes[MemoryOperationTypeIndex] =
-                MemoryOperationType_Free;
-
-            int AddressesIndex = DebugInfo->AddressesCount;
-            DebugInfo->AddressesCount++;
-            if(DebugInfo->AddressesAllocated <= 
-                DebugInfo->AddressesCount)
-            {
-                // NOTE(Marko): Grow the addresses array if necessary
-                while(DebugInfo->AddressesAllocated <=
-                      DebugInfo->AddressesCount)
-                {
-                    DebugInfo->AddressesAllocated *= 2;
-                }
-                DebugInfo->Addresses = 
-                    (void *)realloc(
-                        DebugInfo->Addresses,
-                        (sizeof *DebugInfo->Addresses) * 
-                        DebugInfo->AddressesAllocated);
-            }
-            DebugInfo->Addresses[AddressesIndex] = 
-                DebugInfo->CurrentAddress;
+typedef struct mvm_debug_memory_site_alias
+{
+    // NOTE(Marko): Keyed by the *pointer* value of Filename, so the hot path 
+    //              never touches the string contents. Filename == 0 marks an 
+    //              empty slot. 
+    const char *Filename;
+    int LineNumber;
+    uint32_t SiteID;
 
-        }
-        else
-        {
-            printf("Error while attempting to free address %p in file %s on line %d\n", Buffer, Filename, LineNumber);
-            printf("Unable to find address at %p\n", Buffer);
-        }
-    }
-    free(Buffer);
-}
+} mvm_debug_memory_site_alias;
 
 
-void MVMDebugMemoryComment(const char *MemoryComment,
-                           const char *Filename,
-                           int LineNumber)
+//
+// NOTE(Marko): Running totals per call site, updated with atomics on every 
+//              tracked operation so that no report has to replay the event 
+//              log. An allocation stays charged to the site that made it: a 
+//              later realloc() or free() elsewhere updates that site's 
+//              numbers. In sampling mode they count sampled allocations only. 
+//
+//              The stats live in fixed chunks that never move, so updates 
+//              need no lock even while the site table grows. 
+//
+
+#define DEBUG_SITE_STATS_CHUNK_SHIFT 10
+#define DEBUG_SITE_STATS_CHUNK_SIZE (1 << DEBUG_SITE_STATS_CHUNK_SHIFT)
+#define DEBUG_SITE_STATS_CHUNK_MASK (DEBUG_SITE_STATS_CHUNK_SIZE - 1)
+#define DEBUG_SITE_STATS_DIRECTORY_SIZE \
+    (DEBUG_SITE_TABLE_MAX_SITES >> DEBUG_SITE_STATS_CHUNK_SHIFT)
+
+typedef struct mvm_debug_memory_site_stats
 {
-    
-}
+    volatile uint64_t AllocationsCount;
+    volatile uint64_t ReallocationsCount;
+    volatile uint64_t FreesCount;
 
-void MVMDebugMemoryPrintAllocations(void)
+    // NOTE(Marko): Bytes handed out: initial sizes plus realloc() growth. 
+    volatile uint64_t TotalBytes;
+    volatile uint64_t LiveBytes;
+    volatile uint64_t PeakLiveBytes;
+
+    // NOTE(Marko): Bytes the C library reserved for the initial allocations, 
+    //              as reported by MVMPlatformUsableSize(). Counted alongside 
+    //              TotalBytes' initial sizes; the gap is malloc slack. 
+    volatile uint64_t TotalUsableBytes;
+
+    // NOTE(Marko): Set by MVMDebugMemoryGuardSite(). 
+    volatile uint32_t GuardPages;
+
+    // NOTE(Marko): One cache line per site, so two busy sites never share 
+    //              one. 
+    uint8_t Padding[4];
+
+} mvm_debug_memory_site_stats;
+
+
+//
+// NOTE(Marko): Per-site histograms, allocated along with the site and 
+//              reached through chunks of pointers that parallel the stats. 
+//              They share one log-linear bucket layout, as in HdrHistogram: 
+//              each power of two is split into DEBUG_LOG_HISTOGRAM_SUB_BUCKETS 
+//              linear sub-buckets, and values below 
+//              DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT get a bucket each, so any 
+//              value is placed to within 1/DEBUG_LOG_HISTOGRAM_SUB_BUCKETS. 
+//
+//              The size histogram counts requested sizes, whose bucket edges 
+//              land close to typical malloc size classes. Each bucket also 
+//              sums the slack the C library reserved on top of its requests. 
+//              Only initial allocations are counted. 
+//
+//              The lifetime histogram counts the time from each initial 
+//              allocation to its free(), in timestamp ticks; reports convert 
+//              to nanoseconds, since the tick rate is only known later. 
+//
+
+#define DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT 2
+#define DEBUG_LOG_HISTOGRAM_SUB_BUCKETS (1 << DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT)
+#define DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT (2*DEBUG_LOG_HISTOGRAM_SUB_BUCKETS)
+#define DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT \
+    (DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT + \
+     (64 - DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT - 1) * \
+     DEBUG_LOG_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct mvm_debug_memory_size_bucket
 {
-    printf("*************************************************************\n");
-    printf("*************************************************************\n");
-    printf("Printing memory allocation information. \n\n");
+    volatile uint64_t Count;
+    volatile uint64_t SlackBytes;
 
+} mvm_debug_memory_size_bucket;
 
-    printf("Turn on - Turn Off calls (0 means debug is off now): %d\n", 
-           GlobalDebugInfoList->TurnOnCount);
-    printf("Debug Memory Operations Count: %d\n", 
-           GlobalDebugInfoList->DebugInfoUnitsCount);
-    printf("Debug Memory Operations Allocated: %d\n", 
-           GlobalDebugInfoList->DebugInfoUnitsAllocated);
 
-    unsigned int DebugMemoryInfoBytesAllocated = 0;
-    unsigned int ProgramBytesAllocated = 0;
+typedef struct mvm_debug_memory_size_histogram
+{
+    // NOTE(Marko): The first size requested at the site, plus one so that 0 
+    //              means "none yet", and how many requests have matched it 
+    //              exactly. A site that mostly repeats one size shows up here. 
+    volatile uint64_t CommonSizePlusOne;
+    volatile uint64_t CommonSizeCount;
 
-    printf("\n\n------------\n");
+    mvm_debug_memory_size_bucket Buckets[DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT];
 
-    for(int DebugInfoIndex = 0; 
-        DebugInfoIndex < GlobalDebugInfoList->DebugInfoUnitsCount; 
-        ++DebugInfoIndex)
-    {
-        printf("Debug Information Unit #%d:\n\n", DebugInfoIndex);
+} mvm_debug_memory_size_histogram;
 
-        mvm_debug_memory_info DebugInfo = 
-            GlobalDebugInfoList->DebugInfoList[DebugInfoIndex];
 
-        for(int MemoryOperationIndex = 0; 
-            MemoryOperationIndex < DebugInfo.DebugInfoOpCount;
-            MemoryOperationIndex++)
-        {
-            printf("\t---------\n");
-            printf("\tMemory Operation #%d\n", MemoryOperationIndex);
-            memory_operation_type MemoryOperation = 
-                DebugInfo.MemoryOperationTypes[MemoryOperationIndex];
+typedef struct mvm_debug_memory_lifetime_histogram
+{
+    // NOTE(Marko): Frees by a thread other than the one that made the block, 
+    //              and with a MVMTurnOnDebugInfo()/MVMTurnOffDebugInfo() in 
+    //              between. Counting the rare case keeps the common free to 
+    //              a single atomic add. 
+    volatile uint64_t OtherThreadCount;
+    volatile uint64_t OtherScopeCount;
 
-            printf("\t\tMemory Operation Type: ");
-            switch(MemoryOperation)
-            {
-                case MemoryOperationType_InitialAllocation: 
-                {
-                    int BytesAllocated = 
-                        DebugInfo.ByteCountArray[MemoryOperationIndex];
-                    void *AddressAllocatedTo = 
-                        DebugInfo.Addresses[MemoryOperationIndex];
-                    mvm_debug_memory_string Filename = 
-                        DebugInfo.Filenames[MemoryOperationIndex];
-                    int LineNumber = 
-                        DebugInfo.LineNumbers[MemoryOperationIndex];
-                    printf("Initial Allocation.\n");
-                    printf("\t\tAllocated %d bytes into address 0x%p\n",
-                           BytesAllocated,
-                           AddressAllocatedTo);
-                    printf("\t\tin file %s\n", 
-                           Filename.Contents);
-                    printf("\t\ton line %d\n", 
-                           LineNumber);
-
-                } break;
-
-                case MemoryOperationType_ReAllocation: 
-                {
-                    int PreviousByteCount = 
-                        DebugInfo.ByteCountArray[MemoryOperationIndex-1];
-                    int CurrentByteCount = 
-                        DebugInfo.ByteCountArray[MemoryOperationIndex];
-                    int ByteAllocationDifference = 
-                        CurrentByteCount - PreviousByteCount;
-                    char ByteDifferenceSign = 
-                        (ByteAllocationDifference >= 0) ? '+' : '-';
-                    void *InitialAddress = DebugInfo.InitialAddress;
-                    void *PreviousAddress = 
-                        DebugInfo.Addresses[MemoryOperationIndex-1];
-                    void *CurrentAddress = 
-                        DebugInfo.Addresses[MemoryOperationIndex];
-                    mvm_debug_memory_string Filename = 
-                        DebugInfo.Filenames[MemoryOperationIndex];
-                    int LineNumber = 
-                        DebugInfo.LineNumbers[MemoryOperationIndex];
-
-                    printf("Reallocation\n");
-                    printf("\t\tOld allocation: %d bytes from address 0x%p\n",
-                           PreviousByteCount,
-                           PreviousAddress);
-                    printf("\t\tNew allocation: %d bytes into address 0x%p\n",
-                           CurrentByteCount,
-                           CurrentAddress);
-                    printf("\t\tAllocation changed by %c%d bytes\n",
-                           ByteDifferenceSign, 
-                           ByteAllocationDifference);
-                    printf("\t\tInitial address: 0x%p\n",
-                           InitialAddress);
-                    printf("\t\tin file %s\n", 
-                           Filename.Contents);
-                    printf("\t\ton line %d\n", 
-                           LineNumber);
-
-                } break;
-
-                case MemoryOperationType_Free: 
-                {
-                    int BytesFreed = 
-                        -DebugInfo.ByteCountArray[MemoryOperationIndex];
-                    void *AddressFreed = 
-                        DebugInfo.PreviousAddress;
-                    void *InitialAddress = 
-                        DebugInfo.InitialAddress;
-                    mvm_debug_memory_string Filename = 
-                        DebugInfo.Filenames[MemoryOperationIndex];
-                    int LineNumber = 
-                        DebugInfo.LineNumbers[MemoryOperationIndex];
-
-                    printf("Free\n");
-                    printf("\t\tFreed %d bytes from address 0x%p\n",
-                           BytesFreed,
-                           AddressFreed);
-                    printf("\t\tMemory Initially allocated into address 0x%p\n", 
-                           InitialAddress);                        
-                    printf("\t\tin file %s\n", 
-                           Filename.Contents);
-                    printf("\t\ton line %d\n", 
-                           LineNumber);
-                } break;
-
-                case MemoryOperationType_Comment: 
-                {
+    volatile uint64_t Counts[DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT];
 
-                } break;
+} mvm_debug_memory_lifetime_histogram;
 
 
-                case MemoryOperationType_TurnOn: 
-                {
-                    mvm_debug_memory_string Filename = 
-                        DebugInfo.Filenames[MemoryOperationIndex];
-                    int LineNumber = 
-                        DebugInfo.LineNumbers[MemoryOperationIndex];
-                    printf("Turn On Debug Tool\n");
-                    printf("\t\tin file %s\n", 
-                           Filename.Contents);
-                    printf("\t\ton line %d\n", 
-                           LineNumber);
-                } break;
-                
-                case MemoryOperationType_TurnOff: 
-                {
-                    mvm_debug_memory_string Filename = 
-                        DebugInfo.Filenames[MemoryOperationIndex];
-                    int LineNumber = 
-                        DebugInfo.LineNumbers[MemoryOperationIndex];
-                    printf("Turn Off Debug Tool\n");
-                    printf("\t\tin file %s\n", 
-                           Filename.Contents);
-                    printf("\t\ton line %d\n", 
-                           LineNumber);
-                } break;
+//
+// NOTE(Marko): realloc() growth patterns. Every realloc() of a tracked block 
+//              is one step of its chain: geometric growth when it grows the 
+//              block by at least 1/DEBUG_REALLOC_GEOMETRIC_DIVISOR of its 
+//              size, additive (+k) growth when by less, or a shrink. The 
+//              block's record keeps which kinds of steps its chain has taken 
+//              so far, and the chain is counted under the worst of them: a 
+//              buffer that grows by a constant is additive even if its 
+//              first steps doubled it. 
+//
+//              Chains are counted from their first realloc() on, live or 
+//              freed. Copied bytes are those of steps that moved the block, 
+//              min(old size, new size) each; additive chains that move show 
+//              up as copied bytes growing with the square of their length. 
+//
+
+#define DEBUG_REALLOC_GEOMETRIC_DIVISOR 4
+
+#define DEBUG_REALLOC_FLAG_STARTED 0x1
+#define DEBUG_REALLOC_FLAG_GEOMETRIC 0x2
+#define DEBUG_REALLOC_FLAG_ADDITIVE 0x4
+#define DEBUG_REALLOC_FLAG_SHRINK 0x8
+#define DEBUG_REALLOC_FLAG_MOVED 0x10
+
+typedef enum realloc_chain_class
+{
+    // NOTE(Marko): Only realloc()s to the size the block already had. 
+    ReallocChainClass_Unchanged,
+    ReallocChainClass_Shrinking,
+    ReallocChainClass_Geometric,
+    ReallocChainClass_Additive,
+
+    ReallocChainClass_Count,
+
+} realloc_chain_class;
+
+typedef struct mvm_debug_memory_realloc_stats
+{
+    volatile uint64_t ChainsCount;
+    volatile uint64_t MovedChainsCount;
+    volatile uint64_t ChainClassCounts[ReallocChainClass_Count];
+
+    volatile uint64_t GeometricStepsCount;
+    volatile uint64_t AdditiveStepsCount;
+    volatile uint64_t ShrinkStepsCount;
+    volatile uint64_t MovedStepsCount;
+
+    // NOTE(Marko): Growth summed over all steps, and over additive steps 
+    //              only, whose average is the site's typical k. 
+    volatile uint64_t GrownBytes;
+    volatile uint64_t AdditiveGrownBytes;
+    volatile uint64_t CopiedBytes;
+
+    // NOTE(Marko): Largest size any chain of the site had. 
+    volatile uint64_t MaxByteCount;
+
+} mvm_debug_memory_realloc_stats;
+
+
+typedef struct mvm_debug_memory_site_table
+{
+    // NOTE(Marko): Guards everything below. Threads keep a small cache of 
+    //              the sites they have seen in front of this, so it is only 
+    //              taken the first few times a thread hits a call site. 
+    mvm_debug_memory_lock Lock;
+
+    // NOTE(Marko): Site 0 is reserved for DEBUG_SITE_ID_NONE. Sites live in 
+    //              DEBUG_SITE_STATS_CHUNK_SIZE chunks that never move, so 
+    //              MVMGetSite() needs no lock; SitesCount only goes up once 
+    //              the new site has been filled in. 
+    volatile uint32_t SitesCount;
+    mvm_debug_memory_site **SiteChunks;
+
+    // NOTE(Marko): (Filename pointer, LineNumber) -> SiteID. This is what the 
+    //              hot path probes. 
+    uint32_t AliasesCount;
+    uint32_t AliasSlotsAllocated;
+    mvm_debug_memory_site_alias *AliasSlots;
+
+    // NOTE(Marko): (Filename contents, LineNumber) -> SiteID + 1. Only probed 
+    //              the first time a new Filename pointer is seen, so that the 
+    //              same __FILE__ string from different translation units 
+    //              (which need not share a pointer) maps to a single site. 
+    uint32_t CanonicalSlotsAllocated;
+    uint32_t *CanonicalSlots;
+
+    // NOTE(Marko): DEBUG_SITE_STATS_DIRECTORY_SIZE entries, allocated with 
+    //              SiteChunks. A site's chunk exists before its ID is handed 
+    //              out. 
+    mvm_debug_memory_site_stats **StatsChunks;
+    mvm_debug_memory_size_histogram ***HistogramChunks;
+    mvm_debug_memory_lifetime_histogram ***LifetimeChunks;
+    mvm_debug_memory_realloc_stats ***ReallocChunks;
+
+} mvm_debug_memory_site_table;
+
+
+mvm_debug_memory_site *
+MVMGetSite(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    mvm_debug_memory_site *Result = 0;
+    if(SiteTable->SiteChunks && (SiteID < DEBUG_SITE_TABLE_MAX_SITES))
+    {
+        mvm_debug_memory_site *Chunk = 
+            SiteTable->SiteChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT];
+        if(Chunk)
+        {
+            Result = Chunk + (SiteID & DEBUG_SITE_STATS_CHUNK_MASK);
+        }
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_site_stats *
+MVMGetSiteStats(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    mvm_debug_memory_site_stats *Result = 0;
+    if(SiteTable->StatsChunks && (SiteID < DEBUG_SITE_TABLE_MAX_SITES))
+    {
+        mvm_debug_memory_site_stats *Chunk = 
+            SiteTable->StatsChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT];
+        if(Chunk)
+        {
+            Result = Chunk + (SiteID & DEBUG_SITE_STATS_CHUNK_MASK);
+        }
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_size_histogram *
+MVMGetSizeHistogram(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    mvm_debug_memory_size_histogram *Result = 0;
+    if(SiteTable->HistogramChunks && (SiteID < DEBUG_SITE_TABLE_MAX_SITES))
+    {
+        mvm_debug_memory_size_histogram **Chunk = 
+            SiteTable->HistogramChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT];
+        if(Chunk)
+        {
+            Result = Chunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK];
+        }
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_lifetime_histogram *
+MVMGetLifetimeHistogram(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    mvm_debug_memory_lifetime_histogram *Result = 0;
+    if(SiteTable->LifetimeChunks && (SiteID < DEBUG_SITE_TABLE_MAX_SITES))
+    {
+        mvm_debug_memory_lifetime_histogram **Chunk = 
+            SiteTable->LifetimeChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT];
+        if(Chunk)
+        {
+            Result = Chunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK];
+        }
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_realloc_stats *
+MVMGetReallocStats(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    mvm_debug_memory_realloc_stats *Result = 0;
+    if(SiteTable->ReallocChunks && (SiteID < DEBUG_SITE_TABLE_MAX_SITES))
+    {
+        mvm_debug_memory_realloc_stats **Chunk = 
+            SiteTable->ReallocChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT];
+        if(Chunk)
+        {
+            Result = Chunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK];
+        }
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Called with the site table lock held, before SiteID is 
+//              published. 
+void MVMEnsureSiteStats(mvm_debug_memory_site_table *SiteTable, uint32_t SiteID)
+{
+    if(!SiteTable->StatsChunks)
+    {
+        SiteTable->StatsChunks = 
+            (mvm_debug_memory_site_stats **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *SiteTable->StatsChunks) * 
+                DEBUG_SITE_STATS_DIRECTORY_SIZE);
+        SiteTable->HistogramChunks = 
+            (mvm_debug_memory_size_histogram ***)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *SiteTable->HistogramChunks) * 
+                DEBUG_SITE_STATS_DIRECTORY_SIZE);
+        SiteTable->LifetimeChunks = 
+            (mvm_debug_memory_lifetime_histogram ***)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *SiteTable->LifetimeChunks) * 
+                DEBUG_SITE_STATS_DIRECTORY_SIZE);
+        SiteTable->ReallocChunks = 
+            (mvm_debug_memory_realloc_stats ***)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *SiteTable->ReallocChunks) * 
+                DEBUG_SITE_STATS_DIRECTORY_SIZE);
+    }
+    if(SiteTable->StatsChunks && 
+       !SiteTable->StatsChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT])
+    {
+        SiteTable->StatsChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] = 
+            (mvm_debug_memory_site_stats *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof(mvm_debug_memory_site_stats)) * 
+                DEBUG_SITE_STATS_CHUNK_SIZE);
+    }
+    if(SiteTable->HistogramChunks && 
+       !SiteTable->HistogramChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT])
+    {
+        SiteTable->HistogramChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] = 
+            (mvm_debug_memory_size_histogram **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof(mvm_debug_memory_size_histogram *)) * 
+                DEBUG_SITE_STATS_CHUNK_SIZE);
+    }
+    mvm_debug_memory_size_histogram **HistogramChunk = 
+        SiteTable->HistogramChunks ? 
+        SiteTable->HistogramChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] : 0;
+    if(HistogramChunk && !HistogramChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK])
+    {
+        HistogramChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK] = 
+            (mvm_debug_memory_size_histogram *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                sizeof(mvm_debug_memory_size_histogram));
+    }
+    if(SiteTable->LifetimeChunks && 
+       !SiteTable->LifetimeChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT])
+    {
+        SiteTable->LifetimeChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] = 
+            (mvm_debug_memory_lifetime_histogram **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof(mvm_debug_memory_lifetime_histogram *)) * 
+                DEBUG_SITE_STATS_CHUNK_SIZE);
+    }
+    mvm_debug_memory_lifetime_histogram **LifetimeChunk = 
+        SiteTable->LifetimeChunks ? 
+        SiteTable->LifetimeChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] : 0;
+    if(LifetimeChunk && !LifetimeChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK])
+    {
+        LifetimeChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK] = 
+            (mvm_debug_memory_lifetime_histogram *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                sizeof(mvm_debug_memory_lifetime_histogram));
+    }
+    if(SiteTable->ReallocChunks && 
+       !SiteTable->ReallocChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT])
+    {
+        SiteTable->ReallocChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] = 
+            (mvm_debug_memory_realloc_stats **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof(mvm_debug_memory_realloc_stats *)) * 
+                DEBUG_SITE_STATS_CHUNK_SIZE);
+    }
+    mvm_debug_memory_realloc_stats **ReallocChunk = 
+        SiteTable->ReallocChunks ? 
+        SiteTable->ReallocChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] : 0;
+    if(ReallocChunk && !ReallocChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK])
+    {
+        ReallocChunk[SiteID & DEBUG_SITE_STATS_CHUNK_MASK] = 
+            (mvm_debug_memory_realloc_stats *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                sizeof(mvm_debug_memory_realloc_stats));
+    }
+    if(!MVMGetSiteStats(SiteTable, SiteID) || 
+       !MVMGetSizeHistogram(SiteTable, SiteID) || 
+       !MVMGetLifetimeHistogram(SiteTable, SiteID) || 
+       !MVMGetReallocStats(SiteTable, SiteID))
+    {
+        printf("Debug arena allocation failed while allocating call-site statistics.\n");
+    }
+}
+
+
+uint32_t MVMGetLogBucketIndex(uint64_t Size)
+{
+    if(Size < DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT)
+    {
+        return((uint32_t)Size);
+    }
+    uint32_t Exponent = MVMFloorLog2U64(Size);
+    uint32_t SubBucket = 
+        (uint32_t)(Size >> (Exponent - DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT)) & 
+        (DEBUG_LOG_HISTOGRAM_SUB_BUCKETS - 1);
+    return(DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT + 
+           (Exponent - DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT - 1) * 
+           DEBUG_LOG_HISTOGRAM_SUB_BUCKETS + 
+           SubBucket);
+}
+
+
+// NOTE(Marko): Smallest size that lands in the bucket. 
+uint64_t MVMGetLogBucketMin(uint32_t BucketIndex)
+{
+    if(BucketIndex < DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT)
+    {
+        return(BucketIndex);
+    }
+    uint32_t Offset = BucketIndex - DEBUG_LOG_HISTOGRAM_LINEAR_LIMIT;
+    uint32_t Exponent = Offset / DEBUG_LOG_HISTOGRAM_SUB_BUCKETS + 
+                        DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT + 1;
+    uint64_t SubBucket = Offset & (DEBUG_LOG_HISTOGRAM_SUB_BUCKETS - 1);
+    return((DEBUG_LOG_HISTOGRAM_SUB_BUCKETS + SubBucket) << 
+           (Exponent - DEBUG_LOG_HISTOGRAM_SUB_BUCKET_SHIFT));
+}
+
+
+void MVMRecordRequestedSize(mvm_debug_memory_size_histogram *Histogram, 
+                            size_t MemorySize, 
+                            size_t SlackBytes)
+{
+    mvm_debug_memory_size_bucket *Bucket = 
+        Histogram->Buckets + MVMGetLogBucketIndex(MemorySize);
+    MVMAtomicAddU64(&Bucket->Count, 1);
+    if(SlackBytes)
+    {
+        MVMAtomicAddU64(&Bucket->SlackBytes, SlackBytes);
+    }
+
+    uint64_t CommonSizePlusOne = 
+        MVMAtomicLoadU64(&Histogram->CommonSizePlusOne);
+    if(!CommonSizePlusOne)
+    {
+        CommonSizePlusOne = 
+            MVMAtomicCompareExchangeU64(&Histogram->CommonSizePlusOne, 
+                                        0, (uint64_t)MemorySize + 1);
+        if(!CommonSizePlusOne)
+        {
+            CommonSizePlusOne = (uint64_t)MemorySize + 1;
+        }
+    }
+    if(CommonSizePlusOne == (uint64_t)MemorySize + 1)
+    {
+        MVMAtomicAddU64(&Histogram->CommonSizeCount, 1);
+    }
+}
+
+
+// NOTE(Marko): Adds ByteCountChange (which may be negative) to the site's 
+//              live bytes and raises its peak if need be. 
+void MVMSiteStatsChangeLiveBytes(mvm_debug_memory_site_stats *Stats, 
+                                 int64_t ByteCountChange)
+{
+    uint64_t LiveBytes = 
+        MVMAtomicAddU64(&Stats->LiveBytes, (uint64_t)ByteCountChange) + 
+        (uint64_t)ByteCountChange;
+    if(ByteCountChange > 0)
+    {
+        MVMAtomicMaxU64(&Stats->PeakLiveBytes, LiveBytes);
+    }
+}
+
+
+size_t MVMHashCallSitePointer(const char *Filename, int LineNumber)
+{
+    uint64_t Hash = (uint64_t)(uintptr_t)Filename ^ 
+        ((uint64_t)(uint32_t)LineNumber << 32);
+    Hash ^= Hash >> 33;
+    Hash *= 0xFF51AFD7ED558CCDULL;
+    Hash ^= Hash >> 33;
+    return (size_t)Hash;
+}
+
+
+size_t MVMHashCallSiteContents(const char *Filename, int LineNumber)
+{
+    // NOTE(Marko): FNV-1a 
+    uint64_t Hash = 0xCBF29CE484222325ULL;
+    for(const char *Character = Filename; *Character; Character++)
+    {
+        Hash ^= (uint8_t)*Character;
+        Hash *= 0x100000001B3ULL;
+    }
+    Hash ^= (uint64_t)(uint32_t)LineNumber;
+    Hash *= 0x100000001B3ULL;
+    return (size_t)Hash;
+}
+
+
+void MVMSiteTableRehash(mvm_debug_memory_site_table *SiteTable)
+{
+    // NOTE(Marko): Both lookup tables are kept at no more than half full. 
+    uint32_t NewAliasSlotsAllocated = SiteTable->AliasSlotsAllocated ? 
+        SiteTable->AliasSlotsAllocated : DEBUG_SITE_TABLE_INITIAL_SIZE;
+    while((SiteTable->AliasesCount + 1)*2 >= NewAliasSlotsAllocated)
+    {
+        NewAliasSlotsAllocated *= 2;
+    }
+    if(NewAliasSlotsAllocated != SiteTable->AliasSlotsAllocated)
+    {
+        mvm_debug_memory_site_alias *NewAliasSlots = 
+            (mvm_debug_memory_site_alias *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *NewAliasSlots) * NewAliasSlotsAllocated);
+        if(!NewAliasSlots)
+        {
+            printf("Debug arena allocation failed while growing the call-site alias table.\n");
+            return;
+        }
+        size_t Mask = NewAliasSlotsAllocated - 1;
+        for(uint32_t OldSlotIndex = 0; 
+            OldSlotIndex < SiteTable->AliasSlotsAllocated; 
+            OldSlotIndex++)
+        {
+            mvm_debug_memory_site_alias *OldSlot = 
+                SiteTable->AliasSlots + OldSlotIndex;
+            if(OldSlot->Filename)
+            {
+                size_t SlotIndex = 
+                    MVMHashCallSitePointer(OldSlot->Filename, 
+                                           OldSlot->LineNumber) & Mask;
+                while(NewAliasSlots[SlotIndex].Filename)
+                {
+                    SlotIndex = (SlotIndex + 1) & Mask;
+                }
+                NewAliasSlots[SlotIndex] = *OldSlot;
+            }
+        }
+        MVMArenaFree(&GlobalDebugArena, 
+                     SiteTable->AliasSlots, 
+                     (sizeof *SiteTable->AliasSlots) * 
+                     SiteTable->AliasSlotsAllocated);
+        SiteTable->AliasSlots = NewAliasSlots;
+        SiteTable->AliasSlotsAllocated = NewAliasSlotsAllocated;
+    }
+
+    uint32_t NewCanonicalSlotsAllocated = SiteTable->CanonicalSlotsAllocated ? 
+        SiteTable->CanonicalSlotsAllocated : DEBUG_SITE_TABLE_INITIAL_SIZE;
+    while((SiteTable->SitesCount + 1)*2 >= NewCanonicalSlotsAllocated)
+    {
+        NewCanonicalSlotsAllocated *= 2;
+    }
+    if(NewCanonicalSlotsAllocated != SiteTable->CanonicalSlotsAllocated)
+    {
+        uint32_t *NewCanonicalSlots = 
+            (uint32_t *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *NewCanonicalSlots) * NewCanonicalSlotsAllocated);
+        if(!NewCanonicalSlots)
+        {
+            printf("Debug arena allocation failed while growing the call-site table.\n");
+            return;
+        }
+        size_t Mask = NewCanonicalSlotsAllocated - 1;
+        for(uint32_t SiteID = 1; SiteID < SiteTable->SitesCount; SiteID++)
+        {
+            mvm_debug_memory_site *Site = MVMGetSite(SiteTable, SiteID);
+            size_t SlotIndex = 
+                MVMHashCallSiteContents(Site->Filename, 
+                                        Site->LineNumber) & Mask;
+            while(NewCanonicalSlots[SlotIndex])
+            {
+                SlotIndex = (SlotIndex + 1) & Mask;
+            }
+            NewCanonicalSlots[SlotIndex] = SiteID + 1;
+        }
+        MVMArenaFree(&GlobalDebugArena, 
+                     SiteTable->CanonicalSlots, 
+                     (sizeof *SiteTable->CanonicalSlots) * 
+                     SiteTable->CanonicalSlotsAllocated);
+        SiteTable->CanonicalSlots = NewCanonicalSlots;
+        SiteTable->CanonicalSlotsAllocated = NewCanonicalSlotsAllocated;
+    }
+}
+
+
+// NOTE(Marko): Makes sure SiteID's chunk exists and returns its site, or 0 
+//              when the arena is out of memory. Called with the site table 
+//              lock held. 
+mvm_debug_memory_site *MVMAllocateSite(mvm_debug_memory_site_table *SiteTable, 
+                                       uint32_t SiteID)
+{
+    if(SiteTable->SiteChunks && 
+       !SiteTable->SiteChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT])
+    {
+        SiteTable->SiteChunks[SiteID >> DEBUG_SITE_STATS_CHUNK_SHIFT] = 
+            (mvm_debug_memory_site *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof(mvm_debug_memory_site)) * DEBUG_SITE_STATS_CHUNK_SIZE);
+    }
+    return(MVMGetSite(SiteTable, SiteID));
+}
+
+
+uint32_t MVMInternCallSiteSlow(mvm_debug_memory_site_table *SiteTable, 
+                               const char *Filename, 
+                               int LineNumber)
+{
+    uint32_t Result = DEBUG_SITE_ID_NONE;
+
+    if(!SiteTable->SiteChunks)
+    {
+        SiteTable->SiteChunks = 
+            (mvm_debug_memory_site **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *SiteTable->SiteChunks) * 
+                DEBUG_SITE_STATS_DIRECTORY_SIZE);
+        mvm_debug_memory_site *Site = 
+            MVMAllocateSite(SiteTable, DEBUG_SITE_ID_NONE);
+        if(!Site)
+        {
+            printf("Debug arena allocation failed while allocating the call-site table.\n");
+            return(Result);
+        }
+        Site->Filename = "<unknown>";
+        Site->LineNumber = 0;
+        MVMEnsureSiteStats(SiteTable, DEBUG_SITE_ID_NONE);
+        MVMAtomicStoreU32(&SiteTable->SitesCount, 1);
+    }
+    if(!SiteTable->SitesCount)
+    {
+        return(Result);
+    }
+
+    MVMSiteTableRehash(SiteTable);
+    if(!SiteTable->AliasSlots || !SiteTable->CanonicalSlots)
+    {
+        return(Result);
+    }
+
+    // NOTE(Marko): Find or create the canonical site by string contents. 
+    size_t Mask = SiteTable->CanonicalSlotsAllocated - 1;
+    size_t SlotIndex = MVMHashCallSiteContents(Filename, LineNumber) & Mask;
+    while(SiteTable->CanonicalSlots[SlotIndex])
+    {
+        uint32_t SiteID = SiteTable->CanonicalSlots[SlotIndex] - 1;
+        mvm_debug_memory_site *Site = MVMGetSite(SiteTable, SiteID);
+        if((Site->LineNumber == LineNumber) && 
+           (strcmp(Site->Filename, Filename) == 0))
+        {
+            Result = SiteID;
+            break;
+        }
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+
+    if(Result == DEBUG_SITE_ID_NONE)
+    {
+        if(SiteTable->SitesCount >= DEBUG_SITE_TABLE_MAX_SITES)
+        {
+            printf("Call-site table is full. %s:%d will be recorded as an unknown site.\n", 
+                   Filename, 
+                   LineNumber);
+            return(Result);
+        }
+
+        mvm_debug_memory_site *Site = 
+            MVMAllocateSite(SiteTable, SiteTable->SitesCount);
+        if(!Site)
+        {
+            printf("Debug arena allocation failed while growing the call-site table.\n");
+            return(Result);
+        }
+
+        Result = SiteTable->SitesCount;
+        MVMEnsureSiteStats(SiteTable, Result);
+        Site->Filename = Filename;
+        Site->LineNumber = LineNumber;
+        MVMAtomicStoreU32(&SiteTable->SitesCount, Result + 1);
+        SiteTable->CanonicalSlots[SlotIndex] = Result + 1;
+    }
+
+    // NOTE(Marko): Remember this pointer so the next lookup is a single probe. 
+    Mask = SiteTable->AliasSlotsAllocated - 1;
+    SlotIndex = MVMHashCallSitePointer(Filename, LineNumber) & Mask;
+    while(SiteTable->AliasSlots[SlotIndex].Filename)
+    {
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+    SiteTable->AliasSlots[SlotIndex].Filename = Filename;
+    SiteTable->AliasSlots[SlotIndex].LineNumber = LineNumber;
+    SiteTable->AliasSlots[SlotIndex].SiteID = Result;
+    SiteTable->AliasesCount++;
+
+    return(Result);
+}
+
+
+uint32_t MVMInternCallSite(mvm_debug_memory_site_table *SiteTable, 
+                           const char *Filename, 
+                           int LineNumber)
+{
+    uint32_t Result = DEBUG_SITE_ID_NONE;
+    int Found = 0;
+
+    MVMLockAcquire(&SiteTable->Lock);
+    if(SiteTable->AliasSlots)
+    {
+        size_t Mask = SiteTable->AliasSlotsAllocated - 1;
+        size_t SlotIndex = MVMHashCallSitePointer(Filename, LineNumber) & Mask;
+        while(SiteTable->AliasSlots[SlotIndex].Filename)
+        {
+            mvm_debug_memory_site_alias *Alias = 
+                SiteTable->AliasSlots + SlotIndex;
+            if((Alias->Filename == Filename) && 
+               (Alias->LineNumber == LineNumber))
+            {
+                Result = Alias->SiteID;
+                Found = 1;
+                break;
+            }
+            SlotIndex = (SlotIndex + 1) & Mask;
+        }
+    }
+    if(!Found)
+    {
+        Result = MVMInternCallSiteSlow(SiteTable, Filename, LineNumber);
+    }
+    MVMLockRelease(&SiteTable->Lock);
+
+    return(Result);
+}
+
+
+//
+// NOTE(Marko): Call-stack table. With stack capture on, every tracked 
+//              allocation also records the return addresses that led to it. 
+//              Identical stacks are stored once and named by a 32-bit stack 
+//              ID, the same way call sites are, so a live record only grows by 
+//              that ID. Addresses are turned into names at report time only. 
+//
+//              Stack records live in fixed chunks that never move, so a 
+//              thread holding an ID can read its frames without the lock. 
+//
+
+#define DEBUG_STACK_MAX_DEPTH 64
+#define DEBUG_STACK_ID_NONE 0
+#define DEBUG_STACK_TABLE_INITIAL_SIZE 256
+#define DEBUG_STACK_CHUNK_SHIFT 12
+#define DEBUG_STACK_CHUNK_SIZE (1 << DEBUG_STACK_CHUNK_SHIFT)
+#define DEBUG_STACK_CHUNK_MASK (DEBUG_STACK_CHUNK_SIZE - 1)
+#define DEBUG_STACK_TABLE_MAX_STACKS (1 << 24)
+#define DEBUG_STACK_DIRECTORY_SIZE \
+    (DEBUG_STACK_TABLE_MAX_STACKS >> DEBUG_STACK_CHUNK_SHIFT)
+
+// NOTE(Marko): A frame chain that stops on a frame pointer that does not look 
+//              like one of this thread's frames, having found fewer frames 
+//              than this, is taken to mean the code was built without frame 
+//              pointers, and the unwinder is used instead. 
+#define DEBUG_STACK_MIN_FRAME_POINTER_FRAMES 2
+
+// NOTE(Marko): Nothing is mapped below 64 KB by default (Linux's 
+//              mmap_min_addr), so a smaller return address means the walk has 
+//              left the real frame chain. 
+#define DEBUG_STACK_MIN_CODE_ADDRESS 0x10000
+
+typedef struct mvm_debug_memory_stack
+{
+    uint64_t Hash;
+    uint32_t FramesCount;
+    void **Frames;
+
+} mvm_debug_memory_stack;
+
+
+typedef struct mvm_debug_memory_stack_table
+{
+    // NOTE(Marko): Guards everything below. Taken only the first time a 
+    //              thread sees a stack; see the thread's StackCache. 
+    mvm_debug_memory_lock Lock;
+
+    // NOTE(Marko): Stack 0 is reserved for DEBUG_STACK_ID_NONE. 
+    volatile uint32_t StacksCount;
+
+    // NOTE(Marko): DEBUG_STACK_DIRECTORY_SIZE entries. A stack's chunk and 
+    //              frames exist before its ID is handed out. 
+    mvm_debug_memory_stack **StackChunks;
+
+    // NOTE(Marko): Hash -> StackID, open addressing, at most half full. 0 
+    //              marks an empty slot. 
+    uint32_t SlotsAllocated;
+    uint32_t *Slots;
+
+} mvm_debug_memory_stack_table;
+
+
+mvm_debug_memory_stack *
+MVMGetStack(mvm_debug_memory_stack_table *StackTable, uint32_t StackID)
+{
+    mvm_debug_memory_stack *Result = 0;
+    if(StackTable->StackChunks && 
+       (StackID != DEBUG_STACK_ID_NONE) && 
+       (StackID < MVMAtomicLoadU32(&StackTable->StacksCount)))
+    {
+        Result = StackTable->StackChunks[StackID >> DEBUG_STACK_CHUNK_SHIFT] + 
+            (StackID & DEBUG_STACK_CHUNK_MASK);
+    }
+    return(Result);
+}
+
+
+uint64_t MVMHashStack(void **Frames, uint32_t FramesCount)
+{
+    uint64_t Hash = FramesCount;
+    for(uint32_t FrameIndex = 0; FrameIndex < FramesCount; FrameIndex++)
+    {
+        Hash ^= (uint64_t)(uintptr_t)Frames[FrameIndex];
+        Hash *= 0xFF51AFD7ED558CCDULL;
+        Hash ^= Hash >> 32;
+    }
+    return(Hash);
+}
+
+
+int MVMStackMatches(mvm_debug_memory_stack *Stack, 
+                    uint64_t Hash, 
+                    void **Frames, 
+                    uint32_t FramesCount)
+{
+    return((Stack->Hash == Hash) && 
+           (Stack->FramesCount == FramesCount) && 
+           !memcmp(Stack->Frames, Frames, (sizeof *Frames) * FramesCount));
+}
+
+
+// NOTE(Marko): Called with the stack table lock held. 
+int MVMStackTableGrow(mvm_debug_memory_stack_table *StackTable)
+{
+    if(!StackTable->StackChunks)
+    {
+        StackTable->StackChunks = 
+            (mvm_debug_memory_stack **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *StackTable->StackChunks) * DEBUG_STACK_DIRECTORY_SIZE);
+        if(!StackTable->StackChunks)
+        {
+            printf("Debug arena allocation failed while allocating the call-stack table.\n");
+            return(0);
+        }
+        StackTable->StacksCount = 1;
+    }
+
+    uint32_t NewSlotsAllocated = StackTable->SlotsAllocated ? 
+        StackTable->SlotsAllocated : DEBUG_STACK_TABLE_INITIAL_SIZE;
+    while((StackTable->StacksCount + 1)*2 >= NewSlotsAllocated)
+    {
+        NewSlotsAllocated *= 2;
+    }
+    if(NewSlotsAllocated != StackTable->SlotsAllocated)
+    {
+        uint32_t *NewSlots = (uint32_t *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *NewSlots) * NewSlotsAllocated);
+        if(!NewSlots)
+        {
+            printf("Debug arena allocation failed while growing the call-stack table.\n");
+            return(0);
+        }
+        size_t Mask = NewSlotsAllocated - 1;
+        for(uint32_t StackID = 1; StackID < StackTable->StacksCount; StackID++)
+        {
+            size_t SlotIndex = MVMGetStack(StackTable, StackID)->Hash & Mask;
+            while(NewSlots[SlotIndex])
+            {
+                SlotIndex = (SlotIndex + 1) & Mask;
+            }
+            NewSlots[SlotIndex] = StackID;
+        }
+        MVMArenaFree(&GlobalDebugArena, 
+                     StackTable->Slots, 
+                     (sizeof *StackTable->Slots) * StackTable->SlotsAllocated);
+        StackTable->Slots = NewSlots;
+        StackTable->SlotsAllocated = NewSlotsAllocated;
+    }
+    return(1);
+}
+
+
+uint32_t MVMInternStack(mvm_debug_memory_stack_table *StackTable, 
+                        uint64_t Hash, 
+                        void **Frames, 
+                        uint32_t FramesCount)
+{
+    uint32_t Result = DEBUG_STACK_ID_NONE;
+
+    MVMLockAcquire(&StackTable->Lock);
+    if(MVMStackTableGrow(StackTable))
+    {
+        size_t Mask = StackTable->SlotsAllocated - 1;
+        size_t SlotIndex = Hash & Mask;
+        while(StackTable->Slots[SlotIndex])
+        {
+            uint32_t StackID = StackTable->Slots[SlotIndex];
+            if(MVMStackMatches(MVMGetStack(StackTable, StackID), 
+                               Hash, Frames, FramesCount))
+            {
+                Result = StackID;
+                break;
+            }
+            SlotIndex = (SlotIndex + 1) & Mask;
+        }
+
+        uint32_t StackID = StackTable->StacksCount;
+        if((Result == DEBUG_STACK_ID_NONE) && 
+           (StackID < DEBUG_STACK_TABLE_MAX_STACKS))
+        {
+            mvm_debug_memory_stack **Chunk = 
+                StackTable->StackChunks + (StackID >> DEBUG_STACK_CHUNK_SHIFT);
+            if(!*Chunk)
+            {
+                *Chunk = (mvm_debug_memory_stack *)MVMArenaAllocate(
+                    &GlobalDebugArena, 
+                    (sizeof **Chunk) * DEBUG_STACK_CHUNK_SIZE);
+            }
+            void **StackFrames = (void **)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *Frames) * FramesCount);
+            if(*Chunk && StackFrames)
+            {
+                mvm_debug_memory_stack *Stack = 
+                    *Chunk + (StackID & DEBUG_STACK_CHUNK_MASK);
+                memcpy(StackFrames, Frames, (sizeof *Frames) * FramesCount);
+                Stack->Hash = Hash;
+                Stack->FramesCount = FramesCount;
+                Stack->Frames = StackFrames;
+                StackTable->Slots[SlotIndex] = StackID;
+                MVMAtomicStoreU32(&StackTable->StacksCount, StackID + 1);
+                Result = StackID;
+            }
+            else
+            {
+                printf("Debug arena allocation failed while adding a call stack.\n");
+            }
+        }
+    }
+    MVMLockRelease(&StackTable->Lock);
+
+    return(Result);
+}
+
+
+typedef enum memory_operation_type
+{
+    MemoryOperationType_NotAssigned = 0,
+
+    MemoryOperationType_InitialAllocation,
+    MemoryOperationType_ReAllocation,
+    MemoryOperationType_Free,
+    MemoryOperationType_Comment,
+    MemoryOperationType_TurnOn,
+    MemoryOperationType_TurnOff,
+
+
+} memory_operation_type;
+
+
+//
+// NOTE(Marko): Event log. Every memory operation appends one fixed-size 
+//              record to a single append-only log, so recording is a 
+//              sequential write and reporting is a linear scan. The history 
+//              of one allocation is a chain through the log: each event 
+//              points back at the previous event of the same allocation. 
+//              The log is stored in fixed-size chunks so that appending never 
+//              moves the events that are already there. 
+//
+//              Threads do not share a write cursor. Each thread reserves a 
+//              block of DEBUG_EVENT_BLOCK_SIZE consecutive event indices with 
+//              one atomic add and fills it on its own, so recording an event 
+//              takes no lock. Log order is therefore only time order within 
+//              a block; MVMBeginEventMerge() puts the blocks back together. 
+//
+
+#define DEBUG_EVENT_CHUNK_SHIFT 16
+#define DEBUG_EVENT_CHUNK_SIZE (1 << DEBUG_EVENT_CHUNK_SHIFT)
+#define DEBUG_EVENT_CHUNK_MASK (DEBUG_EVENT_CHUNK_SIZE - 1)
+// NOTE(Marko): The chunk directory is two levels of fixed size, so it never 
+//              moves and lock-free readers can always follow it. Pages of 
+//              chunk pointers are allocated as the log reaches them; the 
+//              log holds at most DEBUG_EVENT_MAX_CHUNKS chunks (2^36 events). 
+#define DEBUG_EVENT_DIRECTORY_PAGE_SHIFT 10
+#define DEBUG_EVENT_DIRECTORY_PAGE_SIZE (1 << DEBUG_EVENT_DIRECTORY_PAGE_SHIFT)
+#define DEBUG_EVENT_DIRECTORY_PAGE_MASK (DEBUG_EVENT_DIRECTORY_PAGE_SIZE - 1)
+#define DEBUG_EVENT_DIRECTORY_PAGES_COUNT 1024
+#define DEBUG_EVENT_MAX_CHUNKS \
+    ((size_t)DEBUG_EVENT_DIRECTORY_PAGES_COUNT*DEBUG_EVENT_DIRECTORY_PAGE_SIZE)
+// NOTE(Marko): Must divide DEBUG_EVENT_CHUNK_SIZE so no block straddles two 
+//              chunks. 
+#define DEBUG_EVENT_BLOCK_SIZE 1024
+// NOTE(Marko): Block first event indices are multiples of 
+//              DEBUG_EVENT_BLOCK_SIZE, so their low bit is free for this. 
+#define DEBUG_EVENT_RING_BLOCK_BUSY 1
+// NOTE(Marko): Smallest ring the bounded mode will build, in blocks. A ring 
+//              only a few blocks long would be lapped by one thread while 
+//              another is still filling its block. 
+#define DEBUG_EVENT_RING_MIN_BLOCKS 64
+#define DEBUG_EVENT_INDEX_NONE ((uint64_t)-1)
+#define DEBUG_EVENT_SITE_ID_BITS 24
+#define DEBUG_EVENT_SITE_ID_MASK ((1u << DEBUG_EVENT_SITE_ID_BITS) - 1)
+
+typedef struct mvm_debug_memory_event
+{
+    uint64_t Timestamp;
+
+    // NOTE(Marko): - InitialAllocation, ReAllocation: the address handed back
+    //              - Free: the address that was freed
+    //              - TurnOn, TurnOff: 0
+    uint64_t Address;
+
+    // NOTE(Marko): Size of the block after the operation. For a Free, the 
+    //              number of bytes that were released. 
+    uint64_t ByteCount;
+
+    // NOTE(Marko): Low DEBUG_EVENT_SITE_ID_BITS bits hold the call-site ID, 
+    //              the high bits the memory_operation_type. Written last; an 
+    //              event whose type is still NotAssigned is an unused slot at 
+    //              the end of some thread's block. 
+    uint32_t SiteAndType;
+
+    // NOTE(Marko): This event's index minus the index of the previous event 
+    //              of the same allocation. 0 if this event starts the chain 
+    //              (or the previous event is too far away to encode). Can be 
+    //              negative when the previous event was recorded by another 
+    //              thread into a block with higher indices. 
+    int32_t PreviousEventOffset;
+
+} mvm_debug_memory_event;
+
+// NOTE(Marko): Keep events packed. Two per cache line. 
+typedef char mvm_debug_memory_event_size_check[
+    ((sizeof(mvm_debug_memory_event) == 32) ? 1 : -1)];
+
+
+//
+// NOTE(Marko): Settings read once, when the list is created. Pass them to 
+//              MVMDebugMemoryInitialize() before the first 
+//              MVMTurnOnDebugInfo(); the zeroed defaults keep every event. 
+//
+//              Setting MaxEventsCount or MaxEventBytes (the smaller wins if 
+//              both are set) switches the log to a ring: once it is full the 
+//              oldest events are overwritten, so the log never grows past 
+//              that size no matter how long the process runs. Live 
+//              allocations are tracked outside the log and are unaffected; 
+//              only the history of old operations is lost. 
+//
+//              Setting SampleIntervalBytes switches to sampling: allocated 
+//              bytes are treated as a Poisson process with one sample point 
+//              every SampleIntervalBytes on average, and an allocation is 
+//              tracked only if a point lands inside it. A block of S bytes is 
+//              therefore kept with probability 1 - exp(-S/SampleIntervalBytes) 
+//              and everything else costs one counter decrement. Reports scale 
+//              each tracked block back up by that probability. A free() or 
+//              realloc() of an untracked block is expected and not reported. 
+//
+//              Setting TraceFilename streams every event to that file as it 
+//              is recorded (see the trace format below). No history is then 
+//              kept in memory at all: each thread fills a private block that 
+//              goes straight to the trace, the event limits above are 
+//              ignored, and reports only show live allocations. 
+//
+//              Setting TimelineResolutionMicroseconds records live bytes over 
+//              time in a fixed-size buffer, starting at that resolution and 
+//              coarsening as the run gets longer. 
+//
+//              Setting ReportLeaksAtExit prints a leak report grouped by call 
+//              site when the program exits, and writes it as CSV to 
+//              LeakReportFilename if that is set. With a non-zero 
+//              LeakExitCode the process exits with that code whenever more 
+//              than LeakThresholdBytes are still live. 
+//
+//              Setting StackDepth records up to that many return addresses 
+//              (at most DEBUG_STACK_MAX_DEPTH) for each tracked allocation, 
+//              and the leak report groups leaks by call stack as well as by 
+//              site. Stacks are walked through frame pointers, so build with 
+//              -fno-omit-frame-pointer; where the chain is missing, or with 
+//              StackUseUnwinder set, the slower system unwinder is used. On 
+//              POSIX systems link with -rdynamic to get function names. 
+//
+//              Setting IgnoreUntrackedPointers stops realloc() and free() from 
+//              reporting pointers the tool has never seen, for programs that 
+//              legitimately free memory allocated while it was off. 
+//
+//              Setting RedzoneBytes pads every tracked block with that many 
+//              canary bytes on each side (rounded up to 
+//              DEBUG_REDZONE_ALIGNMENT; in front of an aligned block, at 
+//              least the alignment). The canaries are checked when the block 
+//              is freed or reallocated, and a write past either end is 
+//              reported with the block's allocation site and stack. Sampling 
+//              is off in this mode, since every padded block has to be 
+//              recognized again when it is released; padded blocks must also 
+//              be released before MVMDebugMemoryShutdown(). Setting 
+//              RedzoneSweepIntervalMilliseconds as well starts a thread that 
+//              checks live blocks in the background: once per interval it 
+//              walks on through the live table for at most 
+//              RedzoneSweepBudgetMicroseconds (DEBUG_REDZONE_SWEEP_BUDGET_US 
+//              if 0), so blocks that are never freed get checked too. Each 
+//              damaged block is reported once. 
+//
+//              Setting GuardPagesMaxBytes puts every tracked block of 
+//              GuardPagesMinBytes to GuardPagesMaxBytes bytes on pages of its 
+//              own, ending where an inaccessible guard page begins; 
+//              MVMDebugMemoryGuardSite() does the same for one call site. 
+//              Blocks stay DEBUG_GUARD_PAGE_ALIGNMENT-aligned (or as aligned 
+//              as asked for), so the first access more than that slack past 
+//              the end faults on the spot. A fault handler then prints the 
+//              block's allocation site and stack, and the fault takes its 
+//              normal course. The slack and the rest of the block's pages 
+//              are filled with canaries and checked like redzones. Each 
+//              guarded block takes at least two pages, so keep the selection 
+//              narrow. Guarded blocks are tracked even when sampling, and 
+//              must be released before MVMDebugMemoryShutdown(). 
+//
+//              Setting QuarantineBytes keeps freed blocks away from the C 
+//              library until up to that many bytes are held, oldest out 
+//              first. Their bytes are filled with DEBUG_QUARANTINE_POISON, 
+//              which is checked when they leave, so a write through a 
+//              dangling pointer is reported with the block's allocation and 
+//              free sites. A guarded block's pages are made inaccessible 
+//              instead, so any access faults on the spot. Freeing a block 
+//              that is still in quarantine is reported as a double free and 
+//              the free is dropped. Blocks larger than QuarantineBytes skip 
+//              it. Sampling is off in this mode as well. 
+//              MVMDebugMemoryFlushQuarantine() checks and frees everything 
+//              held so far. 
+//
+
+typedef struct mvm_debug_memory_config
+{
+    size_t MaxEventsCount;
+    size_t MaxEventBytes;
+    size_t SampleIntervalBytes;
+    const char *TraceFilename;
+    uint32_t TimelineResolutionMicroseconds;
+    int ReportLeaksAtExit;
+    const char *LeakReportFilename;
+    size_t LeakThresholdBytes;
+    int LeakExitCode;
+    uint32_t StackDepth;
+    int StackUseUnwinder;
+    int IgnoreUntrackedPointers;
+    size_t RedzoneBytes;
+    uint32_t RedzoneSweepIntervalMilliseconds;
+    uint32_t RedzoneSweepBudgetMicroseconds;
+    size_t GuardPagesMinBytes;
+    size_t GuardPagesMaxBytes;
+    size_t QuarantineBytes;
+
+} mvm_debug_memory_config;
+
+
+//
+// NOTE(Marko): Live-allocation record. One of these exists for every 
+//              allocation that has not been freed yet, stored directly in the 
+//              address table below. Its history lives in the event log. 
+//
+
+// NOTE(Marko): The family of call that made a block. Releasing it with a 
+//              call from another family (new with free(), new[] with delete) 
+//              is undefined behaviour and is reported. 
+typedef enum allocation_kind
+{
+    AllocationKind_Malloc = 0,
+    AllocationKind_New,
+    AllocationKind_NewArray,
+
+} allocation_kind;
+
+
+// NOTE(Marko): The block sits between redzones; CurrentAddress is the 
+//              user's pointer, not the one the C library handed out. 
+#define DEBUG_INFO_FLAG_REDZONES 0x1
+// NOTE(Marko): Damage to the redzones has already been reported. 
+#define DEBUG_INFO_FLAG_REDZONE_REPORTED 0x2
+// NOTE(Marko): The block is on pages of its own, followed by a guard page, 
+//              and never came from the C library at all. 
+#define DEBUG_INFO_FLAG_GUARD_PAGE 0x4
+#define DEBUG_INFO_FLAG_PADDED \
+    (DEBUG_INFO_FLAG_REDZONES | DEBUG_INFO_FLAG_GUARD_PAGE)
+
+typedef struct mvm_debug_memory_info
+{
+    // NOTE(Marko): Key of the address table. 0 marks an empty slot and -1 a 
+    //              tombstone; neither can be returned by a successful 
+    //              malloc()/realloc(). 
+    void *CurrentAddress;
+    void *InitialAddress;
+    size_t ByteCount;
+
+    // NOTE(Marko): Most recent event of this allocation's chain. 
+    uint64_t LastEventIndex;
+
+    uint32_t InitialSiteID;
+    uint32_t DebugInfoOpCount;
+
+    // NOTE(Marko): Chance that this allocation was picked by the sampler; 1 
+    //              when every allocation is tracked. 
+    float SampleProbability;
+
+    // NOTE(Marko): Call stack of the initial allocation, or 
+    //              DEBUG_STACK_ID_NONE when stacks are not captured. 
+    uint32_t StackID;
+
+    // NOTE(Marko): log2 of the alignment the block was requested with 
+    //              (aligned_alloc(), posix_memalign(), aligned new), or 0 for 
+    //              the default. Cleared by a realloc(), which does not keep 
+    //              it. 
+    uint8_t AlignmentLog2;
+
+    // NOTE(Marko): allocation_kind, checked when the block is released. 
+    uint8_t AllocationKind;
+
+    // NOTE(Marko): DEBUG_INFO_FLAG_* bits. 
+    uint8_t Flags;
+
+    // NOTE(Marko): DEBUG_REALLOC_FLAG_* bits of the steps taken so far. 
+    uint8_t ReallocFlags;
+
+    // NOTE(Marko): Bytes the C library reserved beyond ByteCount, saturated 
+    //              at 2^32 - 1. 
+    uint32_t SlackBytes;
+
+    // NOTE(Marko): When, by which thread, and in which TurnOn/TurnOff scope 
+    //              the initial allocation was made; see the lifetime 
+    //              histogram. 
+    uint64_t AllocationTimestamp;
+    uint32_t AllocationThreadIndex;
+    uint32_t AllocationScopeIndex;
+
+} mvm_debug_memory_info;
+
+
+//
+// NOTE(Marko): Open-addressing hash index from the current address of a live 
+//              allocation to its record. Linear probing, power-of-two sized. 
+//              Freed addresses are tombstoned rather than emptied so that the 
+//              probe chains of other keys stay intact. 
+//
+//              The index is split into DEBUG_ADDRESS_TABLE_SHARD_COUNT 
+//              independently locked shards, picked by the top bits of the 
+//              address hash (the slot uses the bottom bits), so threads 
+//              freeing each other's blocks rarely meet on the same lock. 
+//
+
+#define DEBUG_ADDRESS_TABLE_INITIAL_SIZE 64
+#define DEBUG_ADDRESS_TABLE_SHARD_SHIFT 6
+#define DEBUG_ADDRESS_TABLE_SHARD_COUNT (1 << DEBUG_ADDRESS_TABLE_SHARD_SHIFT)
+#define DEBUG_ADDRESS_TABLE_EMPTY ((void *)0)
+#define DEBUG_ADDRESS_TABLE_TOMBSTONE ((void *)-1)
+
+typedef struct mvm_debug_memory_address_table
+{
+    mvm_debug_memory_lock Lock;
+
+    size_t SlotsUsed;
+    size_t TombstonesCount;
+    size_t SlotsAllocated;
+    mvm_debug_memory_info *Slots;
+
+    // NOTE(Marko): Keep neighbouring shards' locks off the same cache line. 
+    uint8_t Padding[24];
+
+} mvm_debug_memory_address_table;
+
+
+//
+// NOTE(Marko): Per-thread state, reached through thread-local storage. Holds 
+//              the thread's current block of the event log and a small 
+//              direct-mapped cache in front of the (locked) call-site table. 
+//
+
+#define DEBUG_SITE_CACHE_SIZE 256
+#define DEBUG_STACK_CACHE_SIZE 256
+
+typedef struct mvm_debug_memory_site_cache_entry
+{
+    const char *Filename;
+    int LineNumber;
+    uint32_t SiteID;
+
+} mvm_debug_memory_site_cache_entry;
+
+
+typedef struct mvm_debug_memory_stack_cache_entry
+{
+    uint64_t Hash;
+    uint32_t StackID;
+
+} mvm_debug_memory_stack_cache_entry;
+
+
+typedef struct mvm_debug_memory_thread_state
+{
+    struct mvm_debug_memory_thread_state *Next;
+    uint32_t ThreadIndex;
+
+    // NOTE(Marko): BlockEventsUsed == DEBUG_EVENT_BLOCK_SIZE means a new block 
+    //              must be reserved before the next event. 
+    uint32_t BlockEventsUsed;
+    // NOTE(Marko): Events of the current block already sent to the trace. 
+    uint32_t BlockEventsSubmitted;
+    uint64_t BlockFirstEventIndex;
+    mvm_debug_memory_event *BlockEvents;
+
+    // NOTE(Marko): Streaming mode only. The thread's own block storage; the 
+    //              shared log is not used. 
+    mvm_debug_memory_event *PrivateBlockEvents;
+
+    uint64_t EventsCount;
+
+    // NOTE(Marko): Sampling mode only. Counts down by every allocated byte; 
+    //              the allocation that takes it to zero or below is tracked. 
+    int64_t BytesUntilSample;
+    uint64_t SampleRandomState;
+
+    mvm_debug_memory_site_cache_entry SiteCache[DEBUG_SITE_CACHE_SIZE];
+
+    // NOTE(Marko): Stack capture only. StackHigh is 0 when the bounds of the 
+    //              thread's stack are unknown; frame pointers are then not 
+    //              followed. 
+    uintptr_t StackLow;
+    uintptr_t StackHigh;
+    mvm_debug_memory_stack_cache_entry StackCache[DEBUG_STACK_CACHE_SIZE];
+
+} mvm_debug_memory_thread_state;
+
+
+//
+// NOTE(Marko): Binary trace format. A trace is one 
+//              mvm_debug_memory_trace_header followed by chunks, each an 
+//              mvm_debug_memory_trace_chunk_header and PayloadSize bytes: 
+//
+//              - TraceChunkType_SiteTable: ItemsCount records, each an 
+//                mvm_debug_memory_trace_site followed by FilenameLength bytes 
+//                of filename (no terminator), padded to a multiple of 8. 
+//              - TraceChunkType_EventBlock: ItemsCount mvm_debug_memory_event 
+//                records with consecutive indices from FirstEventIndex. 
+//
+//              Any sites known when the trace was opened are in the first 
+//              chunks, and a site always appears before the first event 
+//              that refers to it. Event chunks are only in time 
+//              order per thread; the reader merges them like the in-memory 
+//              report does. Everything is in host byte order. 
+//
+
+#define DEBUG_TRACE_MAGIC 0x45434152544D564DULL
+#define DEBUG_TRACE_VERSION 1
+
+typedef enum trace_chunk_type
+{
+    TraceChunkType_SiteTable = 1,
+    TraceChunkType_EventBlock = 2,
+
+} trace_chunk_type;
+
+
+typedef struct mvm_debug_memory_trace_header
+{
+    // NOTE(Marko): "MVMTRACE" read as a little-endian uint64_t. 
+    uint64_t Magic;
+    uint32_t Version;
+    uint32_t HeaderSize;
+    uint32_t EventSize;
+    uint32_t SiteIDBits;
+
+    // NOTE(Marko): Clock calibration. Event timestamps advance 
+    //              TimestampFrequency ticks per second, and read 
+    //              CalibrationTimestamp when the monotonic clock read 
+    //              CalibrationNanoseconds. 
+    uint64_t TimestampFrequency;
+    uint64_t CalibrationTimestamp;
+    uint64_t CalibrationNanoseconds;
+
+    // NOTE(Marko): 0 unless the trace was recorded in sampling mode. 
+    uint64_t SampleIntervalBytes;
+
+} mvm_debug_memory_trace_header;
+
+
+typedef struct mvm_debug_memory_trace_chunk_header
+{
+    uint32_t Type;
+    uint32_t ItemsCount;
+    uint64_t FirstEventIndex;
+    uint64_t PayloadSize;
+
+} mvm_debug_memory_trace_chunk_header;
+
+
+typedef struct mvm_debug_memory_trace_site
+{
+    uint32_t SiteID;
+    int32_t LineNumber;
+    uint32_t FilenameLength;
+    uint32_t Padding;
+
+} mvm_debug_memory_trace_site;
+
+
+//
+// NOTE(Marko): Trace writer. Recording threads copy finished event blocks 
+//              into the active one of two large buffers; a background thread 
+//              writes out whichever buffer is full with one sequential write 
+//              and also flushes the active one every 
+//              DEBUG_TRACE_FLUSH_INTERVAL_MS, so a crash loses at most that 
+//              much plus the unfinished blocks. A recording thread only ever 
+//              waits if both buffers are full at once. 
+//
+
+#define DEBUG_TRACE_BUFFER_SIZE (4*1024*1024)
+#define DEBUG_TRACE_FLUSH_INTERVAL_MS 50
+#define DEBUG_TRACE_BUFFER_EMPTY 0
+#define DEBUG_TRACE_BUFFER_FULL 1
+
+typedef struct mvm_debug_memory_trace_buffer
+{
+    volatile uint32_t State;
+    size_t BytesUsed;
+    uint8_t *Bytes;
+
+} mvm_debug_memory_trace_buffer;
+
+
+typedef struct mvm_debug_memory_trace_writer
+{
+    // NOTE(Marko): Guards ActiveBufferIndex, the active buffer and 
+    //              SitesWritten. Never held across a write to the file. 
+    mvm_debug_memory_lock Lock;
+    uint32_t ActiveBufferIndex;
+    uint32_t SitesWritten;
+    mvm_debug_memory_trace_buffer Buffers[2];
+
+    mvm_debug_memory_file File;
+    mvm_debug_memory_thread Thread;
+    volatile uint32_t StopRequested;
+    volatile uint32_t WriteFailed;
+
+} mvm_debug_memory_trace_writer;
+
+
+//
+// NOTE(Marko): Redzones. A padded block is laid out as 
+//              [front redzone][MemorySize bytes][RedzoneBytes back redzone], 
+//              both redzones filled with DEBUG_REDZONE_CANARY. 
+//
+
+#define DEBUG_REDZONE_ALIGNMENT 16
+#define DEBUG_REDZONE_CANARY 0xFD
+#define DEBUG_REDZONE_SWEEP_BUDGET_US 200
+// NOTE(Marko): Slots checked per hold of a shard lock, so the sweep never 
+//              stalls allocations in that shard for long. 
+#define DEBUG_REDZONE_SWEEP_BATCH 256
+
+//
+// NOTE(Marko): Guard pages. A guarded block is laid out as 
+//              [canaries][MemorySize bytes][slack][guard page]. It is the 
+//              block rounded up to DEBUG_GUARD_PAGE_ALIGNMENT (or its own 
+//              alignment) that ends at the guard page; the slack, e.g. 8 
+//              bytes for a 5000-byte block, is filled with canaries, so an 
+//              overrun into it does not fault; it is only caught when the 
+//              canaries are checked like redzones, at free at the latest. 
+//
+
+#define DEBUG_GUARD_PAGE_ALIGNMENT 16
+
+//
+// NOTE(Marko): Quarantine. Freed blocks are held back from the C library in 
+//              a FIFO, filled with DEBUG_QUARANTINE_POISON, until the bytes 
+//              held go over the cap; the oldest are then checked for writes 
+//              and really freed. An index by address catches double frees 
+//              of blocks still in there. 
+//
+
+#define DEBUG_QUARANTINE_POISON 0xDD
+#define DEBUG_QUARANTINE_INITIAL_SIZE 256
+// NOTE(Marko): Blocks taken out per hold of the lock. They are checked and 
+//              freed after letting go of it. 
+#define DEBUG_QUARANTINE_EVICT_BATCH 16
+
+typedef struct mvm_debug_memory_quarantine_entry
+{
+    // NOTE(Marko): The block's record as it was when it was freed. 
+    mvm_debug_memory_info DebugInfo;
+    uint32_t FreeSiteID;
+
+} mvm_debug_memory_quarantine_entry;
+
+
+typedef struct mvm_debug_memory_quarantine_slot
+{
+    // NOTE(Marko): 0 marks an empty slot. 
+    void *Address;
+    size_t EntryIndex;
+
+} mvm_debug_memory_quarantine_slot;
+
+
+typedef struct mvm_debug_memory_quarantine
+{
+    // NOTE(Marko): Guards everything below. 
+    mvm_debug_memory_lock Lock;
+    size_t MaxBytes;
+    size_t Bytes;
+
+    // NOTE(Marko): Ring of entries, oldest at FirstEntryIndex. 
+    size_t EntriesCount;
+    size_t EntriesAllocated;
+    size_t FirstEntryIndex;
+    mvm_debug_memory_quarantine_entry *Entries;
+
+    // NOTE(Marko): Address -> index into Entries. Linear probing, kept at 
+    //              most half full, emptied by shifting back the rest of the 
+    //              probe chain so no tombstones are needed. 
+    size_t SlotsAllocated;
+    mvm_debug_memory_quarantine_slot *Slots;
+
+} mvm_debug_memory_quarantine;
+
+typedef struct mvm_debug_memory_redzone_sweeper
+{
+    struct mvm_debug_memory_list *List;
+    mvm_debug_memory_thread Thread;
+    volatile uint32_t StopRequested;
+    uint32_t IntervalMilliseconds;
+    uint64_t BudgetNanoseconds;
+
+    // NOTE(Marko): Where the next sweep picks up. Only the sweeper's thread 
+    //              touches these. 
+    uint32_t ShardIndex;
+    size_t SlotIndex;
+
+} mvm_debug_memory_redzone_sweeper;
+
+
+typedef enum site_stat_metric
+{
+    SiteStatMetric_AllocationsCount,
+    SiteStatMetric_ReallocationsCount,
+    SiteStatMetric_FreesCount,
+    SiteStatMetric_TotalBytes,
+    SiteStatMetric_LiveBytes,
+    SiteStatMetric_PeakLiveBytes,
+
+} site_stat_metric;
+
+
+// NOTE(Marko): A snapshot of one site's running totals. 
+typedef struct mvm_debug_memory_site_report
+{
+    const char *Filename;
+    int LineNumber;
+    uint32_t SiteID;
+
+    uint64_t AllocationsCount;
+    uint64_t ReallocationsCount;
+    uint64_t FreesCount;
+    uint64_t TotalBytes;
+    uint64_t LiveBytes;
+    uint64_t PeakLiveBytes;
+    uint64_t TotalUsableBytes;
+
+} mvm_debug_memory_site_report;
+
+
+//
+// NOTE(Marko): High-water mark. The list keeps a running total of live 
+//              bytes and its peak. Whenever the total climbs well past the 
+//              last snapshot (by 1/2^DEBUG_PEAK_SNAPSHOT_GROWTH_SHIFT, and at 
+//              least DEBUG_PEAK_SNAPSHOT_MIN_GROWTH bytes) the top live sites 
+//              are captured, so the last snapshot describes the peak to 
+//              within that margin without walking the sites on every 
+//              allocation. MVMDebugMemoryPrintHighWaterMark() prints the 
+//              snapshot's own total next to the true peak. 
+//
+
+#define DEBUG_PEAK_SNAPSHOT_SITES_COUNT 8
+#define DEBUG_PEAK_SNAPSHOT_GROWTH_SHIFT 4
+#define DEBUG_PEAK_SNAPSHOT_MIN_GROWTH (64*1024)
+
+typedef struct mvm_debug_memory_peak_snapshot
+{
+    uint64_t LiveBytes;
+    uint64_t Timestamp;
+    size_t SitesCount;
+    mvm_debug_memory_site_report Sites[DEBUG_PEAK_SNAPSHOT_SITES_COUNT];
+
+} mvm_debug_memory_peak_snapshot;
+
+
+//
+// NOTE(Marko): Live-bytes timeline. A fixed number of samples, each the 
+//              highest live-byte total seen during its interval, plus one 
+//              so that 0 means "nothing happened". When the run outgrows 
+//              the buffer, neighbouring samples are merged and the interval 
+//              doubles, so the buffer always covers the whole run. 
+//
+
+#define DEBUG_TIMELINE_SAMPLES_COUNT 1024
+
+typedef struct mvm_debug_memory_timeline
+{
+    // NOTE(Marko): Only taken to merge samples. 
+    mvm_debug_memory_lock Lock;
+    uint64_t StartTimestamp;
+    uint64_t TimestampFrequency;
+    volatile uint64_t IntervalTicks;
+    volatile uint64_t LastSampleIndex;
+    volatile uint64_t Samples[DEBUG_TIMELINE_SAMPLES_COUNT];
+
+} mvm_debug_memory_timeline;
+
+
+//
+// NOTE(Marko): Heap snapshots. MVMDebugMemorySnapshot() copies the live set 
+//              out of the address table as one compact entry per block, 
+//              sorted by address, so that two snapshots can be compared in 
+//              a single linear merge. A block whose address is in both is 
+//              taken to be the same block if it comes from the same site. 
+//              Snapshots live in the debug arena, so they go away at 
+//              MVMDebugMemoryShutdown(). 
+//
+
+typedef struct mvm_debug_memory_snapshot_entry
+{
+    void *Address;
+    size_t ByteCount;
+    uint32_t SiteID;
+
+    // NOTE(Marko): As in mvm_debug_memory_info. 
+    float SampleProbability;
+
+} mvm_debug_memory_snapshot_entry;
+
+
+typedef struct mvm_debug_memory_snapshot
+{
+    mvm_debug_memory_snapshot_entry *Entries;
+    size_t EntriesCount;
+    size_t EntriesAllocated;
+
+    uint64_t Nanoseconds;
+
+} mvm_debug_memory_snapshot;
+
+
+// NOTE(Marko): What changed at one site between two snapshots. With 
+//              sampling on, these are estimates. 
+typedef struct mvm_debug_memory_site_diff
+{
+    const char *Filename;
+    int LineNumber;
+    uint32_t SiteID;
+
+    uint64_t AddedCount;
+    uint64_t AddedBytes;
+    uint64_t FreedCount;
+    uint64_t FreedBytes;
+    uint64_t GrownCount;
+    uint64_t GrownBytes;
+    uint64_t ShrunkCount;
+    uint64_t ShrunkBytes;
+
+    // NOTE(Marko): AddedBytes - FreedBytes + GrownBytes - ShrunkBytes. 
+    int64_t NetBytes;
+
+} mvm_debug_memory_site_diff;
+
+
+typedef struct mvm_debug_memory_list
+{
+    // NOTE(Marko): Guards TurnOnCount changes, the thread list and event 
+    //              chunk allocation. Never taken per event. 
+    mvm_debug_memory_lock Lock;
+
+    // NOTE(Marko): Written under Lock, read without it on every operation. 
+    volatile size_t TurnOnCount;
+
+    // NOTE(Marko): Bumped by every MVMTurnOnDebugInfo() and 
+    //              MVMTurnOffDebugInfo(), so that two operations with the 
+    //              same value happened in the same scope. 
+    volatile uint32_t ScopeIndex;
+
+    // NOTE(Marko): Event indices handed out so far, always a whole number of 
+    //              blocks. Slots past a thread's cursor are still zero. 
+    volatile uint64_t EventsReserved;
+
+    // NOTE(Marko): 0 for an unbounded log. Otherwise the number of event 
+    //              slots in the ring, a multiple of DEBUG_EVENT_BLOCK_SIZE; 
+    //              event index I lives in slot I % EventRingCapacity and every 
+    //              chunk is allocated up front. 
+    uint64_t EventRingCapacity;
+
+    // NOTE(Marko): One word per ring block: the first event index of the 
+    //              block that currently owns it, with 
+    //              DEBUG_EVENT_RING_BLOCK_BUSY set while its thread is 
+    //              writing an event. A thread that laps the block waits for 
+    //              the writer to finish; the writer then sees it no longer 
+    //              owns the block and moves on to a new one. 
+    volatile uint64_t *RingBlockOwners;
+
+    // NOTE(Marko): 0 when every allocation is tracked. 
+    size_t SampleIntervalBytes;
+
+    // NOTE(Marko): Whether a realloc()/free() of a pointer that is not in the 
+    //              live table is an error worth printing. Not when sampling, 
+    //              since most blocks are then untracked on purpose. 
+    int ReportUntrackedPointers;
+
+    // NOTE(Marko): 0 unless streaming to a trace file. 
+    mvm_debug_memory_trace_writer *TraceWriter;
+
+    // NOTE(Marko): Every operation updates these, so keep them on a cache 
+    //              line of their own, away from TurnOnCount and 
+    //              EventsReserved. 
+    uint8_t LiveBytesPaddingBefore[64];
+
+    // NOTE(Marko): Sum of ByteCount over the live records. 
+    volatile uint64_t LiveBytes;
+    volatile uint64_t PeakLiveBytes;
+    volatile uint64_t NextPeakSnapshotBytes;
+
+    uint8_t LiveBytesPaddingAfter[64];
+
+    mvm_debug_memory_lock PeakSnapshotLock;
+    mvm_debug_memory_peak_snapshot PeakSnapshot;
+
+    // NOTE(Marko): When the list was created, for turning timestamps into 
+    //              seconds. 
+    uint64_t CreationTimestamp;
+    uint64_t CreationNanoseconds;
+
+    // NOTE(Marko): 0 unless mvm_debug_memory_config.TimelineResolutionMicroseconds 
+    //              was set. 
+    mvm_debug_memory_timeline *Timeline;
+
+    // NOTE(Marko): Formatting buffer for MVMDebugMemoryWriteReport(), 
+    //              allocated on first use and kept for later reports. 
+    char *ReportBuffer;
+
+    volatile size_t EventChunksCount;
+    mvm_debug_memory_event **EventChunkPages[DEBUG_EVENT_DIRECTORY_PAGES_COUNT];
+
+    uint32_t ThreadsCount;
+    mvm_debug_memory_thread_state *Threads;
+
+    // NOTE(Marko): Only holds addresses that are currently live, so lookups 
+    //              never have to look at the history. 
+    mvm_debug_memory_address_table AddressTables[DEBUG_ADDRESS_TABLE_SHARD_COUNT];
+
+    mvm_debug_memory_site_table SiteTable;
+
+    // NOTE(Marko): 0 unless mvm_debug_memory_config.StackDepth was set. 
+    uint32_t StackDepth;
+    int StackUseUnwinder;
+    mvm_debug_memory_stack_table StackTable;
+
+    // NOTE(Marko): 0 unless mvm_debug_memory_config.RedzoneBytes was set; a 
+    //              multiple of DEBUG_REDZONE_ALIGNMENT. 
+    size_t RedzoneBytes;
+    volatile uint64_t RedzoneErrorsCount;
+    mvm_debug_memory_redzone_sweeper *RedzoneSweeper;
+
+    // NOTE(Marko): Guard pages are in use if GuardPagesMaxBytes or 
+    //              GuardedSitesCount is non-zero. 
+    size_t PageSize;
+    size_t GuardPagesMinBytes;
+    size_t GuardPagesMaxBytes;
+    volatile uint64_t GuardedSitesCount;
+
+    // NOTE(Marko): 0 unless mvm_debug_memory_config.QuarantineBytes was set. 
+    mvm_debug_memory_quarantine *Quarantine;
+    volatile uint64_t UseAfterFreeErrorsCount;
+    
+} mvm_debug_memory_list;
+
+
+// NOTE(Marko): Global Variable to hold the debug info. 
+mvm_debug_memory_list *GlobalDebugInfoList = 0;
+
+mvm_debug_memory_config GlobalDebugConfig = {0};
+
+// NOTE(Marko): Serializes the first MVMTurnOnDebugInfo() against itself. 
+mvm_debug_memory_lock GlobalDebugInfoListInitLock = {0};
+
+// NOTE(Marko): Bumped by MVMDebugMemoryShutdown(). A thread whose cached 
+//              state is from an older generation must not touch it: the 
+//              memory behind it has been unmapped. 
+volatile uint32_t GlobalDebugGeneration = 1;
+
+typedef struct mvm_debug_memory_thread_local
+{
+    uint32_t Generation;
+    mvm_debug_memory_thread_state *State;
+
+} mvm_debug_memory_thread_local;
+
+MVM_DEBUG_THREAD_LOCAL mvm_debug_memory_thread_local ThreadLocalDebugState;
+
+
+mvm_debug_memory_site *MVMGetCallSite(uint32_t SiteID)
+{
+    mvm_debug_memory_site *Result = 0;
+    if(GlobalDebugInfoList && 
+       (SiteID < GlobalDebugInfoList->SiteTable.SitesCount))
+    {
+        Result = MVMGetSite(&GlobalDebugInfoList->SiteTable, SiteID);
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Draws the distance to the next sample point, exponentially 
+//              distributed with mean SampleIntervalBytes. 
+int64_t MVMDrawSampleInterval(mvm_debug_memory_thread_state *ThreadState)
+{
+    uint64_t Random = ThreadState->SampleRandomState;
+    Random ^= Random << 13;
+    Random ^= Random >> 7;
+    Random ^= Random << 17;
+    ThreadState->SampleRandomState = Random;
+
+    // NOTE(Marko): Top 53 bits as a uniform double in (0, 1]. 
+    double Uniform = ((double)(Random >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+    double Interval = 
+        -log(Uniform) * (double)GlobalDebugInfoList->SampleIntervalBytes;
+    return((int64_t)Interval + 1);
+}
+
+
+mvm_debug_memory_thread_state *MVMGetThreadState(void)
+{
+    mvm_debug_memory_thread_state *Result = 0;
+    if(ThreadLocalDebugState.State && 
+       (ThreadLocalDebugState.Generation == GlobalDebugGeneration))
+    {
+        Result = ThreadLocalDebugState.State;
+    }
+    else if(GlobalDebugInfoList)
+    {
+        Result = (mvm_debug_memory_thread_state *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            sizeof *Result);
+        if(Result)
+        {
+            Result->BlockEventsUsed = DEBUG_EVENT_BLOCK_SIZE;
+            Result->SampleRandomState = 
+                (MVMReadTimestamp() ^ (uint64_t)(uintptr_t)Result) | 1;
+            if(GlobalDebugInfoList->SampleIntervalBytes)
+            {
+                Result->BytesUntilSample = MVMDrawSampleInterval(Result);
+            }
+            if(GlobalDebugInfoList->StackDepth && 
+               !MVMPlatformGetStackBounds(&Result->StackLow, &Result->StackHigh))
+            {
+                Result->StackLow = 0;
+                Result->StackHigh = 0;
+            }
+
+            MVMLockAcquire(&GlobalDebugInfoList->Lock);
+            Result->ThreadIndex = GlobalDebugInfoList->ThreadsCount++;
+            Result->Next = GlobalDebugInfoList->Threads;
+            GlobalDebugInfoList->Threads = Result;
+            MVMLockRelease(&GlobalDebugInfoList->Lock);
+
+            ThreadLocalDebugState.State = Result;
+            ThreadLocalDebugState.Generation = GlobalDebugGeneration;
+        }
+        else
+        {
+            printf("Debug arena allocation failed while allocating per-thread debug state.\n");
+        }
+    }
+    return(Result);
+}
+
+
+uint32_t MVMLookupCallSite(mvm_debug_memory_thread_state *ThreadState, 
+                           const char *Filename, 
+                           int LineNumber)
+{
+    uint32_t Result = DEBUG_SITE_ID_NONE;
+    mvm_debug_memory_site_cache_entry *Entry = 
+        ThreadState->SiteCache + 
+        (MVMHashCallSitePointer(Filename, LineNumber) & 
+         (DEBUG_SITE_CACHE_SIZE - 1));
+    if((Entry->Filename == Filename) && (Entry->LineNumber == LineNumber))
+    {
+        Result = Entry->SiteID;
+    }
+    else
+    {
+        Result = MVMInternCallSite(&GlobalDebugInfoList->SiteTable, 
+                                   Filename, 
+                                   LineNumber);
+        Entry->Filename = Filename;
+        Entry->LineNumber = LineNumber;
+        Entry->SiteID = Result;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): ToolFrames is the number of the tool's own frames between 
+//              the user's code and this function, which are left off the 
+//              stack. Everything on that path is kept out of line so the 
+//              count holds. 
+MVM_DEBUG_NOINLINE 
+uint32_t MVMCaptureStackID(mvm_debug_memory_thread_state *ThreadState, 
+                           uint32_t ToolFrames)
+{
+    void *Frames[DEBUG_STACK_MAX_DEPTH];
+    uint32_t FramesCount = 0;
+    uint32_t MaxFramesCount = GlobalDebugInfoList->StackDepth;
+    int UseUnwinder = GlobalDebugInfoList->StackUseUnwinder;
+
+#if MVM_DEBUG_FRAME_POINTER_WALK
+    if(!UseUnwinder && ThreadState->StackHigh)
+    {
+        // NOTE(Marko): Each frame record is {caller's frame record, return 
+        //              address}, and callers' records sit higher on the 
+        //              stack. The first ToolFrames return addresses go back 
+        //              into the tool and are skipped. 
+        uintptr_t *Frame = (uintptr_t *)__builtin_frame_address(0);
+        uint32_t SkipFrames = ToolFrames;
+        int ChainBroken = 0;
+        while(FramesCount < MaxFramesCount)
+        {
+            uintptr_t NextFrame = Frame[0];
+            uintptr_t ReturnAddress = Frame[1];
+            if(!ReturnAddress)
+            {
+                break;
+            }
+            if((ReturnAddress < DEBUG_STACK_MIN_CODE_ADDRESS) || 
+               ((ReturnAddress >= ThreadState->StackLow) && 
+                (ReturnAddress < ThreadState->StackHigh)))
+            {
+                // NOTE(Marko): Not code; this record was not a real frame. 
+                ChainBroken = 1;
+                break;
+            }
+            if(SkipFrames)
+            {
+                SkipFrames--;
+            }
+            else
+            {
+                Frames[FramesCount++] = (void *)ReturnAddress;
+            }
+            if(!NextFrame)
+            {
+                break;
+            }
+            if((NextFrame <= (uintptr_t)Frame) || 
+               (NextFrame & (sizeof(uintptr_t) - 1)) || 
+               (NextFrame + 2*sizeof(uintptr_t) > ThreadState->StackHigh))
+            {
+                ChainBroken = 1;
+                break;
+            }
+            Frame = (uintptr_t *)NextFrame;
+        }
+        UseUnwinder = ChainBroken && 
+            (FramesCount < DEBUG_STACK_MIN_FRAME_POINTER_FRAMES);
+    }
+    else
+    {
+        UseUnwinder = 1;
+    }
+#else
+    UseUnwinder = 1;
+#endif
+
+    if(UseUnwinder)
+    {
+        // NOTE(Marko): Skip this function as well. 
+        FramesCount = MVMPlatformUnwindStack(Frames, MaxFramesCount, 
+                                             ToolFrames + 1);
+    }
+    if(!FramesCount)
+    {
+        return(DEBUG_STACK_ID_NONE);
+    }
+
+    uint32_t Result = DEBUG_STACK_ID_NONE;
+    uint64_t Hash = MVMHashStack(Frames, FramesCount);
+    mvm_debug_memory_stack_cache_entry *Entry = 
+        ThreadState->StackCache + (Hash & (DEBUG_STACK_CACHE_SIZE - 1));
+    mvm_debug_memory_stack *CachedStack = 
+        (Entry->Hash == Hash) ? 
+        MVMGetStack(&GlobalDebugInfoList->StackTable, Entry->StackID) : 0;
+    if(CachedStack && MVMStackMatches(CachedStack, Hash, Frames, FramesCount))
+    {
+        Result = Entry->StackID;
+    }
+    else
+    {
+        Result = MVMInternStack(&GlobalDebugInfoList->StackTable, 
+                                Hash, Frames, FramesCount);
+        Entry->Hash = Hash;
+        Entry->StackID = Result;
+    }
+    return(Result);
+}
+
+
+memory_operation_type MVMGetEventType(mvm_debug_memory_event *Event)
+{
+    return (memory_operation_type)(Event->SiteAndType >> 
+                                   DEBUG_EVENT_SITE_ID_BITS);
+}
+
+
+uint32_t MVMGetEventSiteID(mvm_debug_memory_event *Event)
+{
+    return Event->SiteAndType & DEBUG_EVENT_SITE_ID_MASK;
+}
+
+
+mvm_debug_memory_event *MVMGetEventChunk(mvm_debug_memory_list *List, 
+                                         size_t ChunkIndex)
+{
+    mvm_debug_memory_event *Result = 0;
+    if(ChunkIndex < DEBUG_EVENT_MAX_CHUNKS)
+    {
+        mvm_debug_memory_event **Page = 
+            List->EventChunkPages[ChunkIndex >> DEBUG_EVENT_DIRECTORY_PAGE_SHIFT];
+        if(Page)
+        {
+            Result = Page[ChunkIndex & DEBUG_EVENT_DIRECTORY_PAGE_MASK];
+        }
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Appends Chunk to the directory. Called with List->Lock held, 
+//              or before the list is published. Returns 0 when the directory 
+//              is full or a page cannot be allocated. 
+int MVMAddEventChunk(mvm_debug_memory_list *List, mvm_debug_memory_event *Chunk)
+{
+    size_t ChunkIndex = List->EventChunksCount;
+    if(ChunkIndex >= DEBUG_EVENT_MAX_CHUNKS)
+    {
+        printf("The event log is full; later events will not be recorded.\n");
+        return(0);
+    }
+    mvm_debug_memory_event ***Page = 
+        List->EventChunkPages + (ChunkIndex >> DEBUG_EVENT_DIRECTORY_PAGE_SHIFT);
+    if(!*Page)
+    {
+        *Page = (mvm_debug_memory_event **)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof **Page) * DEBUG_EVENT_DIRECTORY_PAGE_SIZE);
+        if(!*Page)
+        {
+            printf("Debug arena allocation failed while growing the event chunk directory.\n");
+            return(0);
+        }
+    }
+    (*Page)[ChunkIndex & DEBUG_EVENT_DIRECTORY_PAGE_MASK] = Chunk;
+    List->EventChunksCount = ChunkIndex + 1;
+    return(1);
+}
+
+
+// NOTE(Marko): Returns 0 for an index that was never reserved, or whose 
+//              slot has since been overwritten in ring mode. 
+mvm_debug_memory_event *MVMGetEvent(uint64_t EventIndex)
+{
+    mvm_debug_memory_event *Result = 0;
+    if(GlobalDebugInfoList && 
+       (EventIndex < GlobalDebugInfoList->EventsReserved))
+    {
+        uint64_t EventRingCapacity = GlobalDebugInfoList->EventRingCapacity;
+        uint64_t SlotIndex = EventIndex;
+        if(EventRingCapacity)
+        {
+            if(EventIndex + EventRingCapacity < 
+               GlobalDebugInfoList->EventsReserved)
+            {
+                return(Result);
+            }
+            SlotIndex = EventIndex % EventRingCapacity;
+        }
+        mvm_debug_memory_event *Chunk = 
+            MVMGetEventChunk(GlobalDebugInfoList, 
+                             (size_t)(SlotIndex >> DEBUG_EVENT_CHUNK_SHIFT));
+        if(Chunk)
+        {
+            Result = Chunk + (SlotIndex & DEBUG_EVENT_CHUNK_MASK);
+        }
+    }
+    return(Result);
+}
+
+
+uint64_t MVMGetPreviousEventIndex(uint64_t EventIndex, 
+                                  mvm_debug_memory_event *Event)
+{
+    uint64_t Result = DEBUG_EVENT_INDEX_NONE;
+    if(Event->PreviousEventOffset)
+    {
+        Result = EventIndex - (uint64_t)(int64_t)Event->PreviousEventOffset;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Marks the active buffer full and switches to the other one. 
+//              With Wait set, first waits for the writer thread to finish 
+//              with the other buffer; otherwise gives up if it is busy. 
+//              Caller holds Writer->Lock. 
+int MVMTraceSwapBuffers(mvm_debug_memory_trace_writer *Writer, int Wait)
+{
+    mvm_debug_memory_trace_buffer *Active = 
+        Writer->Buffers + Writer->ActiveBufferIndex;
+    mvm_debug_memory_trace_buffer *Other = 
+        Writer->Buffers + (Writer->ActiveBufferIndex ^ 1);
+    if(!Active->BytesUsed)
+    {
+        return(1);
+    }
+    while(MVMAtomicLoadU32(&Other->State) != DEBUG_TRACE_BUFFER_EMPTY)
+    {
+        if(!Wait)
+        {
+            return(0);
+        }
+        MVMPlatformYield();
+    }
+    MVMAtomicStoreU32(&Active->State, DEBUG_TRACE_BUFFER_FULL);
+    Writer->ActiveBufferIndex ^= 1;
+    return(1);
+}
+
+
+// NOTE(Marko): Returns room for Size bytes in the active buffer. Caller holds 
+//              Writer->Lock. 
+uint8_t *MVMTraceReserve(mvm_debug_memory_trace_writer *Writer, size_t Size)
+{
+    uint8_t *Result = 0;
+    if(Size <= DEBUG_TRACE_BUFFER_SIZE)
+    {
+        mvm_debug_memory_trace_buffer *Active = 
+            Writer->Buffers + Writer->ActiveBufferIndex;
+        if(Active->BytesUsed + Size > DEBUG_TRACE_BUFFER_SIZE)
+        {
+            MVMTraceSwapBuffers(Writer, 1);
+            Active = Writer->Buffers + Writer->ActiveBufferIndex;
+        }
+        Result = Active->Bytes + Active->BytesUsed;
+        Active->BytesUsed += Size;
+    }
+    return(Result);
+}
+
+
+size_t MVMTraceSiteRecordSize(size_t FilenameLength)
+{
+    return(sizeof(mvm_debug_memory_trace_site) + ((FilenameLength + 7) & ~(size_t)7));
+}
+
+
+// NOTE(Marko): Writes every site interned since the last call as SiteTable 
+//              chunks. Caller holds Writer->Lock. 
+void MVMTraceWriteNewSites(mvm_debug_memory_trace_writer *Writer, 
+                           mvm_debug_memory_site_table *SiteTable)
+{
+    MVMLockAcquire(&SiteTable->Lock);
+    while(Writer->SitesWritten < SiteTable->SitesCount)
+    {
+        // NOTE(Marko): Batch as many sites as fit in half a buffer. 
+        uint32_t SitesCount = 0;
+        size_t PayloadSize = 0;
+        for(uint32_t SiteID = Writer->SitesWritten; 
+            SiteID < SiteTable->SitesCount; 
+            SiteID++)
+        {
+            mvm_debug_memory_site *Site = MVMGetSite(SiteTable, SiteID);
+            size_t RecordSize = MVMTraceSiteRecordSize(strlen(Site->Filename));
+            if(SitesCount && 
+               (PayloadSize + RecordSize > DEBUG_TRACE_BUFFER_SIZE / 2))
+            {
+                break;
+            }
+            PayloadSize += RecordSize;
+            SitesCount++;
+        }
+
+        mvm_debug_memory_trace_chunk_header ChunkHeader = {0};
+        ChunkHeader.Type = TraceChunkType_SiteTable;
+        ChunkHeader.ItemsCount = SitesCount;
+        ChunkHeader.PayloadSize = PayloadSize;
+        uint8_t *Destination = 
+            MVMTraceReserve(Writer, (sizeof ChunkHeader) + PayloadSize);
+        if(!Destination)
+        {
+            printf("A debug memory call-site filename is too long to be written to the trace.\n");
+            Writer->SitesWritten = SiteTable->SitesCount;
+            break;
+        }
+        memcpy(Destination, &ChunkHeader, sizeof ChunkHeader);
+        Destination += sizeof ChunkHeader;
+
+        for(uint32_t SiteIndex = 0; SiteIndex < SitesCount; SiteIndex++)
+        {
+            uint32_t SiteID = Writer->SitesWritten + SiteIndex;
+            mvm_debug_memory_site *Site = MVMGetSite(SiteTable, SiteID);
+            mvm_debug_memory_trace_site TraceSite = {0};
+            TraceSite.SiteID = SiteID;
+            TraceSite.LineNumber = Site->LineNumber;
+            TraceSite.FilenameLength = (uint32_t)strlen(Site->Filename);
+            memcpy(Destination, &TraceSite, sizeof TraceSite);
+            memcpy(Destination + sizeof TraceSite, 
+                   Site->Filename, 
+                   TraceSite.FilenameLength);
+            // NOTE(Marko): Arena memory is zeroed, but a recycled buffer is 
+            //              not. 
+            size_t RecordSize = MVMTraceSiteRecordSize(TraceSite.FilenameLength);
+            memset(Destination + sizeof TraceSite + TraceSite.FilenameLength, 
+                   0, 
+                   RecordSize - (sizeof TraceSite) - TraceSite.FilenameLength);
+            Destination += RecordSize;
+        }
+        Writer->SitesWritten += SitesCount;
+    }
+    MVMLockRelease(&SiteTable->Lock);
+}
+
+
+// NOTE(Marko): Sends the events this thread recorded since its last 
+//              submission to the trace. 
+void MVMTraceSubmitThreadEvents(mvm_debug_memory_trace_writer *Writer, 
+                                mvm_debug_memory_thread_state *ThreadState)
+{
+    uint32_t EventsCount = 
+        ThreadState->BlockEventsUsed - ThreadState->BlockEventsSubmitted;
+    if(!ThreadState->BlockEvents || !EventsCount)
+    {
+        return;
+    }
+
+    mvm_debug_memory_trace_chunk_header ChunkHeader = {0};
+    ChunkHeader.Type = TraceChunkType_EventBlock;
+    ChunkHeader.ItemsCount = EventsCount;
+    ChunkHeader.FirstEventIndex = 
+        ThreadState->BlockFirstEventIndex + ThreadState->BlockEventsSubmitted;
+    ChunkHeader.PayloadSize = 
+        (uint64_t)EventsCount * sizeof(mvm_debug_memory_event);
+
+    MVMLockAcquire(&Writer->Lock);
+    MVMTraceWriteNewSites(Writer, &GlobalDebugInfoList->SiteTable);
+    uint8_t *Destination = 
+        MVMTraceReserve(Writer, (sizeof ChunkHeader) + ChunkHeader.PayloadSize);
+    memcpy(Destination, &ChunkHeader, sizeof ChunkHeader);
+    memcpy(Destination + sizeof ChunkHeader, 
+           ThreadState->BlockEvents + ThreadState->BlockEventsSubmitted, 
+           (size_t)ChunkHeader.PayloadSize);
+    MVMLockRelease(&Writer->Lock);
+
+    ThreadState->BlockEventsSubmitted = ThreadState->BlockEventsUsed;
+}
+
+
+void MVMTraceWriterThreadProc(void *Parameter)
+{
+    mvm_debug_memory_trace_writer *Writer = 
+        (mvm_debug_memory_trace_writer *)Parameter;
+    uint32_t IdleMilliseconds = 0;
+    for(;;)
+    {
+        int WroteBuffer = 0;
+        for(int BufferIndex = 0; BufferIndex < 2; BufferIndex++)
+        {
+            mvm_debug_memory_trace_buffer *Buffer = Writer->Buffers + BufferIndex;
+            if(MVMAtomicLoadU32(&Buffer->State) == DEBUG_TRACE_BUFFER_FULL)
+            {
+                if(!Writer->WriteFailed && 
+                   !MVMPlatformWriteFile(&Writer->File, 
+                                         Buffer->Bytes, 
+                                         Buffer->BytesUsed))
+                {
+                    Writer->WriteFailed = 1;
+                }
+                Buffer->BytesUsed = 0;
+                MVMAtomicStoreU32(&Buffer->State, DEBUG_TRACE_BUFFER_EMPTY);
+                WroteBuffer = 1;
+            }
+        }
+
+        if(WroteBuffer)
+        {
+            IdleMilliseconds = 0;
+        }
+        else if(MVMAtomicLoadU32(&Writer->StopRequested))
+        {
+            break;
+        }
+        else
+        {
+            MVMPlatformSleepMilliseconds(1);
+            if(++IdleMilliseconds >= DEBUG_TRACE_FLUSH_INTERVAL_MS)
+            {
+                // NOTE(Marko): Must not wait here: whoever holds the lock 
+                //              may be waiting for us to empty a buffer. 
+                MVMLockAcquire(&Writer->Lock);
+                MVMTraceSwapBuffers(Writer, 0);
+                MVMLockRelease(&Writer->Lock);
+                IdleMilliseconds = 0;
+            }
+        }
+    }
+}
+
+
+mvm_debug_memory_trace_writer *
+MVMTraceWriterOpen(const char *Filename, 
+                   mvm_debug_memory_site_table *SiteTable, 
+                   size_t SampleIntervalBytes)
+{
+    mvm_debug_memory_trace_writer *Result = 
+        (mvm_debug_memory_trace_writer *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                          sizeof *Result);
+    if(!Result)
+    {
+        printf("Debug arena allocation failed while creating the trace writer.\n");
+        return(Result);
+    }
+    for(int BufferIndex = 0; BufferIndex < 2; BufferIndex++)
+    {
+        Result->Buffers[BufferIndex].Bytes = 
+            (uint8_t *)MVMArenaAllocate(&GlobalDebugArena, 
+                                        DEBUG_TRACE_BUFFER_SIZE);
+    }
+    if(!Result->Buffers[0].Bytes || !Result->Buffers[1].Bytes)
+    {
+        printf("Debug arena allocation failed while creating the trace buffers.\n");
+        return(0);
+    }
+    if(!MVMPlatformOpenFileForWriting(&Result->File, Filename))
+    {
+        printf("Unable to open trace file %s for writing.\n", Filename);
+        return(0);
+    }
+
+    mvm_debug_memory_trace_header Header = {0};
+    Header.Magic = DEBUG_TRACE_MAGIC;
+    Header.Version = DEBUG_TRACE_VERSION;
+    Header.HeaderSize = sizeof Header;
+    Header.EventSize = sizeof(mvm_debug_memory_event);
+    Header.SiteIDBits = DEBUG_EVENT_SITE_ID_BITS;
+    Header.TimestampFrequency = 
+        MVMCalibrateTimestampFrequency(&Header.CalibrationTimestamp, 
+                                       &Header.CalibrationNanoseconds);
+    Header.SampleIntervalBytes = SampleIntervalBytes;
+
+    // NOTE(Marko): The header goes straight to the file; the initial site 
+    //              table is the first thing in the first buffer. 
+    if(!MVMPlatformWriteFile(&Result->File, &Header, sizeof Header))
+    {
+        printf("Unable to write the header of trace file %s.\n", Filename);
+        MVMPlatformCloseFile(&Result->File);
+        return(0);
+    }
+    MVMTraceWriteNewSites(Result, SiteTable);
+
+    if(!MVMPlatformCreateThread(&Result->Thread, 
+                                MVMTraceWriterThreadProc, 
+                                Result))
+    {
+        printf("Unable to start the trace writer thread.\n");
+        MVMPlatformCloseFile(&Result->File);
+        return(0);
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Sends every thread's unsent events, writes everything out and 
+//              stops the writer thread. No other thread may be recording. 
+void MVMTraceWriterClose(mvm_debug_memory_trace_writer *Writer)
+{
+    for(mvm_debug_memory_thread_state *ThreadState = 
+            GlobalDebugInfoList->Threads; 
+        ThreadState; 
+        ThreadState = ThreadState->Next)
+    {
+        MVMTraceSubmitThreadEvents(Writer, ThreadState);
+    }
+
+    MVMLockAcquire(&Writer->Lock);
+    MVMTraceWriteNewSites(Writer, &GlobalDebugInfoList->SiteTable);
+    MVMTraceSwapBuffers(Writer, 1);
+    MVMLockRelease(&Writer->Lock);
+
+    MVMAtomicStoreU32(&Writer->StopRequested, 1);
+    MVMPlatformJoinThread(&Writer->Thread);
+    MVMPlatformCloseFile(&Writer->File);
+    if(Writer->WriteFailed)
+    {
+        printf("Writing the debug memory trace failed; the trace file is incomplete.\n");
+    }
+}
+
+
+int MVMReserveEventBlock(mvm_debug_memory_thread_state *ThreadState)
+{
+    if(GlobalDebugInfoList->TraceWriter && !ThreadState->PrivateBlockEvents)
+    {
+        ThreadState->PrivateBlockEvents = 
+            (mvm_debug_memory_event *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *ThreadState->PrivateBlockEvents) * 
+                DEBUG_EVENT_BLOCK_SIZE);
+        if(!ThreadState->PrivateBlockEvents)
+        {
+            printf("Debug arena allocation failed while allocating a trace block.\n");
+            return(0);
+        }
+    }
+
+    uint64_t FirstEventIndex = 
+        MVMAtomicAddU64(&GlobalDebugInfoList->EventsReserved, 
+                        DEBUG_EVENT_BLOCK_SIZE);
+
+    if(ThreadState->PrivateBlockEvents)
+    {
+        // NOTE(Marko): Only the indices are shared. The previous contents 
+        //              have already been submitted to the trace. 
+        ThreadState->BlockFirstEventIndex = FirstEventIndex;
+        ThreadState->BlockEvents = ThreadState->PrivateBlockEvents;
+        ThreadState->BlockEventsUsed = 0;
+        ThreadState->BlockEventsSubmitted = 0;
+        return(1);
+    }
+
+    if(GlobalDebugInfoList->EventRingCapacity)
+    {
+        // NOTE(Marko): The ring's chunks already exist. The block still holds 
+        //              events from the previous lap, which must not be read 
+        //              as ours, so clear it before the first write. 
+        uint64_t SlotIndex = 
+            FirstEventIndex % GlobalDebugInfoList->EventRingCapacity;
+
+        // NOTE(Marko): The thread we are lapping may be halfway through an 
+        //              event. Wait for it; it will see that the block has 
+        //              changed hands before it writes the next one. 
+        volatile uint64_t *Owner = 
+            GlobalDebugInfoList->RingBlockOwners + 
+            SlotIndex / DEBUG_EVENT_BLOCK_SIZE;
+        int Spins = 0;
+        for(;;)
+        {
+            uint64_t PreviousOwner = MVMAtomicLoadU64(Owner);
+            if(!(PreviousOwner & DEBUG_EVENT_RING_BLOCK_BUSY) && 
+               (MVMAtomicCompareExchangeU64(Owner, PreviousOwner, 
+                                            FirstEventIndex) == PreviousOwner))
+            {
+                break;
+            }
+            if(++Spins >= DEBUG_LOCK_SPINS_BEFORE_YIELD)
+            {
+                MVMPlatformYield();
+                Spins = 0;
+            }
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        }
+
+        ThreadState->BlockFirstEventIndex = FirstEventIndex;
+        ThreadState->BlockEvents = 
+            MVMGetEventChunk(GlobalDebugInfoList, 
+                             (size_t)(SlotIndex >> DEBUG_EVENT_CHUNK_SHIFT)) + 
+            (SlotIndex & DEBUG_EVENT_CHUNK_MASK);
+        ThreadState->BlockEventsUsed = 0;
+        ThreadState->BlockEventsSubmitted = 0;
+        memset(ThreadState->BlockEvents, 
+               0, 
+               (sizeof *ThreadState->BlockEvents) * DEBUG_EVENT_BLOCK_SIZE);
+        return(1);
+    }
+
+    size_t ChunkIndex = (size_t)(FirstEventIndex >> DEBUG_EVENT_CHUNK_SHIFT);
+
+    MVMLockAcquire(&GlobalDebugInfoList->Lock);
+    // NOTE(Marko): Blocks can be reserved out of order, so fill in every 
+    //              chunk up to ours. 
+    while(GlobalDebugInfoList->EventChunksCount <= ChunkIndex)
+    {
+        mvm_debug_memory_event *NewChunk = 
+            (mvm_debug_memory_event *)MVMArenaAllocate(
+                &GlobalDebugArena, 
+                (sizeof *NewChunk) * DEBUG_EVENT_CHUNK_SIZE);
+        if(!NewChunk)
+        {
+            printf("Debug arena allocation failed while allocating an event chunk.\n");
+            break;
+        }
+        if(!MVMAddEventChunk(GlobalDebugInfoList, NewChunk))
+        {
+            MVMArenaFree(&GlobalDebugArena, 
+                         NewChunk, 
+                         (sizeof *NewChunk) * DEBUG_EVENT_CHUNK_SIZE);
+            break;
+        }
+    }
+    mvm_debug_memory_event *Chunk = 
+        MVMGetEventChunk(GlobalDebugInfoList, ChunkIndex);
+    MVMLockRelease(&GlobalDebugInfoList->Lock);
+
+    if(Chunk)
+    {
+        ThreadState->BlockFirstEventIndex = FirstEventIndex;
+        ThreadState->BlockEvents = 
+            Chunk + (FirstEventIndex & DEBUG_EVENT_CHUNK_MASK);
+        ThreadState->BlockEventsUsed = 0;
+        ThreadState->BlockEventsSubmitted = 0;
+    }
+    return(Chunk != 0);
+}
+
+
+uint64_t MVMAppendEvent(mvm_debug_memory_thread_state *ThreadState, 
+                        memory_operation_type MemoryOperationType, 
+                        uint32_t SiteID, 
+                        void *Address, 
+                        size_t ByteCount, 
+                        uint64_t PreviousEventIndex)
+{
+    uint64_t Result = DEBUG_EVENT_INDEX_NONE;
+
+    // NOTE(Marko): In ring mode other threads can lap a block this thread 
+    //              has only partly filled. Mark the block busy for the 
+    //              length of one event; if it has changed hands, move on to 
+    //              a new block as if this one were full. 
+    volatile uint64_t *Owner = 0;
+    for(;;)
+    {
+        if(ThreadState->BlockEventsUsed >= DEBUG_EVENT_BLOCK_SIZE)
+        {
+            if(GlobalDebugInfoList->TraceWriter)
+            {
+                MVMTraceSubmitThreadEvents(GlobalDebugInfoList->TraceWriter, 
+                                           ThreadState);
+            }
+            if(!MVMReserveEventBlock(ThreadState))
+            {
+                return(Result);
+            }
+        }
+        if(!GlobalDebugInfoList->EventRingCapacity || 
+           ThreadState->PrivateBlockEvents)
+        {
+            break;
+        }
+        Owner = GlobalDebugInfoList->RingBlockOwners + 
+            (ThreadState->BlockFirstEventIndex % 
+             GlobalDebugInfoList->EventRingCapacity) / DEBUG_EVENT_BLOCK_SIZE;
+        if(MVMAtomicCompareExchangeU64(Owner, 
+                                       ThreadState->BlockFirstEventIndex, 
+                                       ThreadState->BlockFirstEventIndex | 
+                                       DEBUG_EVENT_RING_BLOCK_BUSY) == 
+           ThreadState->BlockFirstEventIndex)
+        {
+            break;
+        }
+        ThreadState->BlockEventsUsed = DEBUG_EVENT_BLOCK_SIZE;
+    }
+
+    uint64_t EventIndex = 
+        ThreadState->BlockFirstEventIndex + ThreadState->BlockEventsUsed;
+    mvm_debug_memory_event *Event = 
+        ThreadState->BlockEvents + ThreadState->BlockEventsUsed;
+
+    Event->Timestamp = MVMReadTimestamp();
+    Event->Address = (uint64_t)(uintptr_t)Address;
+    Event->ByteCount = (uint64_t)ByteCount;
+    Event->PreviousEventOffset = 0;
+    if(PreviousEventIndex != DEBUG_EVENT_INDEX_NONE)
+    {
+        int64_t PreviousEventOffset = 
+            (int64_t)(EventIndex - PreviousEventIndex);
+        if((PreviousEventOffset <= INT32_MAX) && 
+           (PreviousEventOffset >= -INT32_MAX))
+        {
+            Event->PreviousEventOffset = (int32_t)PreviousEventOffset;
+        }
+    }
+    MVMAtomicStoreU32(&Event->SiteAndType, 
+                      ((uint32_t)MemoryOperationType << 
+                       DEBUG_EVENT_SITE_ID_BITS) | 
+                      (SiteID & DEBUG_EVENT_SITE_ID_MASK));
+
+    if(Owner)
+    {
+        MVMAtomicStoreU64(Owner, ThreadState->BlockFirstEventIndex);
+    }
+
+    ThreadState->BlockEventsUsed++;
+    ThreadState->EventsCount++;
+    Result = EventIndex;
+    return(Result);
+}
+
+
+mvm_debug_memory_event *MVMFindInitialEvent(uint64_t EventIndex)
+{
+    // NOTE(Marko): Walk the chain back to the event that started it. 
+    mvm_debug_memory_event *Result = MVMGetEvent(EventIndex);
+    while(Result && Result->PreviousEventOffset)
+    {
+        EventIndex = MVMGetPreviousEventIndex(EventIndex, Result);
+        Result = MVMGetEvent(EventIndex);
+    }
+    return(Result);
+}
+
+
+//
+// NOTE(Marko): Merge step for reporting. Every block of the log is already in 
+//              time order, so a binary heap of one cursor per block yields the 
+//              whole log in time order without sorting it. Meant to be run 
+//              while the tracked threads are quiet. 
+//
+
+typedef struct mvm_debug_memory_event_cursor
+{
+    uint64_t EventIndex;
+    uint64_t BlockEndIndex;
+    uint64_t Timestamp;
+
+} mvm_debug_memory_event_cursor;
+
+
+typedef struct mvm_debug_memory_event_merge
+{
+    size_t CursorsCount;
+    size_t CursorsAllocated;
+    mvm_debug_memory_event_cursor *Cursors;
+
+} mvm_debug_memory_event_merge;
+
+
+int MVMEventCursorPrecedes(mvm_debug_memory_event_cursor *A, 
+                           mvm_debug_memory_event_cursor *B)
+{
+    return((A->Timestamp < B->Timestamp) || 
+           ((A->Timestamp == B->Timestamp) && (A->EventIndex < B->EventIndex)));
+}
+
+
+void MVMEventMergeSiftDown(mvm_debug_memory_event_merge *Merge, 
+                           size_t CursorIndex)
+{
+    for(;;)
+    {
+        size_t Smallest = CursorIndex;
+        size_t Left = 2*CursorIndex + 1;
+        size_t Right = Left + 1;
+        if((Left < Merge->CursorsCount) && 
+           MVMEventCursorPrecedes(Merge->Cursors + Left, 
+                                  Merge->Cursors + Smallest))
+        {
+            Smallest = Left;
+        }
+        if((Right < Merge->CursorsCount) && 
+           MVMEventCursorPrecedes(Merge->Cursors + Right, 
+                                  Merge->Cursors + Smallest))
+        {
+            Smallest = Right;
+        }
+        if(Smallest == CursorIndex)
+        {
+            break;
+        }
+        mvm_debug_memory_event_cursor Temp = Merge->Cursors[CursorIndex];
+        Merge->Cursors[CursorIndex] = Merge->Cursors[Smallest];
+        Merge->Cursors[Smallest] = Temp;
+        CursorIndex = Smallest;
+    }
+}
+
+
+void MVMBeginEventMerge(mvm_debug_memory_event_merge *Merge)
+{
+    *Merge = (mvm_debug_memory_event_merge){0};
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+
+    // NOTE(Marko): In ring mode only the last EventRingCapacity events are 
+    //              still there. 
+    uint64_t EventsReserved = GlobalDebugInfoList->EventsReserved;
+    uint64_t FirstRetainedEventIndex = 0;
+    if(GlobalDebugInfoList->EventRingCapacity && 
+       (EventsReserved > GlobalDebugInfoList->EventRingCapacity))
+    {
+        FirstRetainedEventIndex = 
+            EventsReserved - GlobalDebugInfoList->EventRingCapacity;
+    }
+    Merge->CursorsAllocated = 
+        (size_t)((EventsReserved - FirstRetainedEventIndex) / 
+                 DEBUG_EVENT_BLOCK_SIZE);
+    if(Merge->CursorsAllocated)
+    {
+        Merge->Cursors = (mvm_debug_memory_event_cursor *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *Merge->Cursors) * Merge->CursorsAllocated);
+    }
+    if(!Merge->Cursors)
+    {
+        Merge->CursorsAllocated = 0;
+        return;
+    }
+
+    for(size_t BlockIndex = 0; 
+        BlockIndex < Merge->CursorsAllocated; 
+        BlockIndex++)
+    {
+        uint64_t FirstEventIndex = 
+            FirstRetainedEventIndex + 
+            (uint64_t)BlockIndex * DEBUG_EVENT_BLOCK_SIZE;
+        mvm_debug_memory_event *Event = MVMGetEvent(FirstEventIndex);
+        if(Event && (MVMGetEventType(Event) != MemoryOperationType_NotAssigned))
+        {
+            mvm_debug_memory_event_cursor *Cursor = 
+                Merge->Cursors + Merge->CursorsCount++;
+            Cursor->EventIndex = FirstEventIndex;
+            Cursor->BlockEndIndex = FirstEventIndex + DEBUG_EVENT_BLOCK_SIZE;
+            Cursor->Timestamp = Event->Timestamp;
+        }
+    }
+
+    for(size_t CursorIndex = Merge->CursorsCount / 2; 
+        CursorIndex > 0; 
+        CursorIndex--)
+    {
+        MVMEventMergeSiftDown(Merge, CursorIndex - 1);
+    }
+}
+
+
+// NOTE(Marko): Returns DEBUG_EVENT_INDEX_NONE once every event is consumed. 
+uint64_t MVMNextMergedEvent(mvm_debug_memory_event_merge *Merge)
+{
+    uint64_t Result = DEBUG_EVENT_INDEX_NONE;
+    if(Merge->CursorsCount)
+    {
+        mvm_debug_memory_event_cursor *Cursor = Merge->Cursors;
+        Result = Cursor->EventIndex;
+
+        // NOTE(Marko): Advance this block. Blocks are filled front to back, 
+        //              so the first unassigned slot ends it. 
+        mvm_debug_memory_event *NextEvent = 0;
+        if(++Cursor->EventIndex < Cursor->BlockEndIndex)
+        {
+            NextEvent = MVMGetEvent(Cursor->EventIndex);
+        }
+        if(NextEvent && 
+           (MVMGetEventType(NextEvent) != MemoryOperationType_NotAssigned))
+        {
+            Cursor->Timestamp = NextEvent->Timestamp;
+        }
+        else
+        {
+            Merge->Cursors[0] = Merge->Cursors[--Merge->CursorsCount];
+        }
+        MVMEventMergeSiftDown(Merge, 0);
+    }
+    return(Result);
+}
+
+
+void MVMEndEventMerge(mvm_debug_memory_event_merge *Merge)
+{
+    MVMArenaFree(&GlobalDebugArena, 
+                 Merge->Cursors, 
+                 (sizeof *Merge->Cursors) * Merge->CursorsAllocated);
+    *Merge = (mvm_debug_memory_event_merge){0};
+}
+
+
+uint64_t MVMHashAddress(void *Address)
+{
+    // NOTE(Marko): Fibonacci hashing. Allocator addresses are aligned, so the 
+    //              low bits carry almost no information on their own. 
+    uint64_t Hash = (uint64_t)(uintptr_t)Address;
+    Hash ^= Hash >> 33;
+    Hash *= 0x9E3779B97F4A7C15ULL;
+    Hash ^= Hash >> 29;
+    return Hash;
+}
+
+
+mvm_debug_memory_address_table *MVMGetAddressTableShard(void *Address)
+{
+    return(GlobalDebugInfoList->AddressTables + 
+           (MVMHashAddress(Address) >> (64 - DEBUG_ADDRESS_TABLE_SHARD_SHIFT)));
+}
+
+
+void MVMAddressTableResize(mvm_debug_memory_address_table *AddressTable,
+                           size_t NewSlotsAllocated)
+{
+    // NOTE(Marko): Arena memory comes back zeroed, i.e. every slot empty. 
+    mvm_debug_memory_info *NewSlots = 
+        (mvm_debug_memory_info *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *NewSlots) * NewSlotsAllocated);
+    if(!NewSlots)
+    {
+        printf("Debug arena allocation failed while growing the debug address table.\n\tAttempted to allocate %zu bytes.\n",
+               (sizeof *NewSlots) * NewSlotsAllocated);
+        return;
+    }
+
+    // NOTE(Marko): Rehash only the live slots. This drops every tombstone. 
+    size_t Mask = NewSlotsAllocated - 1;
+    for(size_t OldSlotIndex = 0; 
+        OldSlotIndex < AddressTable->SlotsAllocated; 
+        OldSlotIndex++)
+    {
+        mvm_debug_memory_info *OldSlot = AddressTable->Slots + OldSlotIndex;
+        if((OldSlot->CurrentAddress != DEBUG_ADDRESS_TABLE_EMPTY) && 
+           (OldSlot->CurrentAddress != DEBUG_ADDRESS_TABLE_TOMBSTONE))
+        {
+            size_t SlotIndex = 
+                (size_t)MVMHashAddress(OldSlot->CurrentAddress) & Mask;
+            while(NewSlots[SlotIndex].CurrentAddress != 
+                  DEBUG_ADDRESS_TABLE_EMPTY)
+            {
+                SlotIndex = (SlotIndex + 1) & Mask;
+            }
+            NewSlots[SlotIndex] = *OldSlot;
+        }
+    }
+
+    MVMArenaFree(&GlobalDebugArena, 
+                 AddressTable->Slots, 
+                 (sizeof *AddressTable->Slots) * AddressTable->SlotsAllocated);
+    AddressTable->Slots = NewSlots;
+    AddressTable->SlotsAllocated = NewSlotsAllocated;
+    AddressTable->TombstonesCount = 0;
+}
+
+
+// NOTE(Marko): The caller must hold AddressTable->Lock for all of the 
+//              MVMAddressTable* functions. 
+mvm_debug_memory_info *
+MVMAddressTableFind(mvm_debug_memory_address_table *AddressTable, 
+                    void *Address)
+{
+    mvm_debug_memory_info *Result = 0;
+    if(AddressTable->Slots)
+    {
+        size_t Mask = AddressTable->SlotsAllocated - 1;
+        size_t SlotIndex = (size_t)MVMHashAddress(Address) & Mask;
+        while(AddressTable->Slots[SlotIndex].CurrentAddress != 
+              DEBUG_ADDRESS_TABLE_EMPTY)
+        {
+            if(AddressTable->Slots[SlotIndex].CurrentAddress == Address)
+            {
+                Result = AddressTable->Slots + SlotIndex;
+                break;
+            }
+            SlotIndex = (SlotIndex + 1) & Mask;
+        }
+    }
+    return(Result);
+}
+
+
+mvm_debug_memory_info *
+MVMAddressTableInsert(mvm_debug_memory_address_table *AddressTable, 
+                      mvm_debug_memory_info *DebugInfo)
+{
+    mvm_debug_memory_info *Result = 0;
+
+    // NOTE(Marko): Keep (live + tombstones) under 3/4 of the table so probe 
+    //              sequences stay short. If most of the load is tombstones 
+    //              a same-size rehash is enough to clean them out. 
+    if((AddressTable->SlotsUsed + AddressTable->TombstonesCount + 1)*4 >= 
+       AddressTable->SlotsAllocated*3)
+    {
+        size_t NewSlotsAllocated = AddressTable->SlotsAllocated ? 
+            AddressTable->SlotsAllocated : DEBUG_ADDRESS_TABLE_INITIAL_SIZE;
+        while((AddressTable->SlotsUsed + 1)*2 >= NewSlotsAllocated)
+        {
+            NewSlotsAllocated *= 2;
+        }
+        MVMAddressTableResize(AddressTable, NewSlotsAllocated);
+
+        // NOTE(Marko): A failed resize leaves the old table in place. Filling 
+        //              it further would eventually leave no empty slot to end 
+        //              a probe, so drop the record instead. 
+        if(!AddressTable->Slots || 
+           ((AddressTable->SlotsUsed + AddressTable->TombstonesCount + 1)*4 >= 
+            AddressTable->SlotsAllocated*3))
+        {
+            return(Result);
+        }
+    }
+
+    size_t Mask = AddressTable->SlotsAllocated - 1;
+    size_t SlotIndex = (size_t)MVMHashAddress(DebugInfo->CurrentAddress) & Mask;
+    mvm_debug_memory_info *FirstTombstone = 0;
+    for(;;)
+    {
+        mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+        if(Slot->CurrentAddress == DebugInfo->CurrentAddress)
+        {
+            // NOTE(Marko): The address was handed out again without us 
+            //              seeing the free (e.g. it happened while the tool 
+            //              was turned off). The newest record wins. 
+            Result = Slot;
+            break;
+        }
+        else if(Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_EMPTY)
+        {
+            Result = Slot;
+            if(FirstTombstone)
+            {
+                Result = FirstTombstone;
+                AddressTable->TombstonesCount--;
+            }
+            AddressTable->SlotsUsed++;
+            break;
+        }
+        else if((Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_TOMBSTONE) && 
+                !FirstTombstone)
+        {
+            FirstTombstone = Slot;
+        }
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+
+    *Result = *DebugInfo;
+    return(Result);
+}
+
+
+void MVMAddressTableRemove(mvm_debug_memory_address_table *AddressTable, 
+                           mvm_debug_memory_info *Slot)
+{
+    *Slot = (mvm_debug_memory_info){0};
+    Slot->CurrentAddress = DEBUG_ADDRESS_TABLE_TOMBSTONE;
+    AddressTable->SlotsUsed--;
+    AddressTable->TombstonesCount++;
+}
+
+
+void MVMInsertDebugInfo(mvm_debug_memory_info *DebugInfo)
+{
+    mvm_debug_memory_address_table *AddressTable = 
+        MVMGetAddressTableShard(DebugInfo->CurrentAddress);
+    MVMLockAcquire(&AddressTable->Lock);
+    MVMAddressTableInsert(AddressTable, DebugInfo);
+    MVMLockRelease(&AddressTable->Lock);
+}
+
+
+// NOTE(Marko): Finds the live record for Address, copies it to DebugInfo and 
+//              removes it from the index, all under one lock. Returns 0 if 
+//              the address is not being tracked. 
+int MVMTakeDebugInfo(void *Address, mvm_debug_memory_info *DebugInfo)
+{
+    int Result = 0;
+    mvm_debug_memory_address_table *AddressTable = 
+        MVMGetAddressTableShard(Address);
+    MVMLockAcquire(&AddressTable->Lock);
+    mvm_debug_memory_info *Slot = MVMAddressTableFind(AddressTable, Address);
+    if(Slot)
+    {
+        *DebugInfo = *Slot;
+        MVMAddressTableRemove(AddressTable, Slot);
+        Result = 1;
+    }
+    MVMLockRelease(&AddressTable->Lock);
+    return(Result);
+}
+
+
+// NOTE(Marko): Copies the live record for SearchedAddress into Result. 
+//              Returns 0 if the address is not being tracked. 
+int MVMSearchDebugInfoListByCurrentAddress(void *SearchedAddress, 
+                                           mvm_debug_memory_info *Result)
+{
+    int Found = 0;   
+    if (GlobalDebugInfoList)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            MVMGetAddressTableShard(SearchedAddress);
+        MVMLockAcquire(&AddressTable->Lock);
+        mvm_debug_memory_info *Slot = 
+            MVMAddressTableFind(AddressTable, SearchedAddress);
+        if(Slot)
+        {
+            *Result = *Slot;
+            Found = 1;
+        }
+        MVMLockRelease(&AddressTable->Lock);
+    }
+    return(Found);
+}
+
+
+size_t MVMCountLiveAllocations(void)
+{
+    size_t Result = 0;
+    for(int ShardIndex = 0; 
+        ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT; 
+        ShardIndex++)
+    {
+        Result += GlobalDebugInfoList->AddressTables[ShardIndex].SlotsUsed;
+    }
+    return(Result);
+}
+
+
+int MVMDebugInfoIsTurnedOn(void)
+{
+    return(GlobalDebugInfoList && (GlobalDebugInfoList->TurnOnCount > 0));
+}
+
+
+uint8_t MVMAlignmentLog2(size_t Alignment)
+{
+    uint8_t Result = 0;
+    while((Result < 63) && (((size_t)1 << Result) < Alignment))
+    {
+        Result++;
+    }
+    return(Result);
+}
+
+
+size_t MVMAlignmentFromLog2(uint8_t AlignmentLog2)
+{
+    return(AlignmentLog2 ? ((size_t)1 << AlignmentLog2) : 0);
+}
+
+
+// NOTE(Marko): Front redzone of a padded block. Rounding it up to the 
+//              block's alignment keeps the user's pointer aligned. 
+size_t MVMGetRecordFrontRedzoneBytes(mvm_debug_memory_info *DebugInfo, 
+                                     size_t RedzoneBytes)
+{
+    size_t Alignment = MVMAlignmentFromLog2(DebugInfo->AlignmentLog2);
+    return((Alignment > RedzoneBytes) ? Alignment : RedzoneBytes);
+}
+
+
+size_t MVMGetGuardPageBlockAlignment(size_t Alignment)
+{
+    return((Alignment > DEBUG_GUARD_PAGE_ALIGNMENT) ? 
+           Alignment : DEBUG_GUARD_PAGE_ALIGNMENT);
+}
+
+
+// NOTE(Marko): Where the guard page after a guarded block begins. 
+uint8_t *MVMGetGuardPage(mvm_debug_memory_info *DebugInfo)
+{
+    size_t Alignment = MVMGetGuardPageBlockAlignment(
+        MVMAlignmentFromLog2(DebugInfo->AlignmentLog2));
+    return((uint8_t *)DebugInfo->CurrentAddress + 
+           ((DebugInfo->ByteCount + Alignment - 1) & ~(Alignment - 1)));
+}
+
+
+// NOTE(Marko): The pages a guarded block was given, guard page included. 
+uint8_t *MVMGetGuardPageMapping(mvm_debug_memory_info *DebugInfo, 
+                                size_t *MappingBytes)
+{
+    size_t PageSize = GlobalDebugInfoList->PageSize;
+    uint8_t *GuardPage = MVMGetGuardPage(DebugInfo);
+    size_t DataBytes = 
+        (size_t)(GuardPage - (uint8_t *)DebugInfo->CurrentAddress);
+    size_t DataPagesBytes = (DataBytes + PageSize - 1) & ~(PageSize - 1);
+    *MappingBytes = DataPagesBytes + PageSize;
+    return(GuardPage - DataPagesBytes);
+}
+
+
+// NOTE(Marko): Whether Bytes[0..DEBUG_FILL_CHUNK) all equal the Fill 
+//              pattern. The chunk is compared 16 bytes at a time with SSE2 and 
+//              8 otherwise. 
+#define DEBUG_FILL_CHUNK 64
+
+int MVMIsFillChunkIntact(uint8_t *Bytes, uint8_t Fill)
+{
+#if MVM_DEBUG_SSE2
+    __m128i Pattern = _mm_set1_epi8((char)Fill);
+    __m128i Equal = _mm_and_si128(
+        _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(Bytes + 0)), Pattern), 
+            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(Bytes + 16)), Pattern)), 
+        _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(Bytes + 32)), Pattern), 
+            _mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)(Bytes + 48)), Pattern)));
+    return(_mm_movemask_epi8(Equal) == 0xFFFF);
+#else
+    uint64_t Pattern = 0x0101010101010101ull * Fill;
+    uint64_t Difference = 0;
+    for(int WordIndex = 0; WordIndex < DEBUG_FILL_CHUNK / 8; WordIndex++)
+    {
+        uint64_t Word;
+        memcpy(&Word, Bytes + 8*WordIndex, sizeof Word);
+        Difference |= Word ^ Pattern;
+    }
+    return(Difference == 0);
+#endif
+}
+
+
+// NOTE(Marko): Finds the first and last of Bytes[0..Count) that no longer 
+//              hold Fill. Returns 0 if there are none. Whole chunks are 
+//              skipped from both ends, so only the chunks holding the first 
+//              and last damaged bytes are looked at byte by byte. 
+int MVMFindFillDamage(uint8_t *Bytes, 
+                      size_t Count, 
+                      uint8_t Fill, 
+                      size_t *First, 
+                      size_t *Last)
+{
+    size_t Index = 0;
+    while((Index + DEBUG_FILL_CHUNK <= Count) && 
+          MVMIsFillChunkIntact(Bytes + Index, Fill))
+    {
+        Index += DEBUG_FILL_CHUNK;
+    }
+    while((Index < Count) && (Bytes[Index] == Fill))
+    {
+        Index++;
+    }
+    if(Index == Count)
+    {
+        return(0);
+    }
+    *First = Index;
+
+    size_t End = Count;
+    while((End >= Index + DEBUG_FILL_CHUNK) && 
+          MVMIsFillChunkIntact(Bytes + End - DEBUG_FILL_CHUNK, Fill))
+    {
+        End -= DEBUG_FILL_CHUNK;
+    }
+    while(Bytes[End - 1] == Fill)
+    {
+        End--;
+    }
+    *Last = End - 1;
+    return(1);
+}
+
+
+// NOTE(Marko): Checks the canaries on both sides of a padded block, redzones 
+//              or the ones around a guarded block. On damage, returns 0 and 
+//              how far past the end and before the start it reaches. 
+int MVMCheckRedzones(mvm_debug_memory_info *DebugInfo, 
+                     size_t *OverrunBytes, 
+                     size_t *UnderrunBytes)
+{
+    uint8_t *Block = (uint8_t *)DebugInfo->CurrentAddress;
+    size_t FrontBytes = 0;
+    size_t BackBytes = 0;
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+    {
+        size_t MappingBytes;
+        FrontBytes = 
+            (size_t)(Block - MVMGetGuardPageMapping(DebugInfo, &MappingBytes));
+        BackBytes = (size_t)(MVMGetGuardPage(DebugInfo) - 
+                             (Block + DebugInfo->ByteCount));
+    }
+    else
+    {
+        BackBytes = GlobalDebugInfoList->RedzoneBytes;
+        FrontBytes = MVMGetRecordFrontRedzoneBytes(DebugInfo, BackBytes);
+    }
+    size_t First = 0;
+    size_t Last = 0;
+    *OverrunBytes = 0;
+    *UnderrunBytes = 0;
+    if(MVMFindFillDamage(Block + DebugInfo->ByteCount, BackBytes, 
+                         DEBUG_REDZONE_CANARY, &First, &Last))
+    {
+        *OverrunBytes = Last + 1;
+    }
+    if(MVMFindFillDamage(Block - FrontBytes, FrontBytes, 
+                         DEBUG_REDZONE_CANARY, &First, &Last))
+    {
+        *UnderrunBytes = FrontBytes - First;
+    }
+    return(!*OverrunBytes && !*UnderrunBytes);
+}
+
+
+// NOTE(Marko): Filename and LineNumber say where the damage was found. 
+void MVMReportRedzoneDamage(mvm_debug_memory_info *DebugInfo, 
+                            size_t OverrunBytes, 
+                            size_t UnderrunBytes, 
+                            const char *Filename, 
+                            int LineNumber)
+{
+    MVMAtomicAddU64(&GlobalDebugInfoList->RedzoneErrorsCount, 1);
+    printf("Heap corruption detected in file %s on line %d\n", 
+           Filename, LineNumber);
+    printf("The %zu-byte block at %p was written", 
+           DebugInfo->ByteCount, DebugInfo->CurrentAddress);
+    if(OverrunBytes)
+    {
+        printf(" up to %zu bytes past its end", OverrunBytes);
+    }
+    if(UnderrunBytes)
+    {
+        printf("%s up to %zu bytes before its start", 
+               OverrunBytes ? " and" : "", UnderrunBytes);
+    }
+    mvm_debug_memory_site *Site = MVMGetCallSite(DebugInfo->InitialSiteID);
+    printf("\nAllocated in file %s on line %d\n", 
+           Site ? Site->Filename : "?", 
+           Site ? Site->LineNumber : 0);
+    mvm_debug_memory_stack *Stack = 
+        MVMGetStack(&GlobalDebugInfoList->StackTable, DebugInfo->StackID);
+    if(Stack)
+    {
+        MVMPlatformPrintStackFrames(Stack->Frames, Stack->FramesCount);
+    }
+}
+
+
+// NOTE(Marko): Whether blocks may be padded at all, with redzones or guard 
+//              pages. Padded blocks have to be recognized when they are 
+//              released, even while the tool is turned off. 
+int MVMBlockPaddingEnabled(void)
+{
+    return(GlobalDebugInfoList && 
+           (GlobalDebugInfoList->RedzoneBytes || 
+            GlobalDebugInfoList->GuardPagesMaxBytes || 
+            MVMAtomicLoadU64(&GlobalDebugInfoList->GuardedSitesCount)));
+}
+
+
+// NOTE(Marko): For a padded block that is being released: checks it and 
+//              reports damage not reported yet. 
+void MVMCheckPaddedBlock(mvm_debug_memory_info *DebugInfo, 
+                         const char *Filename, 
+                         int LineNumber)
+{
+    size_t OverrunBytes = 0;
+    size_t UnderrunBytes = 0;
+    if(!MVMCheckRedzones(DebugInfo, &OverrunBytes, &UnderrunBytes) && 
+       !(DebugInfo->Flags & DEBUG_INFO_FLAG_REDZONE_REPORTED))
+    {
+        DebugInfo->Flags |= DEBUG_INFO_FLAG_REDZONE_REPORTED;
+        MVMReportRedzoneDamage(DebugInfo, OverrunBytes, UnderrunBytes, 
+                               Filename, LineNumber);
+    }
+}
+
+
+// NOTE(Marko): Checks a padded block that is being released, as above, and 
+//              returns the pointer the C library handed out for it. A 
+//              guarded block's pages are unmapped right here instead, and 0 
+//              is returned. 
+void *MVMReleasePaddedBlock(mvm_debug_memory_info *DebugInfo, 
+                            const char *Filename, 
+                            int LineNumber)
+{
+    MVMCheckPaddedBlock(DebugInfo, Filename, LineNumber);
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+    {
+        size_t MappingBytes;
+        uint8_t *Mapping = MVMGetGuardPageMapping(DebugInfo, &MappingBytes);
+        MVMPlatformFreePages(Mapping, MappingBytes);
+        return(0);
+    }
+    return((uint8_t *)DebugInfo->CurrentAddress - 
+           MVMGetRecordFrontRedzoneBytes(DebugInfo, 
+                                         GlobalDebugInfoList->RedzoneBytes));
+}
+
+
+// NOTE(Marko): Hands memory the tool got from the C library back to it. 
+void MVMFreeBlockMemory(void *Memory, uint8_t AlignmentLog2)
+{
+#if defined(_WIN32)
+    if(AlignmentLog2)
+    {
+        MVM_DEBUG_REAL_ALIGNED_FREE(Memory);
+        return;
+    }
+#else
+    (void)AlignmentLog2;
+#endif
+    MVM_DEBUG_REAL_FREE(Memory);
+}
+
+
+// NOTE(Marko): What a block counts against the quarantine's cap. Empty 
+//              blocks count as one byte so that they cannot pile up. 
+size_t MVMGetQuarantineCharge(mvm_debug_memory_info *DebugInfo)
+{
+    return(DebugInfo->ByteCount ? DebugInfo->ByteCount : 1);
+}
+
+
+// NOTE(Marko): The slot holding Address, or the empty slot it would go in. 
+mvm_debug_memory_quarantine_slot *
+MVMQuarantineFindSlot(mvm_debug_memory_quarantine *Quarantine, void *Address)
+{
+    size_t Mask = Quarantine->SlotsAllocated - 1;
+    size_t SlotIndex = (size_t)MVMHashAddress(Address) & Mask;
+    while(Quarantine->Slots[SlotIndex].Address && 
+          (Quarantine->Slots[SlotIndex].Address != Address))
+    {
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+    return(Quarantine->Slots + SlotIndex);
+}
+
+
+void MVMQuarantineRemoveSlot(mvm_debug_memory_quarantine *Quarantine, 
+                             mvm_debug_memory_quarantine_slot *Slot)
+{
+    // NOTE(Marko): Later members of the probe chain move back into the hole, 
+    //              unless their home slot lies between the hole and them. 
+    size_t Mask = Quarantine->SlotsAllocated - 1;
+    size_t HoleIndex = (size_t)(Slot - Quarantine->Slots);
+    size_t SlotIndex = HoleIndex;
+    for(;;)
+    {
+        SlotIndex = (SlotIndex + 1) & Mask;
+        mvm_debug_memory_quarantine_slot *Next = Quarantine->Slots + SlotIndex;
+        if(!Next->Address)
+        {
+            break;
+        }
+        size_t HomeIndex = (size_t)MVMHashAddress(Next->Address) & Mask;
+        if(((SlotIndex - HomeIndex) & Mask) >= ((SlotIndex - HoleIndex) & Mask))
+        {
+            Quarantine->Slots[HoleIndex] = *Next;
+            HoleIndex = SlotIndex;
+        }
+    }
+    Quarantine->Slots[HoleIndex].Address = 0;
+}
+
+
+// NOTE(Marko): Doubles the ring, unwrapping it, and rebuilds the index to 
+//              match. Returns 0 if the debug arena is out of memory. 
+int MVMQuarantineGrow(mvm_debug_memory_quarantine *Quarantine)
+{
+    size_t NewEntriesAllocated = Quarantine->EntriesAllocated ? 
+        2*Quarantine->EntriesAllocated : DEBUG_QUARANTINE_INITIAL_SIZE;
+    size_t NewSlotsAllocated = 2*NewEntriesAllocated;
+    mvm_debug_memory_quarantine_entry *NewEntries = 
+        (mvm_debug_memory_quarantine_entry *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *NewEntries) * NewEntriesAllocated);
+    mvm_debug_memory_quarantine_slot *NewSlots = 
+        (mvm_debug_memory_quarantine_slot *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *NewSlots) * NewSlotsAllocated);
+    if(!NewEntries || !NewSlots)
+    {
+        printf("Debug arena allocation failed while growing the quarantine.\n");
+        if(NewEntries)
+        {
+            MVMArenaFree(&GlobalDebugArena, NewEntries, 
+                         (sizeof *NewEntries) * NewEntriesAllocated);
+        }
+        if(NewSlots)
+        {
+            MVMArenaFree(&GlobalDebugArena, NewSlots, 
+                         (sizeof *NewSlots) * NewSlotsAllocated);
+        }
+        return(0);
+    }
+
+    for(size_t EntryIndex = 0; 
+        EntryIndex < Quarantine->EntriesCount; 
+        EntryIndex++)
+    {
+        NewEntries[EntryIndex] = 
+            Quarantine->Entries[(Quarantine->FirstEntryIndex + EntryIndex) & 
+                                (Quarantine->EntriesAllocated - 1)];
+    }
+    if(Quarantine->Entries)
+    {
+        MVMArenaFree(&GlobalDebugArena, 
+                     Quarantine->Entries, 
+                     (sizeof *Quarantine->Entries) * 
+                     Quarantine->EntriesAllocated);
+        MVMArenaFree(&GlobalDebugArena, 
+                     Quarantine->Slots, 
+                     (sizeof *Quarantine->Slots) * Quarantine->SlotsAllocated);
+    }
+    Quarantine->Entries = NewEntries;
+    Quarantine->EntriesAllocated = NewEntriesAllocated;
+    Quarantine->FirstEntryIndex = 0;
+    Quarantine->Slots = NewSlots;
+    Quarantine->SlotsAllocated = NewSlotsAllocated;
+
+    for(size_t EntryIndex = 0; 
+        EntryIndex < Quarantine->EntriesCount; 
+        EntryIndex++)
+    {
+        void *Address = NewEntries[EntryIndex].DebugInfo.CurrentAddress;
+        mvm_debug_memory_quarantine_slot *Slot = 
+            MVMQuarantineFindSlot(Quarantine, Address);
+        Slot->Address = Address;
+        Slot->EntryIndex = EntryIndex;
+    }
+    return(1);
+}
+
+
+// NOTE(Marko): Copies the entry for Address out of the quarantine. Returns 0 
+//              if the address is not in there. 
+int MVMFindQuarantineEntry(mvm_debug_memory_quarantine *Quarantine, 
+                           void *Address, 
+                           mvm_debug_memory_quarantine_entry *Entry)
+{
+    int Result = 0;
+    MVMLockAcquire(&Quarantine->Lock);
+    if(Quarantine->SlotsAllocated)
+    {
+        mvm_debug_memory_quarantine_slot *Slot = 
+            MVMQuarantineFindSlot(Quarantine, Address);
+        if(Slot->Address)
+        {
+            *Entry = Quarantine->Entries[Slot->EntryIndex];
+            Result = 1;
+        }
+    }
+    MVMLockRelease(&Quarantine->Lock);
+    return(Result);
+}
+
+
+void MVMPrintFreedBlockSites(mvm_debug_memory_quarantine_entry *Entry)
+{
+    mvm_debug_memory_site *FreeSite = MVMGetCallSite(Entry->FreeSiteID);
+    mvm_debug_memory_site *Site = 
+        MVMGetCallSite(Entry->DebugInfo.InitialSiteID);
+    printf("Freed in file %s on line %d\n", 
+           FreeSite ? FreeSite->Filename : "?", 
+           FreeSite ? FreeSite->LineNumber : 0);
+    printf("Allocated in file %s on line %d\n", 
+           Site ? Site->Filename : "?", 
+           Site ? Site->LineNumber : 0);
+    mvm_debug_memory_stack *Stack = 
+        MVMGetStack(&GlobalDebugInfoList->StackTable, Entry->DebugInfo.StackID);
+    if(Stack)
+    {
+        MVMPlatformPrintStackFrames(Stack->Frames, Stack->FramesCount);
+    }
+}
+
+
+// NOTE(Marko): Reports a free() or realloc() of Address, which is still in 
+//              quarantine. 
+void MVMReportQuarantinedRelease(mvm_debug_memory_quarantine_entry *Entry, 
+                                 const char *Filename, 
+                                 int LineNumber)
+{
+    MVMAtomicAddU64(&GlobalDebugInfoList->UseAfterFreeErrorsCount, 1);
+    printf("Error while releasing address %p in file %s on line %d\n", 
+           Entry->DebugInfo.CurrentAddress, Filename, LineNumber);
+    printf("The %zu-byte block there has already been freed\n", 
+           Entry->DebugInfo.ByteCount);
+    MVMPrintFreedBlockSites(Entry);
+}
+
+
+// NOTE(Marko): Checks a block leaving the quarantine for writes since it was 
+//              freed, then really frees it. 
+void MVMReleaseQuarantineEntry(mvm_debug_memory_quarantine_entry *Entry)
+{
+    mvm_debug_memory_info *DebugInfo = &Entry->DebugInfo;
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+    {
+        // NOTE(Marko): Inaccessible while in quarantine; there is nothing to 
+        //              check, as any access would have faulted. 
+        size_t MappingBytes;
+        uint8_t *Mapping = MVMGetGuardPageMapping(DebugInfo, &MappingBytes);
+        MVMPlatformFreePages(Mapping, MappingBytes);
+        return;
+    }
+
+    size_t First = 0;
+    size_t Last = 0;
+    if(MVMFindFillDamage((uint8_t *)DebugInfo->CurrentAddress, 
+                         DebugInfo->ByteCount, 
+                         DEBUG_QUARANTINE_POISON, 
+                         &First, 
+                         &Last))
+    {
+        MVMAtomicAddU64(&GlobalDebugInfoList->UseAfterFreeErrorsCount, 1);
+        printf("Use after free detected\n");
+        printf("The %zu-byte block at %p was written at bytes %zu to %zu after it was freed\n", 
+               DebugInfo->ByteCount, DebugInfo->CurrentAddress, First, Last);
+        MVMPrintFreedBlockSites(Entry);
+    }
+
+    void *Memory = DebugInfo->CurrentAddress;
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_REDZONES)
+    {
+        Memory = MVMReleasePaddedBlock(DebugInfo, "<quarantine>", 0);
+    }
+    MVMFreeBlockMemory(Memory, DebugInfo->AlignmentLog2);
+}
+
+
+// NOTE(Marko): Lets the oldest blocks go until no more than MaxBytes are 
+//              held; 0 empties the quarantine. 
+void MVMEvictQuarantine(mvm_debug_memory_quarantine *Quarantine, 
+                        size_t MaxBytes)
+{
+    mvm_debug_memory_quarantine_entry Evicted[DEBUG_QUARANTINE_EVICT_BATCH];
+    uint32_t EvictedCount;
+    do
+    {
+        EvictedCount = 0;
+        MVMLockAcquire(&Quarantine->Lock);
+        while((Quarantine->Bytes > MaxBytes) && 
+              (EvictedCount < DEBUG_QUARANTINE_EVICT_BATCH))
+        {
+            mvm_debug_memory_quarantine_entry *Entry = 
+                Quarantine->Entries + Quarantine->FirstEntryIndex;
+            MVMQuarantineRemoveSlot(
+                Quarantine, 
+                MVMQuarantineFindSlot(Quarantine, 
+                                      Entry->DebugInfo.CurrentAddress));
+            Quarantine->Bytes -= MVMGetQuarantineCharge(&Entry->DebugInfo);
+            Quarantine->FirstEntryIndex = 
+                (Quarantine->FirstEntryIndex + 1) & 
+                (Quarantine->EntriesAllocated - 1);
+            Quarantine->EntriesCount--;
+            Evicted[EvictedCount++] = *Entry;
+        }
+        MVMLockRelease(&Quarantine->Lock);
+
+        for(uint32_t EvictedIndex = 0; 
+            EvictedIndex < EvictedCount; 
+            EvictedIndex++)
+        {
+            MVMReleaseQuarantineEntry(Evicted + EvictedIndex);
+        }
+    } while(EvictedCount == DEBUG_QUARANTINE_EVICT_BATCH);
+}
+
+
+// NOTE(Marko): Poisons a released block and queues it. Returns 0 if it is 
+//              larger than the whole quarantine; the caller then frees it as 
+//              usual. 
+int MVMQuarantineBlock(mvm_debug_memory_quarantine *Quarantine, 
+                       mvm_debug_memory_info *DebugInfo, 
+                       uint32_t FreeSiteID)
+{
+    size_t Charge = MVMGetQuarantineCharge(DebugInfo);
+    if(Charge > Quarantine->MaxBytes)
+    {
+        return(0);
+    }
+    mvm_debug_memory_quarantine_entry Entry;
+    Entry.DebugInfo = *DebugInfo;
+    Entry.FreeSiteID = FreeSiteID;
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+    {
+        size_t MappingBytes;
+        uint8_t *Mapping = MVMGetGuardPageMapping(DebugInfo, &MappingBytes);
+        if(!MVMPlatformProtectPages(Mapping, 
+                                    MappingBytes - GlobalDebugInfoList->PageSize))
+        {
+            return(0);
+        }
+    }
+    else
+    {
+        memset(DebugInfo->CurrentAddress, DEBUG_QUARANTINE_POISON, 
+               DebugInfo->ByteCount);
+    }
+
+    MVMLockAcquire(&Quarantine->Lock);
+    if((Quarantine->EntriesCount == Quarantine->EntriesAllocated) && 
+       !MVMQuarantineGrow(Quarantine))
+    {
+        // NOTE(Marko): No room to queue it; it leaves right away. 
+        MVMLockRelease(&Quarantine->Lock);
+        MVMReleaseQuarantineEntry(&Entry);
+        return(1);
+    }
+    size_t EntryIndex = 
+        (Quarantine->FirstEntryIndex + Quarantine->EntriesCount) & 
+        (Quarantine->EntriesAllocated - 1);
+    Quarantine->Entries[EntryIndex] = Entry;
+    Quarantine->EntriesCount++;
+    Quarantine->Bytes += Charge;
+    mvm_debug_memory_quarantine_slot *Slot = 
+        MVMQuarantineFindSlot(Quarantine, DebugInfo->CurrentAddress);
+    Slot->Address = DebugInfo->CurrentAddress;
+    Slot->EntryIndex = EntryIndex;
+    MVMLockRelease(&Quarantine->Lock);
+
+    MVMEvictQuarantine(Quarantine, Quarantine->MaxBytes);
+    return(1);
+}
+
+
+// NOTE(Marko): Finishes off a released block whose record has already been 
+//              taken out of the index: checks its padding, then either keeps 
+//              it in quarantine or returns the pointer to hand back to the C 
+//              library (0 if there is none). 
+void *MVMRetireBlock(mvm_debug_memory_info *DebugInfo, 
+                     uint32_t FreeSiteID, 
+                     const char *Filename, 
+                     int LineNumber)
+{
+    mvm_debug_memory_quarantine *Quarantine = GlobalDebugInfoList->Quarantine;
+    if(Quarantine)
+    {
+        if(DebugInfo->Flags & DEBUG_INFO_FLAG_PADDED)
+        {
+            MVMCheckPaddedBlock(DebugInfo, Filename, LineNumber);
+        }
+        if(MVMQuarantineBlock(Quarantine, DebugInfo, FreeSiteID))
+        {
+            return(0);
+        }
+    }
+    if(DebugInfo->Flags & DEBUG_INFO_FLAG_PADDED)
+    {
+        return(MVMReleasePaddedBlock(DebugInfo, Filename, LineNumber));
+    }
+    return(DebugInfo->CurrentAddress);
+}
+
+
+// NOTE(Marko): Whether released blocks have to be looked up even while the 
+//              tool is turned off: padded ones, and quarantined ones that a 
+//              second free() must not hand to the C library. 
+int MVMReleasesNeedLookup(void)
+{
+    return(MVMBlockPaddingEnabled() || 
+           (GlobalDebugInfoList && GlobalDebugInfoList->Quarantine));
+}
+
+
+// NOTE(Marko): The fault handler's fallback: an access to the pages of a 
+//              guarded block that has been freed but is still in quarantine. 
+void MVMReportQuarantineFault(uint8_t *FaultAddress)
+{
+    mvm_debug_memory_quarantine *Quarantine = GlobalDebugInfoList->Quarantine;
+    if(!Quarantine)
+    {
+        return;
+    }
+    mvm_debug_memory_quarantine_entry Hit;
+    int Found = 0;
+    MVMLockAcquire(&Quarantine->Lock);
+    for(size_t EntryIndex = 0; 
+        EntryIndex < Quarantine->EntriesCount; 
+        EntryIndex++)
+    {
+        mvm_debug_memory_quarantine_entry *Entry = 
+            Quarantine->Entries + 
+            ((Quarantine->FirstEntryIndex + EntryIndex) & 
+             (Quarantine->EntriesAllocated - 1));
+        if(Entry->DebugInfo.Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+        {
+            size_t MappingBytes;
+            uint8_t *Mapping = 
+                MVMGetGuardPageMapping(&Entry->DebugInfo, &MappingBytes);
+            if((FaultAddress >= Mapping) && 
+               (FaultAddress < Mapping + MappingBytes))
+            {
+                Hit = *Entry;
+                Found = 1;
+                break;
+            }
+        }
+    }
+    MVMLockRelease(&Quarantine->Lock);
+    if(!Found)
+    {
+        return;
+    }
+
+    void *Frames[DEBUG_STACK_MAX_DEPTH];
+    uint32_t FramesCount = 
+        MVMPlatformUnwindStack(Frames, DEBUG_STACK_MAX_DEPTH, 0);
+    printf("Use after free detected\n");
+    printf("Access at %p, %td bytes from the start of the freed %zu-byte block at %p\n", 
+           FaultAddress, 
+           FaultAddress - (uint8_t *)Hit.DebugInfo.CurrentAddress, 
+           Hit.DebugInfo.ByteCount, 
+           Hit.DebugInfo.CurrentAddress);
+    MVMPlatformPrintStackFrames(Frames, FramesCount);
+    MVMPrintFreedBlockSites(&Hit);
+    fflush(stdout);
+}
+
+
+// NOTE(Marko): Runs in the faulting thread on any access violation once 
+//              guard pages are in use. Only speaks up if Address is on the 
+//              guard page of a live block, or inside a quarantined one. 
+//              Finding that block means walking the whole live table, which 
+//              is fine for a process about to go down. Like every report 
+//              this uses printf(), which is not async-signal-safe; the access 
+//              that faulted is user code, not the tool, so no lock of ours 
+//              is held. 
+void MVMReportGuardPageFault(void *Address)
+{
+    mvm_debug_memory_list *List = GlobalDebugInfoList;
+    if(!List)
+    {
+        return;
+    }
+    uint8_t *FaultAddress = (uint8_t *)Address;
+    mvm_debug_memory_info Hit;
+    int Found = 0;
+    for(int ShardIndex = 0; 
+        !Found && (ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT); 
+        ShardIndex++)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            List->AddressTables + ShardIndex;
+        MVMLockAcquire(&AddressTable->Lock);
+        for(size_t SlotIndex = 0; 
+            SlotIndex < AddressTable->SlotsAllocated; 
+            SlotIndex++)
+        {
+            mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+            if(Slot->Flags & DEBUG_INFO_FLAG_GUARD_PAGE)
+            {
+                uint8_t *GuardPage = MVMGetGuardPage(Slot);
+                if((FaultAddress >= GuardPage) && 
+                   (FaultAddress < GuardPage + List->PageSize))
+                {
+                    Hit = *Slot;
+                    Found = 1;
+                    break;
+                }
+            }
+        }
+        MVMLockRelease(&AddressTable->Lock);
+    }
+    if(!Found)
+    {
+        MVMReportQuarantineFault(FaultAddress);
+        return;
+    }
+
+    void *Frames[DEBUG_STACK_MAX_DEPTH];
+    uint32_t FramesCount = 
+        MVMPlatformUnwindStack(Frames, DEBUG_STACK_MAX_DEPTH, 0);
+    printf("Guard page hit at %p, %zu bytes past the end of the %zu-byte block at %p\n", 
+           Address, 
+           (size_t)(FaultAddress - (uint8_t *)Hit.CurrentAddress) - 
+           Hit.ByteCount, 
+           Hit.ByteCount, 
+           Hit.CurrentAddress);
+    MVMPlatformPrintStackFrames(Frames, FramesCount);
+    mvm_debug_memory_site *Site = MVMGetCallSite(Hit.InitialSiteID);
+    printf("Allocated in file %s on line %d\n", 
+           Site ? Site->Filename : "?", 
+           Site ? Site->LineNumber : 0);
+    mvm_debug_memory_stack *Stack = 
+        MVMGetStack(&List->StackTable, Hit.StackID);
+    if(Stack)
+    {
+        MVMPlatformPrintStackFrames(Stack->Frames, Stack->FramesCount);
+    }
+    fflush(stdout);
+}
+
+
+volatile uint32_t GlobalDebugFaultHandlerInstalled = 0;
+
+void MVMInstallGuardPageFaultHandler(void)
+{
+    if((MVMAtomicCompareExchangeU32(&GlobalDebugFaultHandlerInstalled, 
+                                    0, 1) == 0) && 
+       !MVMPlatformInstallFaultHandler(MVMReportGuardPageFault))
+    {
+        printf("Unable to install the guard-page fault handler. Guard pages will still fault, but without a report.\n");
+    }
+}
+
+
+// NOTE(Marko): Checks up to DEBUG_REDZONE_SWEEP_BATCH slots of one shard, 
+//              starting at *SlotIndex, and reports the first damaged block 
+//              that has not been reported yet (after letting go of the lock; 
+//              printing stacks can allocate). Returns 1 once *SlotIndex has 
+//              reached the end of the shard. Holding the shard's lock keeps 
+//              every block in it from being freed while it is read. 
+int MVMSweepRedzones(mvm_debug_memory_list *List, 
+                     uint32_t ShardIndex, 
+                     size_t *SlotIndex, 
+                     uint64_t *DamagedCount)
+{
+    mvm_debug_memory_address_table *AddressTable = 
+        List->AddressTables + ShardIndex;
+    mvm_debug_memory_info Damaged;
+    size_t OverrunBytes = 0;
+    size_t UnderrunBytes = 0;
+    int FoundDamage = 0;
+
+    MVMLockAcquire(&AddressTable->Lock);
+    size_t EndSlotIndex = *SlotIndex + DEBUG_REDZONE_SWEEP_BATCH;
+    if(EndSlotIndex > AddressTable->SlotsAllocated)
+    {
+        EndSlotIndex = AddressTable->SlotsAllocated;
+    }
+    while(*SlotIndex < EndSlotIndex)
+    {
+        mvm_debug_memory_info *Slot = AddressTable->Slots + (*SlotIndex)++;
+        if((Slot->Flags & DEBUG_INFO_FLAG_PADDED) && 
+           !(Slot->Flags & DEBUG_INFO_FLAG_REDZONE_REPORTED) && 
+           !MVMCheckRedzones(Slot, &OverrunBytes, &UnderrunBytes))
+        {
+            Slot->Flags |= DEBUG_INFO_FLAG_REDZONE_REPORTED;
+            Damaged = *Slot;
+            FoundDamage = 1;
+            break;
+        }
+    }
+    int Result = (*SlotIndex >= AddressTable->SlotsAllocated);
+    MVMLockRelease(&AddressTable->Lock);
+
+    if(FoundDamage)
+    {
+        MVMReportRedzoneDamage(&Damaged, OverrunBytes, UnderrunBytes, 
+                               "<redzone sweep>", 0);
+        (*DamagedCount)++;
+    }
+    return(Result);
+}
+
+
+void MVMRedzoneSweeperThreadProc(void *Parameter)
+{
+    mvm_debug_memory_redzone_sweeper *Sweeper = 
+        (mvm_debug_memory_redzone_sweeper *)Parameter;
+    uint64_t DamagedCount = 0;
+    while(!MVMAtomicLoadU32(&Sweeper->StopRequested))
+    {
+        // NOTE(Marko): Stop at the budget, or after one full lap when the 
+        //              live set is small enough to finish early. 
+        uint64_t Deadline = 
+            MVMPlatformReadNanoseconds() + Sweeper->BudgetNanoseconds;
+        uint32_t ShardsFinished = 0;
+        do
+        {
+            if(MVMSweepRedzones(Sweeper->List, 
+                                Sweeper->ShardIndex, 
+                                &Sweeper->SlotIndex, 
+                                &DamagedCount))
+            {
+                Sweeper->SlotIndex = 0;
+                Sweeper->ShardIndex = 
+                    (Sweeper->ShardIndex + 1) % DEBUG_ADDRESS_TABLE_SHARD_COUNT;
+                if(++ShardsFinished == DEBUG_ADDRESS_TABLE_SHARD_COUNT)
+                {
+                    break;
+                }
+            }
+        } while(MVMPlatformReadNanoseconds() < Deadline);
+        MVMPlatformSleepMilliseconds(Sweeper->IntervalMilliseconds);
+    }
+}
+
+
+mvm_debug_memory_redzone_sweeper *
+MVMRedzoneSweeperStart(mvm_debug_memory_list *List, 
+                       uint32_t IntervalMilliseconds, 
+                       uint32_t BudgetMicroseconds)
+{
+    mvm_debug_memory_redzone_sweeper *Result = 
+        (mvm_debug_memory_redzone_sweeper *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                             sizeof *Result);
+    if(!Result)
+    {
+        printf("Debug arena allocation failed while creating the redzone sweeper.\n");
+        return(Result);
+    }
+    Result->List = List;
+    Result->IntervalMilliseconds = IntervalMilliseconds;
+    Result->BudgetNanoseconds = 1000ull * (BudgetMicroseconds ? 
+                                           BudgetMicroseconds : 
+                                           DEBUG_REDZONE_SWEEP_BUDGET_US);
+    if(!MVMPlatformCreateThread(&Result->Thread, 
+                                MVMRedzoneSweeperThreadProc, 
+                                Result))
+    {
+        printf("Unable to start the redzone sweeper thread.\n");
+        MVMArenaFree(&GlobalDebugArena, Result, sizeof *Result);
+        return(0);
+    }
+    return(Result);
+}
+
+
+void MVMRedzoneSweeperStop(mvm_debug_memory_redzone_sweeper *Sweeper)
+{
+    MVMAtomicStoreU32(&Sweeper->StopRequested, 1);
+    MVMPlatformJoinThread(&Sweeper->Thread);
+}
+
+
+mvm_debug_memory_list *MVMCreateDebugInfoList(mvm_debug_memory_config *Config)
+{
+    mvm_debug_memory_list *Result = 
+        (mvm_debug_memory_list *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                  (sizeof *Result));
+    if(!Result)
+    {
+        printf("Debug arena allocation failed when attempting to initially allocate the global mvm_debug_memory_list\n");
+        return(Result);
+    }
+
+    uint64_t EventRingCapacity = Config->MaxEventsCount;
+    uint64_t MaxEventBytesCount = 
+        Config->MaxEventBytes / sizeof(mvm_debug_memory_event);
+    if(Config->MaxEventBytes && 
+       (!EventRingCapacity || (MaxEventBytesCount < EventRingCapacity)))
+    {
+        EventRingCapacity = MaxEventBytesCount;
+    }
+    if((Config->MaxEventsCount || Config->MaxEventBytes) && 
+       !Config->TraceFilename)
+    {
+        EventRingCapacity -= EventRingCapacity % DEBUG_EVENT_BLOCK_SIZE;
+        if(EventRingCapacity < 
+           (uint64_t)DEBUG_EVENT_RING_MIN_BLOCKS*DEBUG_EVENT_BLOCK_SIZE)
+        {
+            EventRingCapacity = 
+                (uint64_t)DEBUG_EVENT_RING_MIN_BLOCKS*DEBUG_EVENT_BLOCK_SIZE;
+        }
+
+        // NOTE(Marko): The last chunk only needs to cover the end of the ring. 
+        uint64_t EventsLeft = EventRingCapacity;
+        while(EventsLeft)
+        {
+            size_t ChunkEventsCount = (EventsLeft < DEBUG_EVENT_CHUNK_SIZE) ? 
+                (size_t)EventsLeft : DEBUG_EVENT_CHUNK_SIZE;
+            mvm_debug_memory_event *Chunk = 
+                (mvm_debug_memory_event *)MVMArenaAllocate(
+                    &GlobalDebugArena, 
+                    (sizeof *Chunk) * ChunkEventsCount);
+            if(!Chunk || !MVMAddEventChunk(Result, Chunk))
+            {
+                if(Chunk)
+                {
+                    MVMArenaFree(&GlobalDebugArena, 
+                                 Chunk, 
+                                 (sizeof *Chunk) * ChunkEventsCount);
+                }
+                printf("Debug arena allocation failed while allocating the event ring.\n");
+                // NOTE(Marko): Fall back to a ring of the chunks we did get. 
+                EventRingCapacity -= EventsLeft;
+                break;
+            }
+            EventsLeft -= ChunkEventsCount;
+        }
+        if(!EventRingCapacity)
+        {
+            MVMArenaFree(&GlobalDebugArena, Result, sizeof *Result);
+            return(0);
+        }
+        Result->RingBlockOwners = (volatile uint64_t *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *Result->RingBlockOwners) * 
+            (size_t)(EventRingCapacity / DEBUG_EVENT_BLOCK_SIZE));
+        if(!Result->RingBlockOwners)
+        {
+            printf("Debug arena allocation failed while allocating the event ring.\n");
+            MVMArenaFree(&GlobalDebugArena, Result, sizeof *Result);
+            return(0);
+        }
+        Result->EventRingCapacity = EventRingCapacity;
+    }
+    // NOTE(Marko): A padded block that went unsampled could not be told apart 
+    //              from an unpadded one when it is freed, and an unsampled 
+    //              block could not be quarantined. 
+    Result->RedzoneBytes = 
+        (Config->RedzoneBytes + DEBUG_REDZONE_ALIGNMENT - 1) & 
+        ~(size_t)(DEBUG_REDZONE_ALIGNMENT - 1);
+    Result->SampleIntervalBytes = 
+        (Result->RedzoneBytes || Config->QuarantineBytes) ? 
+        0 : Config->SampleIntervalBytes;
+    Result->PageSize = MVMPlatformGetPageSize();
+    Result->GuardPagesMinBytes = Config->GuardPagesMinBytes;
+    Result->GuardPagesMaxBytes = Config->GuardPagesMaxBytes;
+    if(Result->GuardPagesMaxBytes)
+    {
+        MVMInstallGuardPageFaultHandler();
+    }
+    if(Config->QuarantineBytes)
+    {
+        Result->Quarantine = (mvm_debug_memory_quarantine *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            sizeof *Result->Quarantine);
+        if(Result->Quarantine)
+        {
+            Result->Quarantine->MaxBytes = Config->QuarantineBytes;
+        }
+        else
+        {
+            printf("Debug arena allocation failed while allocating the quarantine. Freed blocks will not be quarantined.\n");
+        }
+    }
+    Result->ReportUntrackedPointers = 
+        !Result->SampleIntervalBytes && !Config->IgnoreUntrackedPointers;
+    Result->StackDepth = (Config->StackDepth > DEBUG_STACK_MAX_DEPTH) ? 
+        DEBUG_STACK_MAX_DEPTH : Config->StackDepth;
+    Result->StackUseUnwinder = Config->StackUseUnwinder;
+    if(Config->TimelineResolutionMicroseconds)
+    {
+        Result->Timeline = (mvm_debug_memory_timeline *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            sizeof *Result->Timeline);
+        if(Result->Timeline)
+        {
+            mvm_debug_memory_timeline *Timeline = Result->Timeline;
+            uint64_t CalibrationTimestamp;
+            uint64_t CalibrationNanoseconds;
+            Timeline->TimestampFrequency = 
+                MVMCalibrateTimestampFrequency(&CalibrationTimestamp, 
+                                               &CalibrationNanoseconds);
+            Timeline->StartTimestamp = MVMReadTimestamp();
+            Timeline->IntervalTicks = 
+                (uint64_t)((double)Timeline->TimestampFrequency * 
+                           (double)Config->TimelineResolutionMicroseconds * 
+                           1e-6);
+            if(!Timeline->IntervalTicks)
+            {
+                Timeline->IntervalTicks = 1;
+            }
+        }
+        else
+        {
+            printf("Debug arena allocation failed while allocating the live-bytes timeline.\n");
+        }
+    }
+    Result->CreationTimestamp = MVMReadTimestamp();
+    Result->CreationNanoseconds = MVMPlatformReadNanoseconds();
+    if(Config->TraceFilename)
+    {
+        // NOTE(Marko): Keep going without the trace if it cannot be opened. 
+        Result->TraceWriter = MVMTraceWriterOpen(Config->TraceFilename, 
+                                                 &Result->SiteTable, 
+                                                 Result->SampleIntervalBytes);
+    }
+    if(Result->RedzoneBytes && Config->RedzoneSweepIntervalMilliseconds)
+    {
+        // NOTE(Marko): Keep going without the sweep if it cannot be started; 
+        //              frees and reallocs still check. 
+        Result->RedzoneSweeper = 
+            MVMRedzoneSweeperStart(Result, 
+                                   Config->RedzoneSweepIntervalMilliseconds, 
+                                   Config->RedzoneSweepBudgetMicroseconds);
+    }
+    return(Result);
+}
+
+
+void MVMDebugMemoryLeakCheckAtExit(void);
+
+// NOTE(Marko): atexit() handlers cannot be unregistered, so register ours at 
+//              most once and let it read whatever configuration is current. 
+int GlobalDebugLeakCheckRegistered = 0;
+
+// NOTE(Marko): Optional. Must come before the first MVMTurnOnDebugInfo(), or 
+//              after MVMDebugMemoryShutdown(); returns 0 otherwise. 
+int MVMDebugMemoryInitialize(mvm_debug_memory_config *Config)
+{
+    int Result = 0;
+    MVMLockAcquire(&GlobalDebugInfoListInitLock);
+    if(GlobalDebugInfoList)
+    {
+        printf("MVMDebugMemoryInitialize() called after the debug info list was already created.\n");
+    }
+    else
+    {
+        GlobalDebugConfig = *Config;
+        GlobalDebugInfoList = MVMCreateDebugInfoList(&GlobalDebugConfig);
+        Result = (GlobalDebugInfoList != 0);
+        if(Config->ReportLeaksAtExit && !GlobalDebugLeakCheckRegistered)
+        {
+            GlobalDebugLeakCheckRegistered = 
+                (atexit(MVMDebugMemoryLeakCheckAtExit) == 0);
+        }
+    }
+    MVMLockRelease(&GlobalDebugInfoListInitLock);
+    return(Result);
+}
+
+
+void MVMTurnOnDebugInfo(const char *Filename,
+                        int LineNumber)
+{
+    
+    if(!GlobalDebugInfoList)
+    {
+        MVMLockAcquire(&GlobalDebugInfoListInitLock);
+        if(!GlobalDebugInfoList)
+        {
+            // NOTE(Marko): If GlobalDebugInfo hasn't been initialized yet, 
+            //              initialize it with whatever configuration was 
+            //              last passed in. 
+            GlobalDebugInfoList = MVMCreateDebugInfoList(&GlobalDebugConfig);
+        }
+        MVMLockRelease(&GlobalDebugInfoListInitLock);
+        if(!GlobalDebugInfoList)
+        {
+            return;
+        }
+    }
+
+    mvm_debug_memory_thread_state *ThreadState = MVMGetThreadState();
+    if(!ThreadState)
+    {
+        return;
+    }
+
+    MVMLockAcquire(&GlobalDebugInfoList->Lock);
+    GlobalDebugInfoList->TurnOnCount++;        
+    GlobalDebugInfoList->ScopeIndex++;
+    MVMLockRelease(&GlobalDebugInfoList->Lock);
+
+    // NOTE(Marko): Add this turn on call to the event log. 
+    MVMAppendEvent(ThreadState, 
+                   MemoryOperationType_TurnOn, 
+                   MVMLookupCallSite(ThreadState, Filename, LineNumber),
+                   0, 
+                   0, 
+                   DEBUG_EVENT_INDEX_NONE);
+}
+
+
+
+void MVMTurnOffDebugInfo(const char *Filename,
+                         int LineNumber)
+{
+    if(GlobalDebugInfoList)
+    {
+        int WasTurnedOn = 0;
+        MVMLockAcquire(&GlobalDebugInfoList->Lock);
+        if(GlobalDebugInfoList->TurnOnCount > 0)
+        {
+            GlobalDebugInfoList->TurnOnCount--;
+            GlobalDebugInfoList->ScopeIndex++;
+            WasTurnedOn = 1;
+        }
+        MVMLockRelease(&GlobalDebugInfoList->Lock);
+
+        mvm_debug_memory_thread_state *ThreadState = MVMGetThreadState();
+        if(WasTurnedOn && ThreadState)
+        {
+            // NOTE(Marko): Add this turn off call to the event log. 
+            MVMAppendEvent(ThreadState, 
+                           MemoryOperationType_TurnOff, 
+                           MVMLookupCallSite(ThreadState, Filename, LineNumber),
+                           0, 
+                           0, 
+                           DEBUG_EVENT_INDEX_NONE);
+
+            // NOTE(Marko): Hand this thread's partial block to the trace so 
+            //              the region just closed reaches the file with the 
+            //              next flush. 
+            if(GlobalDebugInfoList->TraceWriter)
+            {
+                MVMTraceSubmitThreadEvents(GlobalDebugInfoList->TraceWriter, 
+                                           ThreadState);
+            }
+        }
+        else if(!WasTurnedOn)
+        {
+            printf("TurnOffDebugInfo() called without corresponding TurnOnDebugInfo()\n");
+            printf("TurnOffDebugInfo called in %s at line %d\n", 
+                   Filename, 
+                   LineNumber);
+        }
+    }
+    else
+    {
+        printf("TurnOffDebugInfo() called before ever calling TurnOnDebugInfo()\n");
+        printf("TurnOffDebugInfo called in %s at line %d\n", 
+               Filename, 
+               LineNumber);
+    }
+}
+
+
+
+uint64_t MVMGetSiteReportMetric(mvm_debug_memory_site_report *Report, 
+                                site_stat_metric Metric)
+{
+    uint64_t Result = 0;
+    switch(Metric)
+    {
+        case SiteStatMetric_AllocationsCount: Result = Report->AllocationsCount; break;
+        case SiteStatMetric_ReallocationsCount: Result = Report->ReallocationsCount; break;
+        case SiteStatMetric_FreesCount: Result = Report->FreesCount; break;
+        case SiteStatMetric_TotalBytes: Result = Report->TotalBytes; break;
+        case SiteStatMetric_LiveBytes: Result = Report->LiveBytes; break;
+        case SiteStatMetric_PeakLiveBytes: Result = Report->PeakLiveBytes; break;
+    }
+    return(Result);
+}
+
+
+void MVMSiteReportSiftDown(mvm_debug_memory_site_report *Reports, 
+                           size_t ReportsCount, 
+                           size_t ReportIndex, 
+                           site_stat_metric Metric)
+{
+    // NOTE(Marko): Min-heap on Metric, so Reports[0] is the weakest of the 
+    //              current top N. 
+    for(;;)
+    {
+        size_t Smallest = ReportIndex;
+        size_t Left = 2*ReportIndex + 1;
+        size_t Right = Left + 1;
+        if((Left < ReportsCount) && 
+           (MVMGetSiteReportMetric(Reports + Left, Metric) < 
+            MVMGetSiteReportMetric(Reports + Smallest, Metric)))
+        {
+            Smallest = Left;
+        }
+        if((Right < ReportsCount) && 
+           (MVMGetSiteReportMetric(Reports + Right, Metric) < 
+            MVMGetSiteReportMetric(Reports + Smallest, Metric)))
+        {
+            Smallest = Right;
+        }
+        if(Smallest == ReportIndex)
+        {
+            break;
+        }
+        mvm_debug_memory_site_report Temp = Reports[ReportIndex];
+        Reports[ReportIndex] = Reports[Smallest];
+        Reports[Smallest] = Temp;
+        ReportIndex = Smallest;
+    }
+}
+
+
+// NOTE(Marko): Fills Reports with up to MaxReports sites that have the 
+//              largest non-zero Metric, largest first, and returns how many 
+//              it filled. Reads the running totals only; cost is linear in 
+//              the number of call sites, not in the number of events. 
+size_t MVMDebugMemoryGetTopSites(site_stat_metric Metric, 
+                                 mvm_debug_memory_site_report *Reports, 
+                                 size_t MaxReports)
+{
+    size_t ReportsCount = 0;
+    if(!GlobalDebugInfoList || !MaxReports)
+    {
+        return(ReportsCount);
+    }
+
+    mvm_debug_memory_site_table *SiteTable = &GlobalDebugInfoList->SiteTable;
+    MVMLockAcquire(&SiteTable->Lock);
+    for(uint32_t SiteID = 0; SiteID < SiteTable->SitesCount; SiteID++)
+    {
+        mvm_debug_memory_site_stats *Stats = MVMGetSiteStats(SiteTable, SiteID);
+        if(!Stats)
+        {
+            continue;
+        }
+        mvm_debug_memory_site_report Report;
+        mvm_debug_memory_site *Site = MVMGetSite(SiteTable, SiteID);
+        Report.Filename = Site->Filename;
+        Report.LineNumber = Site->LineNumber;
+        Report.SiteID = SiteID;
+        Report.AllocationsCount = MVMAtomicLoadU64(&Stats->AllocationsCount);
+        Report.ReallocationsCount = MVMAtomicLoadU64(&Stats->ReallocationsCount);
+        Report.FreesCount = MVMAtomicLoadU64(&Stats->FreesCount);
+        Report.TotalBytes = MVMAtomicLoadU64(&Stats->TotalBytes);
+        Report.LiveBytes = MVMAtomicLoadU64(&Stats->LiveBytes);
+        Report.PeakLiveBytes = MVMAtomicLoadU64(&Stats->PeakLiveBytes);
+        Report.TotalUsableBytes = MVMAtomicLoadU64(&Stats->TotalUsableBytes);
+
+        uint64_t Value = MVMGetSiteReportMetric(&Report, Metric);
+        if(!Value)
+        {
+            continue;
+        }
+        if(ReportsCount < MaxReports)
+        {
+            // NOTE(Marko): Sift the new entry up. 
+            size_t ReportIndex = ReportsCount++;
+            Reports[ReportIndex] = Report;
+            while(ReportIndex)
+            {
+                size_t ParentIndex = (ReportIndex - 1) / 2;
+                if(MVMGetSiteReportMetric(Reports + ParentIndex, Metric) <= Value)
+                {
+                    break;
+                }
+                Reports[ReportIndex] = Reports[ParentIndex];
+                Reports[ParentIndex] = Report;
+                ReportIndex = ParentIndex;
+            }
+        }
+        else if(Value > MVMGetSiteReportMetric(Reports, Metric))
+        {
+            Reports[0] = Report;
+            MVMSiteReportSiftDown(Reports, ReportsCount, 0, Metric);
+        }
+    }
+    MVMLockRelease(&SiteTable->Lock);
+
+    // NOTE(Marko): Heap-sort in place: repeatedly move the smallest to the 
+    //              back, which leaves the array largest first. 
+    for(size_t HeapCount = ReportsCount; HeapCount > 1; HeapCount--)
+    {
+        mvm_debug_memory_site_report Temp = Reports[0];
+        Reports[0] = Reports[HeapCount - 1];
+        Reports[HeapCount - 1] = Temp;
+        MVMSiteReportSiftDown(Reports, HeapCount - 1, 0, Metric);
+    }
+    return(ReportsCount);
+}
+
+
+void MVMTimelineRecord(mvm_debug_memory_timeline *Timeline, uint64_t LiveBytes)
+{
+    uint64_t Now = MVMReadTimestamp();
+    uint64_t Elapsed = (Now > Timeline->StartTimestamp) ? 
+        (Now - Timeline->StartTimestamp) : 0;
+    for(;;)
+    {
+        uint64_t IntervalTicks = MVMAtomicLoadU64(&Timeline->IntervalTicks);
+        uint64_t SampleIndex = Elapsed / IntervalTicks;
+        if(SampleIndex < DEBUG_TIMELINE_SAMPLES_COUNT)
+        {
+            MVMAtomicMaxU64(Timeline->Samples + SampleIndex, LiveBytes + 1);
+            MVMAtomicMaxU64(&Timeline->LastSampleIndex, SampleIndex);
+            break;
+        }
+
+        // NOTE(Marko): Out of room: halve the resolution. A thread still 
+        //              recording into the old layout can land one sample off; 
+        //              that is within the resolution being given up anyway. 
+        MVMLockAcquire(&Timeline->Lock);
+        if(MVMAtomicLoadU64(&Timeline->IntervalTicks) == IntervalTicks)
+        {
+            for(size_t SampleIndex = 0; 
+                SampleIndex < DEBUG_TIMELINE_SAMPLES_COUNT; 
+                SampleIndex++)
+            {
+                uint64_t Merged = 0;
+                if(SampleIndex < DEBUG_TIMELINE_SAMPLES_COUNT / 2)
+                {
+                    uint64_t First = 
+                        MVMAtomicLoadU64(Timeline->Samples + 2*SampleIndex);
+                    uint64_t Second = 
+                        MVMAtomicLoadU64(Timeline->Samples + 2*SampleIndex + 1);
+                    Merged = (First > Second) ? First : Second;
+                }
+                MVMAtomicStoreU64(Timeline->Samples + SampleIndex, Merged);
+            }
+            MVMAtomicStoreU64(&Timeline->LastSampleIndex, 
+                              MVMAtomicLoadU64(&Timeline->LastSampleIndex) / 2);
+            MVMAtomicStoreU64(&Timeline->IntervalTicks, IntervalTicks*2);
+        }
+        MVMLockRelease(&Timeline->Lock);
+    }
+}
+
+
+// NOTE(Marko): Applies a change in live bytes to the running total, the peak, 
+//              the peak snapshot and the timeline. 
+void MVMRecordLiveBytesChange(int64_t ByteCountChange)
+{
+    uint64_t LiveBytes = 
+        MVMAtomicAddU64(&GlobalDebugInfoList->LiveBytes, 
+                        (uint64_t)ByteCountChange) + 
+        (uint64_t)ByteCountChange;
+
+    if((ByteCountChange > 0) && 
+       MVMAtomicMaxU64(&GlobalDebugInfoList->PeakLiveBytes, LiveBytes) && 
+       (LiveBytes >= 
+        MVMAtomicLoadU64(&GlobalDebugInfoList->NextPeakSnapshotBytes)) && 
+       MVMLockTryAcquire(&GlobalDebugInfoList->PeakSnapshotLock))
+    {
+        // NOTE(Marko): If another thread is already taking a snapshot, 
+        //              skip this one; the next climb will catch up. 
+        mvm_debug_memory_peak_snapshot *Snapshot = 
+            &GlobalDebugInfoList->PeakSnapshot;
+        Snapshot->LiveBytes = LiveBytes;
+        Snapshot->Timestamp = MVMReadTimestamp();
+        Snapshot->SitesCount = 
+            MVMDebugMemoryGetTopSites(SiteStatMetric_LiveBytes, 
+                                      Snapshot->Sites, 
+                                      DEBUG_PEAK_SNAPSHOT_SITES_COUNT);
+
+        uint64_t Growth = LiveBytes >> DEBUG_PEAK_SNAPSHOT_GROWTH_SHIFT;
+        if(Growth < DEBUG_PEAK_SNAPSHOT_MIN_GROWTH)
+        {
+            Growth = DEBUG_PEAK_SNAPSHOT_MIN_GROWTH;
+        }
+        MVMAtomicStoreU64(&GlobalDebugInfoList->NextPeakSnapshotBytes, 
+                          LiveBytes + Growth);
+        MVMLockRelease(&GlobalDebugInfoList->PeakSnapshotLock);
+    }
+
+    if(GlobalDebugInfoList->Timeline)
+    {
+        MVMTimelineRecord(GlobalDebugInfoList->Timeline, LiveBytes);
+    }
+}
+
+
+// NOTE(Marko): Returns the probability with which this allocation was picked, 
+//              or 0 if it is not to be tracked. 
+float MVMSampleAllocation(mvm_debug_memory_thread_state *ThreadState, 
+                          size_t MemorySize)
+{
+    float Result = 1.0f;
+    if(GlobalDebugInfoList->SampleIntervalBytes)
+    {
+        ThreadState->BytesUntilSample -= (int64_t)MemorySize;
+        if(ThreadState->BytesUntilSample > 0)
+        {
+            Result = 0.0f;
+        }
+        else
+        {
+            // NOTE(Marko): Any further sample points inside this block are 
+            //              ignored. The process is memoryless, so restarting 
+            //              the countdown at the end of the block is exact. 
+            ThreadState->BytesUntilSample = MVMDrawSampleInterval(ThreadState);
+            Result = (float)(1.0 - 
+                             exp(-(double)MemorySize / 
+                                 (double)GlobalDebugInfoList->SampleIntervalBytes));
+            if(Result <= 0.0f)
+            {
+                // NOTE(Marko): Only reachable for 0-byte blocks. 
+                Result = FLT_MIN;
+            }
+        }
+    }
+    return(Result);
+}
+
+
+uint32_t MVMSaturateSlackBytes(size_t SlackBytes)
+{
+    return((SlackBytes > UINT32_MAX) ? UINT32_MAX : (uint32_t)SlackBytes);
+}
+
+
+// NOTE(Marko): Which padding a block of MemorySize bytes allocated at 
+//              Filename:LineNumber gets: DEBUG_INFO_FLAG_GUARD_PAGE, 
+//              DEBUG_INFO_FLAG_REDZONES or 0. Only blocks the tool is 
+//              recording are padded. 
+uint8_t MVMChooseBlockPadding(size_t MemorySize, 
+                              size_t Alignment, 
+                              const char *Filename, 
+                              int LineNumber)
+{
+    uint8_t Result = 0;
+    mvm_debug_memory_thread_state *ThreadState = 0;
+    if(MVMBlockPaddingEnabled() && MVMDebugInfoIsTurnedOn() && 
+       (ThreadState = MVMGetThreadState()))
+    {
+        mvm_debug_memory_list *List = GlobalDebugInfoList;
+        if(Alignment <= List->PageSize)
+        {
+            if(List->GuardPagesMaxBytes && 
+               (MemorySize >= List->GuardPagesMinBytes) && 
+               (MemorySize <= List->GuardPagesMaxBytes))
+            {
+                Result = DEBUG_INFO_FLAG_GUARD_PAGE;
+            }
+            else if(MVMAtomicLoadU64(&List->GuardedSitesCount))
+            {
+                mvm_debug_memory_site_stats *SiteStats = 
+                    MVMGetSiteStats(&List->SiteTable, 
+                                    MVMLookupCallSite(ThreadState, 
+                                                      Filename, 
+                                                      LineNumber));
+                if(SiteStats && MVMAtomicLoadU32(&SiteStats->GuardPages))
+                {
+                    Result = DEBUG_INFO_FLAG_GUARD_PAGE;
+                }
+            }
+        }
+        if(!Result && List->RedzoneBytes)
+        {
+            Result = DEBUG_INFO_FLAG_REDZONES;
+        }
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Maps pages for a guarded block and returns the block, placed 
+//              so that its size rounded up to its alignment ends where the 
+//              guard page begins. Returns 0 if the pages could not be had. 
+//              Fresh pages are zeroed already. 
+uint8_t *MVMAllocateGuardedBlock(size_t MemorySize, size_t Alignment)
+{
+    size_t PageSize = GlobalDebugInfoList->PageSize;
+    size_t BlockAlignment = MVMGetGuardPageBlockAlignment(Alignment);
+    if(MemorySize > SIZE_MAX - 2*PageSize - BlockAlignment)
+    {
+        return(0);
+    }
+    size_t DataBytes = (MemorySize + BlockAlignment - 1) & ~(BlockAlignment - 1);
+    size_t DataPagesBytes = (DataBytes + PageSize - 1) & ~(PageSize - 1);
+    uint8_t *Mapping = 
+        (uint8_t *)MVMPlatformAllocatePages(DataPagesBytes + PageSize);
+    if(!Mapping)
+    {
+        return(0);
+    }
+    if(!MVMPlatformProtectPages(Mapping + DataPagesBytes, PageSize))
+    {
+        MVMPlatformFreePages(Mapping, DataPagesBytes + PageSize);
+        return(0);
+    }
+    uint8_t *Result = Mapping + DataPagesBytes - DataBytes;
+    memset(Mapping, DEBUG_REDZONE_CANARY, (size_t)(Result - Mapping));
+    memset(Result + MemorySize, DEBUG_REDZONE_CANARY, DataBytes - MemorySize);
+    return(Result);
+}
+
+
+// NOTE(Marko): Gets a block for a wrapper to hand out: MemorySize bytes, 
+//              zeroed if Zeroed is set, aligned if Alignment is (never both). 
+//              Blocks the tool is recording may be padded (see 
+//              MVMChooseBlockPadding()); *BlockFlags says how, and the 
+//              wrapper passes it on to MVMTrackAllocation(). 
+void *MVMAllocateBlock(size_t MemorySize, 
+                       size_t Alignment, 
+                       int Zeroed, 
+                       const char *Filename, 
+                       int LineNumber, 
+                       uint8_t *BlockFlags)
+{
+    *BlockFlags = 
+        MVMChooseBlockPadding(MemorySize, Alignment, Filename, LineNumber);
+    if(*BlockFlags == DEBUG_INFO_FLAG_GUARD_PAGE)
+    {
+        uint8_t *GuardedBlock = MVMAllocateGuardedBlock(MemorySize, Alignment);
+        if(GuardedBlock)
+        {
+            return(GuardedBlock);
+        }
+        *BlockFlags = GlobalDebugInfoList->RedzoneBytes ? 
+            DEBUG_INFO_FLAG_REDZONES : 0;
+    }
+
+    size_t FrontBytes = 0;
+    size_t BackBytes = 0;
+    if(*BlockFlags == DEBUG_INFO_FLAG_REDZONES)
+    {
+        BackBytes = GlobalDebugInfoList->RedzoneBytes;
+        FrontBytes = (Alignment > BackBytes) ? Alignment : BackBytes;
+        if(MemorySize > SIZE_MAX - FrontBytes - BackBytes)
+        {
+            // NOTE(Marko): Leave a request this large for the C library to 
+            //              turn down. 
+            FrontBytes = 0;
+            BackBytes = 0;
+        }
+    }
+
+    size_t AllocationSize = MemorySize + FrontBytes + BackBytes;
+    uint8_t *Result = 0;
+    if(Alignment)
+    {
+#if defined(_WIN32)
+        Result = (uint8_t *)MVM_DEBUG_REAL_ALIGNED_MALLOC(AllocationSize, 
+                                                          Alignment);
+#else
+        // NOTE(Marko): posix_memalign() also wants a multiple of 
+        //              sizeof(void *), which aligned_alloc() and aligned new 
+        //              do not; any smaller power of two is met by rounding up. 
+        int Error = MVM_DEBUG_REAL_POSIX_MEMALIGN((void **)&Result, 
+                                                  (Alignment < sizeof(void *)) ? 
+                                                  sizeof(void *) : Alignment, 
+                                                  AllocationSize);
+        if(Error)
+        {
+            errno = Error;
+            Result = 0;
+        }
+#endif
+    }
+    else if(Zeroed)
+    {
+        Result = (uint8_t *)MVM_DEBUG_REAL_CALLOC(1, AllocationSize);
+    }
+    else
+    {
+        Result = (uint8_t *)MVM_DEBUG_REAL_MALLOC(AllocationSize);
+    }
+
+    if(Result && FrontBytes)
+    {
+        memset(Result, DEBUG_REDZONE_CANARY, FrontBytes);
+        memset(Result + FrontBytes + MemorySize, DEBUG_REDZONE_CANARY, BackBytes);
+        Result += FrontBytes;
+    }
+    else
+    {
+        *BlockFlags = 0;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Records Result, a block the caller has just allocated, as a 
+//              new allocation. Shared by every wrapper that hands out fresh 
+//              memory; ToolFrames counts the wrappers between the user's code 
+//              and here, for the stack capture. Alignment is 0 unless the 
+//              block was asked for with a specific one. A padded block 
+//              (BlockFlags, from MVMAllocateBlock()) is recorded even if the 
+//              tool was turned off in the meantime, as its release depends on 
+//              the record. 
+MVM_DEBUG_NOINLINE 
+void MVMTrackAllocation(void *Result, 
+                        size_t MemorySize, 
+                        size_t Alignment, 
+                        allocation_kind Kind, 
+                        uint8_t BlockFlags, 
+                        const char *Filename, 
+                        int LineNumber, 
+                        uint32_t ToolFrames)
+{
+    // TODO(Marko): and else-if clauses that examine which thing in particular 
+    //              failed: did malloc() fail, or was the GlobalDebugInfoList 
+    //              not initialized, or was it not yet turned on? 
+    mvm_debug_memory_thread_state *ThreadState = 0;
+    float SampleProbability = 0.0f;
+    if(Result && (BlockFlags || MVMDebugInfoIsTurnedOn()) && 
+       (ThreadState = MVMGetThreadState()) && 
+       (((SampleProbability = MVMSampleAllocation(ThreadState, MemorySize)) > 
+         0.0f) || BlockFlags))
+    {
+        // NOTE(Marko): Only commit information to the debug information list 
+        //              if 
+        //              1) malloc() succeeded 
+        //              2) GlobalDebugInfoList has been initialized 
+        //              3) the debug memory tool has been turned on. 
+        //              4) the sampler (if any) picked this allocation. 
+
+        // NOTE(Marko): malloc() is supposed to be associated with an 
+        //              *initial* allocation, so this starts a new chain in 
+        //              the event log and a new live record. 
+        mvm_debug_memory_info DebugInfo = {0};
+        DebugInfo.CurrentAddress = Result;
+        DebugInfo.InitialAddress = Result;
+        DebugInfo.ByteCount = MemorySize;
+        DebugInfo.InitialSiteID = 
+            MVMLookupCallSite(ThreadState, Filename, LineNumber);
+        DebugInfo.DebugInfoOpCount = 1;
+        DebugInfo.SampleProbability = BlockFlags ? 1.0f : SampleProbability;
+        DebugInfo.AlignmentLog2 = MVMAlignmentLog2(Alignment);
+        DebugInfo.AllocationKind = (uint8_t)Kind;
+        DebugInfo.Flags = BlockFlags;
+
+        // NOTE(Marko): A padded block is not a pointer the C library can be 
+        //              asked about; its slack is the padding. 
+        size_t UsableSize = BlockFlags ? 
+            MemorySize : MVMPlatformUsableSize(Result, Alignment);
+        if(UsableSize < MemorySize)
+        {
+            UsableSize = MemorySize;
+        }
+        DebugInfo.SlackBytes = MVMSaturateSlackBytes(UsableSize - MemorySize);
+        DebugInfo.AllocationTimestamp = MVMReadTimestamp();
+        DebugInfo.AllocationThreadIndex = ThreadState->ThreadIndex;
+        DebugInfo.AllocationScopeIndex = GlobalDebugInfoList->ScopeIndex;
+        if(GlobalDebugInfoList->StackDepth)
+        {
+            DebugInfo.StackID = MVMCaptureStackID(ThreadState, ToolFrames + 1);
+        }
+        DebugInfo.LastEventIndex = 
+            MVMAppendEvent(ThreadState, 
+                           MemoryOperationType_InitialAllocation, 
+                           DebugInfo.InitialSiteID, 
+                           Result, 
+                           MemorySize, 
+                           DEBUG_EVENT_INDEX_NONE);
+
+        MVMInsertDebugInfo(&DebugInfo);
+
+        mvm_debug_memory_site_stats *SiteStats = 
+            MVMGetSiteStats(&GlobalDebugInfoList->SiteTable, 
+                            DebugInfo.InitialSiteID);
+        if(SiteStats)
+        {
+            MVMAtomicAddU64(&SiteStats->AllocationsCount, 1);
+            MVMAtomicAddU64(&SiteStats->TotalBytes, MemorySize);
+            MVMAtomicAddU64(&SiteStats->TotalUsableBytes, UsableSize);
+            MVMSiteStatsChangeLiveBytes(SiteStats, (int64_t)MemorySize);
+        }
+        mvm_debug_memory_size_histogram *Histogram = 
+            MVMGetSizeHistogram(&GlobalDebugInfoList->SiteTable, 
+                                DebugInfo.InitialSiteID);
+        if(Histogram)
+        {
+            MVMRecordRequestedSize(Histogram, MemorySize, 
+                                   UsableSize - MemorySize);
+        }
+        MVMRecordLiveBytesChange((int64_t)MemorySize);
+    }
+}
+
+
+const char *MVMGetAllocationKindName(allocation_kind Kind)
+{
+    static const char *KindNames[] = 
+    {
+        "malloc()", "new", "new[]", 
+    };
+    return(KindNames[Kind]);
+}
+
+
+const char *MVMGetReleaseKindName(allocation_kind Kind)
+{
+    static const char *KindNames[] = 
+    {
+        "free()", "delete", "delete[]", 
+    };
+    return(KindNames[Kind]);
+}
+
+
+// NOTE(Marko): Checks a block being released against its record, which the 
+//              caller has already taken out of the index, so this costs no 
+//              lookup of its own. MemorySize is the size a sized delete 
+//              passed, or 0. Alignment is only checked for new and new[], as 
+//              free() takes any block from the malloc() family. 
+void MVMCheckRelease(mvm_debug_memory_info *DebugInfo, 
+                     allocation_kind Kind, 
+                     size_t MemorySize, 
+                     size_t Alignment, 
+                     const char *Filename, 
+                     int LineNumber)
+{
+    int KindMatches = (DebugInfo->AllocationKind == Kind);
+    int SizeMatches = (!MemorySize || (MemorySize == DebugInfo->ByteCount));
+    int AlignmentMatches = 
+        ((Kind == AllocationKind_Malloc) || 
+         (DebugInfo->AlignmentLog2 == MVMAlignmentLog2(Alignment)));
+    if(!(KindMatches && SizeMatches && AlignmentMatches))
+    {
+        mvm_debug_memory_site *Site = MVMGetCallSite(DebugInfo->InitialSiteID);
+        printf("Error while releasing address %p in file %s on line %d\n", 
+               DebugInfo->CurrentAddress, Filename, LineNumber);
+        printf("Allocated with %s in file %s on line %d (%zu bytes", 
+               MVMGetAllocationKindName((allocation_kind)DebugInfo->AllocationKind), 
+               Site ? Site->Filename : "?", 
+               Site ? Site->LineNumber : 0, 
+               DebugInfo->ByteCount);
+        if(DebugInfo->AlignmentLog2)
+        {
+            printf(", aligned to %zu", 
+                   MVMAlignmentFromLog2(DebugInfo->AlignmentLog2));
+        }
+        printf("), released with %s", MVMGetReleaseKindName(Kind));
+        if(MemorySize || Alignment)
+        {
+            printf(" (");
+            if(MemorySize)
+            {
+                printf("%zu bytes%s", MemorySize, Alignment ? ", " : "");
+            }
+            if(Alignment)
+            {
+                printf("aligned to %zu", Alignment);
+            }
+            printf(")");
+        }
+        printf("\n");
+    }
+}
+
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugMalloc(size_t MemorySize, 
+                     const char *Filename, 
+                     int LineNumber)
+{
+    uint8_t BlockFlags;
+    void *Result = MVMAllocateBlock(MemorySize, 0, 0, 
+                                    Filename, LineNumber, &BlockFlags);
+    MVMTrackAllocation(Result, MemorySize, 0, AllocationKind_Malloc, BlockFlags, 
+                       Filename, LineNumber, 1);
+    return Result;
+}
+
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugCalloc(size_t Count, 
+                     size_t Size, 
+                     const char *Filename, 
+                     int LineNumber)
+{
+    if(Size && (Count > SIZE_MAX / Size))
+    {
+        errno = ENOMEM;
+        return(0);
+    }
+    uint8_t BlockFlags;
+    void *Result = MVMAllocateBlock(Count*Size, 0, 1, 
+                                    Filename, LineNumber, &BlockFlags);
+    MVMTrackAllocation(Result, Count*Size, 0, AllocationKind_Malloc, BlockFlags, 
+                       Filename, LineNumber, 1);
+    return(Result);
+}
+
+
+#if defined(_WIN32)
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugAlignedMalloc(size_t MemorySize, 
+                            size_t Alignment, 
+                            const char *Filename, 
+                            int LineNumber)
+{
+    uint8_t BlockFlags;
+    void *Result = MVMAllocateBlock(MemorySize, Alignment, 0, 
+                                    Filename, LineNumber, &BlockFlags);
+    MVMTrackAllocation(Result, MemorySize, Alignment, AllocationKind_Malloc, 
+                       BlockFlags, Filename, LineNumber, 1);
+    return(Result);
+}
+
+#else
+
+MVM_DEBUG_NOINLINE 
+int MVMDebugPosixMemalign(void **Memory, 
+                          size_t Alignment, 
+                          size_t MemorySize, 
+                          const char *Filename, 
+                          int LineNumber)
+{
+    // NOTE(Marko): posix_memalign() rejects what aligned_alloc() takes 
+    //              (alignments below sizeof(void *)), so check that first. 
+    if((Alignment < sizeof(void *)) || (Alignment & (Alignment - 1)))
+    {
+        return(EINVAL);
+    }
+    uint8_t BlockFlags;
+    void *Result = MVMAllocateBlock(MemorySize, Alignment, 0, 
+                                    Filename, LineNumber, &BlockFlags);
+    if(!Result)
+    {
+        return(errno);
+    }
+    *Memory = Result;
+    MVMTrackAllocation(Result, MemorySize, Alignment, AllocationKind_Malloc, 
+                       BlockFlags, Filename, LineNumber, 1);
+    return(0);
+}
+
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugAlignedAlloc(size_t Alignment, 
+                           size_t MemorySize, 
+                           const char *Filename, 
+                           int LineNumber)
+{
+    uint8_t BlockFlags;
+    void *Result = MVMAllocateBlock(MemorySize, Alignment, 0, 
+                                    Filename, LineNumber, &BlockFlags);
+    MVMTrackAllocation(Result, MemorySize, Alignment, AllocationKind_Malloc, 
+                       BlockFlags, Filename, LineNumber, 1);
+    return(Result);
+}
+
+#endif
+
+
+MVM_DEBUG_NOINLINE 
+char *MVMDebugStrdup(const char *String, 
+                     const char *Filename, 
+                     int LineNumber)
+{
+    size_t MemorySize = strlen(String) + 1;
+    uint8_t BlockFlags;
+    char *Result = (char *)MVMAllocateBlock(MemorySize, 0, 0, 
+                                            Filename, LineNumber, &BlockFlags);
+    if(Result)
+    {
+        memcpy(Result, String, MemorySize);
+    }
+    MVMTrackAllocation(Result, MemorySize, 0, AllocationKind_Malloc, BlockFlags, 
+                       Filename, LineNumber, 1);
+    return(Result);
+}
+
+
+MVM_DEBUG_NOINLINE 
+char *MVMDebugStrndup(const char *String, 
+                      size_t MaxLength, 
+                      const char *Filename, 
+                      int LineNumber)
+{
+    size_t Length = 0;
+    while((Length < MaxLength) && String[Length])
+    {
+        Length++;
+    }
+    uint8_t BlockFlags;
+    char *Result = (char *)MVMAllocateBlock(Length + 1, 0, 0, 
+                                            Filename, LineNumber, &BlockFlags);
+    if(Result)
+    {
+        memcpy(Result, String, Length);
+        Result[Length] = 0;
+    }
+    MVMTrackAllocation(Result, Length + 1, 0, AllocationKind_Malloc, BlockFlags, 
+                       Filename, LineNumber, 1);
+    return(Result);
+}
+
+
+// NOTE(Marko): Called as a tracked block is freed by the thread that owns 
+//              ThreadState. 
+void MVMRecordLifetime(mvm_debug_memory_lifetime_histogram *Histogram, 
+                       mvm_debug_memory_info *DebugInfo, 
+                       mvm_debug_memory_thread_state *ThreadState)
+{
+    // NOTE(Marko): Timestamps from different cores can be a little apart. 
+    uint64_t Now = MVMReadTimestamp();
+    uint64_t Ticks = (Now > DebugInfo->AllocationTimestamp) ? 
+        Now - DebugInfo->AllocationTimestamp : 0;
+    MVMAtomicAddU64(Histogram->Counts + MVMGetLogBucketIndex(Ticks), 1);
+    if(DebugInfo->AllocationThreadIndex != ThreadState->ThreadIndex)
+    {
+        MVMAtomicAddU64(&Histogram->OtherThreadCount, 1);
+    }
+    if(DebugInfo->AllocationScopeIndex != GlobalDebugInfoList->ScopeIndex)
+    {
+        MVMAtomicAddU64(&Histogram->OtherScopeCount, 1);
+    }
+}
+
+
+// NOTE(Marko): Bookkeeping for a tracked block that is going away, whose 
+//              record has already left the index. 
+void MVMRecordRelease(mvm_debug_memory_thread_state *ThreadState, 
+                      mvm_debug_memory_info *DebugInfo, 
+                      uint32_t FreeSiteID)
+{
+    MVMAppendEvent(ThreadState, 
+                   MemoryOperationType_Free, 
+                   FreeSiteID, 
+                   DebugInfo->CurrentAddress, 
+                   DebugInfo->ByteCount, 
+                   DebugInfo->LastEventIndex);
+
+    mvm_debug_memory_site_stats *SiteStats = 
+        MVMGetSiteStats(&GlobalDebugInfoList->SiteTable, 
+                        DebugInfo->InitialSiteID);
+    if(SiteStats)
+    {
+        MVMAtomicAddU64(&SiteStats->FreesCount, 1);
+        MVMSiteStatsChangeLiveBytes(SiteStats, -(int64_t)DebugInfo->ByteCount);
+    }
+    mvm_debug_memory_lifetime_histogram *Lifetimes = 
+        MVMGetLifetimeHistogram(&GlobalDebugInfoList->SiteTable, 
+                                DebugInfo->InitialSiteID);
+    if(Lifetimes)
+    {
+        MVMRecordLifetime(Lifetimes, DebugInfo, ThreadState);
+    }
+    MVMRecordLiveBytesChange(-(int64_t)DebugInfo->ByteCount);
+}
+
+
+realloc_chain_class MVMGetReallocChainClass(uint8_t ReallocFlags)
+{
+    realloc_chain_class Result = ReallocChainClass_Unchanged;
+    if(ReallocFlags & DEBUG_REALLOC_FLAG_ADDITIVE)
+    {
+        Result = ReallocChainClass_Additive;
+    }
+    else if(ReallocFlags & DEBUG_REALLOC_FLAG_GEOMETRIC)
+    {
+        Result = ReallocChainClass_Geometric;
+    }
+    else if(ReallocFlags & DEBUG_REALLOC_FLAG_SHRINK)
+    {
+        Result = ReallocChainClass_Shrinking;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Records one realloc() step of DebugInfo's chain, from 
+//              DebugInfo->ByteCount to NewByteCount, and updates 
+//              DebugInfo->ReallocFlags. Called before the record takes the 
+//              new size. 
+void MVMRecordReallocStep(mvm_debug_memory_realloc_stats *Stats, 
+                          mvm_debug_memory_info *DebugInfo, 
+                          size_t NewByteCount, 
+                          int Moved)
+{
+    size_t OldByteCount = DebugInfo->ByteCount;
+    uint8_t OldFlags = DebugInfo->ReallocFlags;
+    uint8_t NewFlags = OldFlags | DEBUG_REALLOC_FLAG_STARTED;
+    MVMAtomicMaxU64(&Stats->MaxByteCount, 
+                    (NewByteCount > OldByteCount) ? NewByteCount : OldByteCount);
+    if(NewByteCount > OldByteCount)
+    {
+        size_t Growth = NewByteCount - OldByteCount;
+        MVMAtomicAddU64(&Stats->GrownBytes, Growth);
+        if(Growth * DEBUG_REALLOC_GEOMETRIC_DIVISOR >= OldByteCount)
+        {
+            MVMAtomicAddU64(&Stats->GeometricStepsCount, 1);
+            NewFlags |= DEBUG_REALLOC_FLAG_GEOMETRIC;
+        }
+        else
+        {
+            MVMAtomicAddU64(&Stats->AdditiveStepsCount, 1);
+            MVMAtomicAddU64(&Stats->AdditiveGrownBytes, Growth);
+            NewFlags |= DEBUG_REALLOC_FLAG_ADDITIVE;
+        }
+    }
+    else if(NewByteCount < OldByteCount)
+    {
+        MVMAtomicAddU64(&Stats->ShrinkStepsCount, 1);
+        NewFlags |= DEBUG_REALLOC_FLAG_SHRINK;
+    }
+    if(Moved)
+    {
+        MVMAtomicAddU64(&Stats->MovedStepsCount, 1);
+        MVMAtomicAddU64(&Stats->CopiedBytes, 
+                        (NewByteCount < OldByteCount) ? 
+                        NewByteCount : OldByteCount);
+        NewFlags |= DEBUG_REALLOC_FLAG_MOVED;
+    }
+
+    // NOTE(Marko): Move the chain to the class its steps now put it in. 
+    realloc_chain_class NewClass = MVMGetReallocChainClass(NewFlags);
+    if(!(OldFlags & DEBUG_REALLOC_FLAG_STARTED))
+    {
+        MVMAtomicAddU64(&Stats->ChainsCount, 1);
+        MVMAtomicAddU64(Stats->ChainClassCounts + NewClass, 1);
+    }
+    else
+    {
+        realloc_chain_class OldClass = MVMGetReallocChainClass(OldFlags);
+        if(OldClass != NewClass)
+        {
+            MVMAtomicAddU64(Stats->ChainClassCounts + OldClass, (uint64_t)-1);
+            MVMAtomicAddU64(Stats->ChainClassCounts + NewClass, 1);
+        }
+    }
+    if((NewFlags & ~OldFlags) & DEBUG_REALLOC_FLAG_MOVED)
+    {
+        MVMAtomicAddU64(&Stats->MovedChainsCount, 1);
+    }
+    DebugInfo->ReallocFlags = NewFlags;
+}
+
+
+// NOTE(Marko): realloc(0, n) is a malloc(n), and is tracked as one. 
+MVM_DEBUG_NOINLINE 
+void *MVMDebugRealloc(void *Buffer, 
+                      size_t MemorySize, 
+                      const char *Filename, 
+                      int LineNumber)
+{
+    if(!Buffer)
+    {
+        uint8_t BlockFlags;
+        void *Result = MVMAllocateBlock(MemorySize, 0, 0, 
+                                        Filename, LineNumber, &BlockFlags);
+        MVMTrackAllocation(Result, MemorySize, 0, AllocationKind_Malloc, 
+                           BlockFlags, Filename, LineNumber, 1);
+        return Result;
+    }
+
+    // NOTE(Marko): Padded and quarantined blocks have to be found even while 
+    //              the tool is turned off, since the C library never saw 
+    //              their address or already thinks they are gone. 
+    mvm_debug_memory_thread_state *ThreadState = 0;
+    if(!((MVMDebugInfoIsTurnedOn() || MVMReleasesNeedLookup()) && 
+         (ThreadState = MVMGetThreadState())))
+    {
+        return MVM_DEBUG_REAL_REALLOC(Buffer, MemorySize);
+    }
+
+    // NOTE(Marko): Take the record out of the index *before* calling 
+    //              realloc(). Once realloc() returns, Buffer may already have 
+    //              been handed to another thread, whose malloc() would 
+    //              otherwise race with us for the same key. 
+    mvm_debug_memory_info DebugInfo;
+    int Found = MVMTakeDebugInfo(Buffer, &DebugInfo);
+    uint8_t BlockFlags = 0;
+    int CalledRealRealloc = 0;
+    void *Result;
+
+    mvm_debug_memory_quarantine_entry QuarantineEntry;
+    if(!Found && GlobalDebugInfoList->Quarantine && 
+       MVMFindQuarantineEntry(GlobalDebugInfoList->Quarantine, 
+                              Buffer, 
+                              &QuarantineEntry))
+    {
+        MVMReportQuarantinedRelease(&QuarantineEntry, Filename, LineNumber);
+        return(0);
+    }
+
+    // NOTE(Marko): A guarded site stays guarded across realloc(), so the 
+    //              padding is chosen for the site that made the block. 
+    mvm_debug_memory_site *Site = 
+        Found ? MVMGetCallSite(DebugInfo.InitialSiteID) : 0;
+    if(Site && 
+       (GlobalDebugInfoList->Quarantine || 
+        (DebugInfo.Flags & DEBUG_INFO_FLAG_PADDED) || 
+        MVMChooseBlockPadding(MemorySize, 0, Site->Filename, Site->LineNumber)))
+    {
+        // NOTE(Marko): realloc() cannot move the padding along with the 
+        //              block, so padded blocks always move to a new one. So 
+        //              does every block while the quarantine is on, so that 
+        //              the old one can be quarantined. 
+        Result = MVMAllocateBlock(MemorySize, 0, 0, 
+                                  Site->Filename, Site->LineNumber, 
+                                  &BlockFlags);
+        if(Result)
+        {
+            memcpy(Result, Buffer, (MemorySize < DebugInfo.ByteCount) ? 
+                                   MemorySize : DebugInfo.ByteCount);
+            MVM_DEBUG_REAL_FREE(
+                MVMRetireBlock(&DebugInfo, 
+                               MVMLookupCallSite(ThreadState, 
+                                                 Filename, LineNumber), 
+                               Filename, LineNumber));
+        }
+    }
+    else
+    {
+        Result = MVM_DEBUG_REAL_REALLOC(Buffer, MemorySize);
+        CalledRealRealloc = 1;
+    }
+
+    if(Found)
+    {
+        MVMCheckRelease(&DebugInfo, AllocationKind_Malloc, 0, 0, 
+                        Filename, LineNumber);
+    }
+
+    if(Result && Found)
+    {
+        // NOTE(Marko): Only commit information to the debug information list 
+        //              if 
+        //              1) realloc() succeeded 
+        //              2) GlobalDebugInfoList has been initialized 
+        //              3) the debug memory tool has been turned on. 
+        int64_t ByteCountChange = 
+            (int64_t)MemorySize - (int64_t)DebugInfo.ByteCount;
+        mvm_debug_memory_realloc_stats *ReallocStats = 
+            MVMGetReallocStats(&GlobalDebugInfoList->SiteTable, 
+                               DebugInfo.InitialSiteID);
+        if(ReallocStats)
+        {
+            MVMRecordReallocStep(ReallocStats, &DebugInfo, MemorySize, 
+                                 Result != Buffer);
+        }
+        DebugInfo.DebugInfoOpCount++;
+        DebugInfo.ByteCount = MemorySize;
+        DebugInfo.CurrentAddress = Result;
+        DebugInfo.AlignmentLog2 = 0;
+        DebugInfo.Flags = BlockFlags;
+        size_t UsableSize = BlockFlags ? 
+            MemorySize : MVMPlatformUsableSize(Result, 0);
+        DebugInfo.SlackBytes = (UsableSize > MemorySize) ? 
+            MVMSaturateSlackBytes(UsableSize - MemorySize) : 0;
+        DebugInfo.LastEventIndex = 
+            MVMAppendEvent(ThreadState, 
+                           MemoryOperationType_ReAllocation, 
+                           MVMLookupCallSite(ThreadState, Filename, LineNumber), 
+                           Result, 
+                           MemorySize, 
+                           DebugInfo.LastEventIndex);
+        MVMInsertDebugInfo(&DebugInfo);
+
+        mvm_debug_memory_site_stats *SiteStats = 
+            MVMGetSiteStats(&GlobalDebugInfoList->SiteTable, 
+                            DebugInfo.InitialSiteID);
+        if(SiteStats)
+        {
+            MVMAtomicAddU64(&SiteStats->ReallocationsCount, 1);
+            if(ByteCountChange > 0)
+            {
+                MVMAtomicAddU64(&SiteStats->TotalBytes, 
+                                (uint64_t)ByteCountChange);
+            }
+            MVMSiteStatsChangeLiveBytes(SiteStats, ByteCountChange);
+        }
+        MVMRecordLiveBytesChange(ByteCountChange);
+    }
+    else if(Found && CalledRealRealloc && !MemorySize)
+    {
+        // NOTE(Marko): glibc's realloc(Buffer, 0) frees Buffer and returns 
+        //              0, which is a free() rather than a failure. 
+        MVMRecordRelease(ThreadState, &DebugInfo, 
+                         MVMLookupCallSite(ThreadState, Filename, LineNumber));
+    }
+    else if(Found)
+    {
+        // NOTE(Marko): realloc() failed and Buffer is still ours. 
+        MVMInsertDebugInfo(&DebugInfo);
+    }
+    else if(Result && MVMDebugInfoIsTurnedOn() && 
+            GlobalDebugInfoList->ReportUntrackedPointers)
+    {
+        printf("Unable to find allocated memory located at %p in the debug info list.\n", Buffer);
+    }
+
+    return Result;
+
+}
+
+// NOTE(Marko): Records the release of Buffer, which the caller frees right 
+//              after. Kind, MemorySize and Alignment describe the releasing 
+//              call, as for MVMCheckRelease(). Returns the pointer to hand to 
+//              the C library, which differs from Buffer for padded blocks, 
+//              or 0 when the block goes into quarantine or is already there. 
+void *MVMUntrackAllocation(void *Buffer, 
+                          allocation_kind Kind, 
+                          size_t MemorySize, 
+                          size_t Alignment, 
+                          const char *Filename, 
+                          int LineNumber)
+{
+    void *Result = Buffer;
+    mvm_debug_memory_thread_state *ThreadState = 0;
+    if(Buffer && (MVMDebugInfoIsTurnedOn() || MVMReleasesNeedLookup()) && 
+       (ThreadState = MVMGetThreadState()))
+    {
+        // NOTE(Marko): Only write to the debug info list if: 
+        //              1) We are freeing actual memory, and not a null 
+        //              pointer 
+        //              2) The GlobalDebugInfoList has been initialized
+        //              3) We are currently in a Turned-On state for the Debug 
+        //                 Memory tool. 
+
+        // NOTE(Marko): free() is supposed to free something that currently 
+        //              exists. So we search via the current address. The 
+        //              record leaves the index before free() so the address 
+        //              cannot be reused under our feet. 
+
+        mvm_debug_memory_info DebugInfo;
+        mvm_debug_memory_quarantine_entry QuarantineEntry;
+        if(MVMTakeDebugInfo(Buffer, &DebugInfo))
+        {
+            MVMCheckRelease(&DebugInfo, Kind, MemorySize, Alignment, 
+                            Filename, LineNumber);
+            uint32_t FreeSiteID = 
+                MVMLookupCallSite(ThreadState, Filename, LineNumber);
+            Result = MVMRetireBlock(&DebugInfo, FreeSiteID, 
+                                    Filename, LineNumber);
+            MVMRecordRelease(ThreadState, &DebugInfo, FreeSiteID);
+        }
+        else if(GlobalDebugInfoList->Quarantine && 
+                MVMFindQuarantineEntry(GlobalDebugInfoList->Quarantine, 
+                                       Buffer, 
+                                       &QuarantineEntry))
+        {
+            MVMReportQuarantinedRelease(&QuarantineEntry, Filename, LineNumber);
+            Result = 0;
+        }
+        else if(MVMDebugInfoIsTurnedOn() && 
+                GlobalDebugInfoList->ReportUntrackedPointers)
+        {
+            printf("Error while attempting to free address %p in file %s on line %d\n", Buffer, Filename, LineNumber);
+            printf("Unable to find address at %p\n", Buffer);
+        }
+    }
+    return(Result);
+}
+
+
+void MVMDebugFree(void *Buffer,
+                  const char *Filename,
+                  int LineNumber)
+{
+    MVM_DEBUG_REAL_FREE(MVMUntrackAllocation(Buffer, AllocationKind_Malloc, 
+                                             0, 0, Filename, LineNumber));
+}
+
+
+#if defined(_WIN32)
+
+void MVMDebugAlignedFree(void *Buffer,
+                         const char *Filename,
+                         int LineNumber)
+{
+    MVM_DEBUG_REAL_ALIGNED_FREE(MVMUntrackAllocation(Buffer, 
+                                                     AllocationKind_Malloc, 
+                                                     0, 0, 
+                                                     Filename, LineNumber));
+}
+
+#endif
+
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugReallocArray(void *Buffer, 
+                           size_t Count, 
+                           size_t Size, 
+                           const char *Filename, 
+                           int LineNumber)
+{
+    if(Size && (Count > SIZE_MAX / Size))
+    {
+        errno = ENOMEM;
+        return(0);
+    }
+    void *Result = 0;
+    if(!Buffer)
+    {
+        uint8_t BlockFlags;
+        Result = MVMAllocateBlock(Count*Size, 0, 0, 
+                                  Filename, LineNumber, &BlockFlags);
+        MVMTrackAllocation(Result, Count*Size, 0, AllocationKind_Malloc, 
+                           BlockFlags, Filename, LineNumber, 1);
+    }
+    else
+    {
+        Result = MVMDebugRealloc(Buffer, Count*Size, Filename, LineNumber);
+    }
+    return(Result);
+}
+
+
+void MVMDebugMemoryComment(const char *MemoryComment,
+                           const char *Filename,
+                           int LineNumber)
+{
+    
+}
+
+
+void MVMDebugMemoryShutdown(void)
+{
+    // NOTE(Marko): Everything the tool owns lives in GlobalDebugArena, so 
+    //              there is nothing to walk: unmap the chunks and forget the 
+    //              list. Pointers that were tracked before this call can 
+    //              still be passed to free() afterwards; they are simply no 
+    //              longer found. No other thread may be inside the tool while 
+    //              this runs. 
+    if(GlobalDebugInfoList && GlobalDebugInfoList->RedzoneSweeper)
+    {
+        MVMRedzoneSweeperStop(GlobalDebugInfoList->RedzoneSweeper);
+    }
+    if(GlobalDebugInfoList && GlobalDebugInfoList->Quarantine)
+    {
+        MVMEvictQuarantine(GlobalDebugInfoList->Quarantine, 0);
+    }
+    if(GlobalDebugInfoList && GlobalDebugInfoList->TraceWriter)
+    {
+        MVMTraceWriterClose(GlobalDebugInfoList->TraceWriter);
+    }
+    MVMArenaRelease(&GlobalDebugArena);
+    GlobalDebugInfoList = 0;
+    GlobalDebugGeneration++;
+}
+
+
+// NOTE(Marko): Checks the redzones of every live padded block right now, 
+//              reporting damage the sweeper has not reported yet. Returns the 
+//              number of newly damaged blocks. 
+size_t MVMDebugMemoryCheckRedzones(void)
+{
+    uint64_t DamagedCount = 0;
+    if(!MVMBlockPaddingEnabled())
+    {
+        return(0);
+    }
+    for(uint32_t ShardIndex = 0; 
+        ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT; 
+        ShardIndex++)
+    {
+        size_t SlotIndex = 0;
+        while(!MVMSweepRedzones(GlobalDebugInfoList, ShardIndex, 
+                                &SlotIndex, &DamagedCount))
+        {
+        }
+    }
+    return((size_t)DamagedCount);
+}
+
+
+// NOTE(Marko): Checks every block in quarantine for writes since it was 
+//              freed, and hands them all back to the C library. 
+void MVMDebugMemoryFlushQuarantine(void)
+{
+    if(GlobalDebugInfoList && GlobalDebugInfoList->Quarantine)
+    {
+        MVMEvictQuarantine(GlobalDebugInfoList->Quarantine, 0);
+    }
+}
+
+
+// NOTE(Marko): Puts every block allocated at Filename:LineNumber from now on 
+//              on guard pages. Filename is compared by contents, so spell it 
+//              the way __FILE__ does in that file. Call after 
+//              MVMDebugMemoryInitialize(); returns 0 on failure. 
+int MVMDebugMemoryGuardSite(const char *Filename, int LineNumber)
+{
+    mvm_debug_memory_list *List = GlobalDebugInfoList;
+    if(!List)
+    {
+        printf("MVMDebugMemoryGuardSite() called before the debug info list was created.\n");
+        return(0);
+    }
+    uint32_t SiteID = MVMInternCallSite(&List->SiteTable, Filename, LineNumber);
+    mvm_debug_memory_site_stats *SiteStats = 
+        MVMGetSiteStats(&List->SiteTable, SiteID);
+    if((SiteID == DEBUG_SITE_ID_NONE) || !SiteStats)
+    {
+        return(0);
+    }
+    MVMInstallGuardPageFaultHandler();
+    if(!MVMAtomicLoadU32(&SiteStats->GuardPages))
+    {
+        MVMAtomicStoreU32(&SiteStats->GuardPages, 1);
+        MVMAtomicAddU64(&List->GuardedSitesCount, 1);
+    }
+    return(1);
+}
+
+#define DEBUG_PRINT_TOP_SITES_MAX 64
+
+void MVMDebugMemoryPrintTopSites(site_stat_metric Metric, size_t MaxSites)
+{
+    static const char *MetricNames[] = 
+    {
+        "allocations", "reallocations", "frees", 
+        "total bytes", "live bytes", "peak live bytes",
+    };
+    mvm_debug_memory_site_report Reports[DEBUG_PRINT_TOP_SITES_MAX];
+    if(MaxSites > DEBUG_PRINT_TOP_SITES_MAX)
+    {
+        MaxSites = DEBUG_PRINT_TOP_SITES_MAX;
+    }
+    size_t ReportsCount = MVMDebugMemoryGetTopSites(Metric, Reports, MaxSites);
+
+    printf("Top %zu call sites by %s:\n", ReportsCount, MetricNames[Metric]);
+    if(!ReportsCount)
+    {
+        printf("\n");
+        return;
+    }
+    printf("\t%12s %12s %14s %14s %14s  %s\n", 
+           "Allocations", "Frees", "Total bytes", "Live bytes", 
+           "Peak live", "Site");
+    for(size_t ReportIndex = 0; ReportIndex < ReportsCount; ReportIndex++)
+    {
+        mvm_debug_memory_site_report *Report = Reports + ReportIndex;
+        printf("\t%12llu %12llu %14llu %14llu %14llu  %s:%d\n", 
+               (unsigned long long)Report->AllocationsCount, 
+               (unsigned long long)Report->FreesCount, 
+               (unsigned long long)Report->TotalBytes, 
+               (unsigned long long)Report->LiveBytes, 
+               (unsigned long long)Report->PeakLiveBytes, 
+               Report->Filename, 
+               Report->LineNumber);
+    }
+    printf("\n");
+}
+
+
+// NOTE(Marko): Size-class report thresholds. A site is a pool candidate 
+//              once at least DEBUG_POOL_CANDIDATE_MIN_COUNT of its requests, 
+//              and all but 1/DEBUG_POOL_CANDIDATE_OUTLIER_DIVISOR of them, 
+//              are for the same size. A size is just above a size class 
+//              when it is within 1/DEBUG_SIZE_CLASS_NEAR_DIVISOR of the 
+//              class below and reserves more slack than it overshoots by. 
+//              Sites with no such size are flagged when at least 
+//              1/DEBUG_SIZE_CLASS_HIGH_SLACK_DIVISOR of what they reserve is 
+//              slack. 
+#define DEBUG_POOL_CANDIDATE_MIN_COUNT 1000
+#define DEBUG_POOL_CANDIDATE_OUTLIER_DIVISOR 10
+#define DEBUG_SIZE_CLASS_NEAR_DIVISOR 8
+#define DEBUG_SIZE_CLASS_HIGH_SLACK_DIVISOR 4
+
+
+// NOTE(Marko): Asks the allocator underneath the tool what it reserves for 
+//              a request of Size bytes, and binary-searches for the largest 
+//              request that gets less, which is where the size class below 
+//              ends. Allocates and frees a few blocks, so only reports call 
+//              this. Returns 0 if the allocator cannot be asked or Size is 
+//              in its smallest class. 
+int MVMProbeSizeClass(size_t Size, 
+                      size_t *UsableSize, 
+                      size_t *BelowSize, 
+                      size_t *BelowUsableSize)
+{
+    void *Memory = MVM_DEBUG_REAL_MALLOC(Size);
+    size_t Usable = Memory ? MVMPlatformUsableSize(Memory, 0) : 0;
+    MVM_DEBUG_REAL_FREE(Memory);
+    if(Usable < Size)
+    {
+        return(0);
+    }
+
+    // NOTE(Marko): Requests of Above bytes reserve Usable; requests of Below 
+    //              bytes reserve less (taking 0 to do so). 
+    size_t Below = 0;
+    size_t Above = Size;
+    size_t Reserved = 0;
+    while(Above - Below > 1)
+    {
+        size_t Middle = Below + (Above - Below)/2;
+        Memory = MVM_DEBUG_REAL_MALLOC(Middle);
+        size_t MiddleUsable = Memory ? MVMPlatformUsableSize(Memory, 0) : 0;
+        MVM_DEBUG_REAL_FREE(Memory);
+        if(!Memory)
+        {
+            return(0);
+        }
+        if(MiddleUsable < Usable)
+        {
+            Below = Middle;
+            Reserved = MiddleUsable;
+        }
+        else
+        {
+            Above = Middle;
+        }
+    }
+    *UsableSize = Usable;
+    *BelowSize = Below;
+    *BelowUsableSize = Reserved;
+    return(Below != 0);
+}
+
+
+// NOTE(Marko): Requested sizes and malloc slack for the MaxSites sites with 
+//              the most allocations, flagging pool candidates and sizes that 
+//              land just above a size class of the allocator underneath. 
+void MVMDebugMemoryPrintSizeClasses(size_t MaxSites)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+    mvm_debug_memory_site_report Reports[DEBUG_PRINT_TOP_SITES_MAX];
+    if(MaxSites > DEBUG_PRINT_TOP_SITES_MAX)
+    {
+        MaxSites = DEBUG_PRINT_TOP_SITES_MAX;
+    }
+    size_t ReportsCount = 
+        MVMDebugMemoryGetTopSites(SiteStatMetric_AllocationsCount, 
+                                  Reports, MaxSites);
+
+    printf("Requested sizes for the top %zu call sites by allocations:\n", 
+           ReportsCount);
+    for(size_t ReportIndex = 0; ReportIndex < ReportsCount; ReportIndex++)
+    {
+        mvm_debug_memory_site_report *Report = Reports + ReportIndex;
+        mvm_debug_memory_size_histogram *Histogram = 
+            MVMGetSizeHistogram(&GlobalDebugInfoList->SiteTable, 
+                                Report->SiteID);
+        if(!Histogram)
+        {
+            continue;
+        }
+        uint64_t AllocationsCount = 0;
+        uint64_t SlackBytes = 0;
+        for(uint32_t BucketIndex = 0; 
+            BucketIndex < DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT; 
+            BucketIndex++)
+        {
+            AllocationsCount += 
+                MVMAtomicLoadU64(&Histogram->Buckets[BucketIndex].Count);
+            SlackBytes += 
+                MVMAtomicLoadU64(&Histogram->Buckets[BucketIndex].SlackBytes);
+        }
+        if(!AllocationsCount)
+        {
+            continue;
+        }
+        uint64_t ReservedBytes = Report->TotalUsableBytes;
+        printf("\t%s:%d\t%llu allocations, %llu bytes reserved, %llu of them slack (%.1f%%)\n", 
+               Report->Filename, 
+               Report->LineNumber, 
+               (unsigned long long)AllocationsCount, 
+               (unsigned long long)ReservedBytes, 
+               (unsigned long long)SlackBytes, 
+               ReservedBytes ? 
+               100.0 * (double)SlackBytes / (double)ReservedBytes : 0.0);
+        for(uint32_t BucketIndex = 0; 
+            BucketIndex < DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT; 
+            BucketIndex++)
+        {
+            mvm_debug_memory_size_bucket *Bucket = 
+                Histogram->Buckets + BucketIndex;
+            uint64_t Count = MVMAtomicLoadU64(&Bucket->Count);
+            if(!Count)
+            {
+                continue;
+            }
+            uint64_t Min = MVMGetLogBucketMin(BucketIndex);
+            uint64_t Max = 
+                (BucketIndex + 1 < DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT) ? 
+                MVMGetLogBucketMin(BucketIndex + 1) - 1 : UINT64_MAX;
+            printf("\t\t%10llu - %-10llu %12llu allocations %14llu slack bytes\n", 
+                   (unsigned long long)Min, 
+                   (unsigned long long)Max, 
+                   (unsigned long long)Count, 
+                   (unsigned long long)MVMAtomicLoadU64(&Bucket->SlackBytes));
+        }
+
+        uint64_t CommonSizeCount = 
+            MVMAtomicLoadU64(&Histogram->CommonSizeCount);
+        size_t CommonSize = 
+            (size_t)(MVMAtomicLoadU64(&Histogram->CommonSizePlusOne) - 1);
+        if((CommonSizeCount >= DEBUG_POOL_CANDIDATE_MIN_COUNT) && 
+           ((AllocationsCount - CommonSizeCount) * 
+            DEBUG_POOL_CANDIDATE_OUTLIER_DIVISOR <= AllocationsCount))
+        {
+            printf("\t\tPool candidate: %llu allocations of exactly %zu bytes, at most %llu bytes live at once\n", 
+                   (unsigned long long)CommonSizeCount, 
+                   CommonSize, 
+                   (unsigned long long)Report->PeakLiveBytes);
+        }
+
+        size_t UsableSize;
+        size_t BelowSize;
+        size_t BelowUsableSize;
+        if((CommonSizeCount*2 >= AllocationsCount) && 
+           MVMProbeSizeClass(CommonSize, &UsableSize, 
+                             &BelowSize, &BelowUsableSize) && 
+           ((CommonSize - BelowSize) * DEBUG_SIZE_CLASS_NEAR_DIVISOR <= 
+            CommonSize) && 
+           (UsableSize - CommonSize > CommonSize - BelowSize))
+        {
+            printf("\t\tJust above a size class: %zu-byte requests reserve %zu bytes; %zu bytes or fewer would reserve %zu\n", 
+                   CommonSize, UsableSize, BelowSize, BelowUsableSize);
+        }
+        else if(ReservedBytes && 
+                (SlackBytes * DEBUG_SIZE_CLASS_HIGH_SLACK_DIVISOR >= 
+                 ReservedBytes))
+        {
+            printf("\t\tHigh slack: requests here leave %.1f%% of what they reserve unused\n", 
+                   100.0 * (double)SlackBytes / (double)ReservedBytes);
+        }
+    }
+    printf("\n");
+}
+
+
+double MVMGetTimestampFrequency(void)
+{
+    if(GlobalDebugInfoList->Timeline)
+    {
+        return (double)GlobalDebugInfoList->Timeline->TimestampFrequency;
+    }
+
+    // NOTE(Marko): Measure over the whole run so far; only spin if the run 
+    //              is too short to say. 
+    uint64_t ElapsedNanoseconds = 
+        MVMPlatformReadNanoseconds() - GlobalDebugInfoList->CreationNanoseconds;
+    uint64_t ElapsedTicks = 
+        MVMReadTimestamp() - GlobalDebugInfoList->CreationTimestamp;
+    if(ElapsedNanoseconds < DEBUG_TIMESTAMP_CALIBRATION_NS)
+    {
+        uint64_t StartTimestamp;
+        uint64_t StartNanoseconds;
+        return (double)MVMCalibrateTimestampFrequency(&StartTimestamp, 
+                                                      &StartNanoseconds);
+    }
+    return (double)ElapsedTicks * 1e9 / (double)ElapsedNanoseconds;
+}
+
+
+// NOTE(Marko): Arena-candidate thresholds. A site qualifies once at least 
+//              DEBUG_ARENA_CANDIDATE_MIN_COUNT of its blocks have been freed, 
+//              all but 1/DEBUG_ARENA_CANDIDATE_OUTLIER_DIVISOR of its blocks 
+//              are gone, 90% of them lived at most 
+//              DEBUG_ARENA_CANDIDATE_MAX_LIFETIME_NS, and all but the same 
+//              share of outliers were freed by the thread that made them or 
+//              in the TurnOn/TurnOff scope they were made in. 
+#define DEBUG_ARENA_CANDIDATE_MIN_COUNT 1000
+#define DEBUG_ARENA_CANDIDATE_OUTLIER_DIVISOR 10
+#define DEBUG_ARENA_CANDIDATE_MAX_LIFETIME_NS 1000000
+
+
+// NOTE(Marko): Upper edge, in ticks, of the bucket that holds the given 
+//              fraction of a lifetime histogram's TotalCount entries. 
+uint64_t MVMGetLifetimePercentile(mvm_debug_memory_lifetime_histogram *Histogram, 
+                                  uint64_t TotalCount, 
+                                  double Fraction)
+{
+    uint64_t Threshold = (uint64_t)(Fraction * (double)TotalCount + 0.5);
+    uint64_t Seen = 0;
+    for(uint32_t BucketIndex = 0; 
+        BucketIndex + 1 < DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT; 
+        BucketIndex++)
+    {
+        Seen += MVMAtomicLoadU64(Histogram->Counts + BucketIndex);
+        if(Seen && (Seen >= Threshold))
+        {
+            return(MVMGetLogBucketMin(BucketIndex + 1) - 1);
+        }
+    }
+    return(UINT64_MAX);
+}
+
+
+// NOTE(Marko): Lifetime percentiles for the MaxSites sites with the most 
+//              frees, and which of them would do better on an arena: short 
+//              lifetimes, released by the same thread or scope. 
+void MVMDebugMemoryPrintLifetimes(size_t MaxSites)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+    mvm_debug_memory_site_report Reports[DEBUG_PRINT_TOP_SITES_MAX];
+    if(MaxSites > DEBUG_PRINT_TOP_SITES_MAX)
+    {
+        MaxSites = DEBUG_PRINT_TOP_SITES_MAX;
+    }
+    size_t ReportsCount = 
+        MVMDebugMemoryGetTopSites(SiteStatMetric_FreesCount, Reports, MaxSites);
+    double NanosecondsPerTick = 1e9 / MVMGetTimestampFrequency();
+
+    printf("Allocation lifetimes for the top %zu call sites by frees:\n", 
+           ReportsCount);
+    if(!ReportsCount)
+    {
+        printf("\n");
+        return;
+    }
+    printf("\t%12s %14s %14s %14s %7s %7s  %s\n", 
+           "Frees", "Median ns", "90% ns", "99% ns", 
+           "Thread", "Scope", "Site");
+    for(size_t ReportIndex = 0; ReportIndex < ReportsCount; ReportIndex++)
+    {
+        mvm_debug_memory_site_report *Report = Reports + ReportIndex;
+        mvm_debug_memory_lifetime_histogram *Histogram = 
+            MVMGetLifetimeHistogram(&GlobalDebugInfoList->SiteTable, 
+                                    Report->SiteID);
+        uint64_t FreesCount = 0;
+        for(uint32_t BucketIndex = 0; 
+            Histogram && (BucketIndex < DEBUG_LOG_HISTOGRAM_BUCKETS_COUNT); 
+            BucketIndex++)
+        {
+            FreesCount += MVMAtomicLoadU64(Histogram->Counts + BucketIndex);
+        }
+        if(!FreesCount)
+        {
+            continue;
+        }
+        double Median = NanosecondsPerTick * 
+            (double)MVMGetLifetimePercentile(Histogram, FreesCount, 0.5);
+        double Percentile90 = NanosecondsPerTick * 
+            (double)MVMGetLifetimePercentile(Histogram, FreesCount, 0.9);
+        double Percentile99 = NanosecondsPerTick * 
+            (double)MVMGetLifetimePercentile(Histogram, FreesCount, 0.99);
+        // NOTE(Marko): Frees racing with the report can push the other 
+        //              counts past the buckets summed above. 
+        uint64_t OtherThreadCount = 
+            MVMAtomicLoadU64(&Histogram->OtherThreadCount);
+        uint64_t OtherScopeCount = MVMAtomicLoadU64(&Histogram->OtherScopeCount);
+        uint64_t SameThreadCount = (FreesCount > OtherThreadCount) ? 
+            FreesCount - OtherThreadCount : 0;
+        uint64_t SameScopeCount = (FreesCount > OtherScopeCount) ? 
+            FreesCount - OtherScopeCount : 0;
+        uint64_t LocalCount = (SameThreadCount > SameScopeCount) ? 
+            SameThreadCount : SameScopeCount;
+
+        int ArenaCandidate = 
+            (FreesCount >= DEBUG_ARENA_CANDIDATE_MIN_COUNT) && 
+            ((Report->AllocationsCount - Report->FreesCount) * 
+             DEBUG_ARENA_CANDIDATE_OUTLIER_DIVISOR <= Report->AllocationsCount) && 
+            (Percentile90 <= (double)DEBUG_ARENA_CANDIDATE_MAX_LIFETIME_NS) && 
+            ((FreesCount - LocalCount) * DEBUG_ARENA_CANDIDATE_OUTLIER_DIVISOR <= 
+             FreesCount);
+
+        printf("\t%12llu %14.0f %14.0f %14.0f %6.1f%% %6.1f%%  %s:%d%s\n", 
+               (unsigned long long)FreesCount, 
+               Median, 
+               Percentile90, 
+               Percentile99, 
+               100.0 * (double)SameThreadCount / (double)FreesCount, 
+               100.0 * (double)SameScopeCount / (double)FreesCount, 
+               Report->Filename, 
+               Report->LineNumber, 
+               ArenaCandidate ? "  (arena candidate)" : "");
+    }
+    printf("\n");
+}
+
+
+// NOTE(Marko): A site is flagged for quadratic copying once its chains have 
+//              taken at least DEBUG_REALLOC_QUADRATIC_MIN_STEPS additive steps 
+//              and copied DEBUG_REALLOC_QUADRATIC_COPY_RATIO times the bytes 
+//              they grew by; geometric growth copies about once. 
+#define DEBUG_REALLOC_QUADRATIC_MIN_STEPS 64
+#define DEBUG_REALLOC_QUADRATIC_COPY_RATIO 8
+
+
+// NOTE(Marko): Growth patterns of the MaxSites sites with the most 
+//              realloc()s, and which of them grow by a constant and pay for 
+//              it in copies. 
+void MVMDebugMemoryPrintReallocPatterns(size_t MaxSites)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+    mvm_debug_memory_site_report Reports[DEBUG_PRINT_TOP_SITES_MAX];
+    if(MaxSites > DEBUG_PRINT_TOP_SITES_MAX)
+    {
+        MaxSites = DEBUG_PRINT_TOP_SITES_MAX;
+    }
+    size_t ReportsCount = 
+        MVMDebugMemoryGetTopSites(SiteStatMetric_ReallocationsCount, 
+                                  Reports, MaxSites);
+
+    printf("realloc() chains for the top %zu call sites by reallocations:\n", 
+           ReportsCount);
+    for(size_t ReportIndex = 0; ReportIndex < ReportsCount; ReportIndex++)
+    {
+        mvm_debug_memory_site_report *Report = Reports + ReportIndex;
+        mvm_debug_memory_realloc_stats *Stats = 
+            MVMGetReallocStats(&GlobalDebugInfoList->SiteTable, 
+                               Report->SiteID);
+        uint64_t ChainsCount = 
+            Stats ? MVMAtomicLoadU64(&Stats->ChainsCount) : 0;
+        if(!ChainsCount)
+        {
+            continue;
+        }
+        uint64_t GeometricStepsCount = 
+            MVMAtomicLoadU64(&Stats->GeometricStepsCount);
+        uint64_t AdditiveStepsCount = 
+            MVMAtomicLoadU64(&Stats->AdditiveStepsCount);
+        uint64_t ShrinkStepsCount = MVMAtomicLoadU64(&Stats->ShrinkStepsCount);
+        uint64_t MovedStepsCount = MVMAtomicLoadU64(&Stats->MovedStepsCount);
+        uint64_t GrownBytes = MVMAtomicLoadU64(&Stats->GrownBytes);
+        uint64_t AdditiveGrownBytes = 
+            MVMAtomicLoadU64(&Stats->AdditiveGrownBytes);
+        uint64_t CopiedBytes = MVMAtomicLoadU64(&Stats->CopiedBytes);
+        uint64_t MaxByteCount = MVMAtomicLoadU64(&Stats->MaxByteCount);
+        uint64_t StepsCount = 
+            GeometricStepsCount + AdditiveStepsCount + ShrinkStepsCount;
+
+        printf("\t%s:%d\t%llu chains, %llu reallocations, %llu bytes copied by the %llu that moved\n", 
+               Report->Filename, 
+               Report->LineNumber, 
+               (unsigned long long)ChainsCount, 
+               (unsigned long long)Report->ReallocationsCount, 
+               (unsigned long long)CopiedBytes, 
+               (unsigned long long)MovedStepsCount);
+        printf("\t\tChains: %.1f%% geometric, %.1f%% additive, %.1f%% shrinking, %.1f%% unchanged; %.1f%% moved, %.1f%% address-stable\n", 
+               100.0 * (double)MVMAtomicLoadU64(Stats->ChainClassCounts + 
+                                                ReallocChainClass_Geometric) / 
+               (double)ChainsCount, 
+               100.0 * (double)MVMAtomicLoadU64(Stats->ChainClassCounts + 
+                                                ReallocChainClass_Additive) / 
+               (double)ChainsCount, 
+               100.0 * (double)MVMAtomicLoadU64(Stats->ChainClassCounts + 
+                                                ReallocChainClass_Shrinking) / 
+               (double)ChainsCount, 
+               100.0 * (double)MVMAtomicLoadU64(Stats->ChainClassCounts + 
+                                                ReallocChainClass_Unchanged) / 
+               (double)ChainsCount, 
+               100.0 * (double)MVMAtomicLoadU64(&Stats->MovedChainsCount) / 
+               (double)ChainsCount, 
+               100.0 - 100.0 * 
+               (double)MVMAtomicLoadU64(&Stats->MovedChainsCount) / 
+               (double)ChainsCount);
+        if(StepsCount)
+        {
+            printf("\t\tSteps: %llu geometric, %llu additive, %llu shrinking; %llu bytes grown, largest size %llu\n", 
+                   (unsigned long long)GeometricStepsCount, 
+                   (unsigned long long)AdditiveStepsCount, 
+                   (unsigned long long)ShrinkStepsCount, 
+                   (unsigned long long)GrownBytes, 
+                   (unsigned long long)MaxByteCount);
+        }
+
+        if((AdditiveStepsCount >= DEBUG_REALLOC_QUADRATIC_MIN_STEPS) && 
+           (CopiedBytes >= GrownBytes * DEBUG_REALLOC_QUADRATIC_COPY_RATIO))
+        {
+            // NOTE(Marko): Reserving the largest size seen up front makes 
+            //              every chain a single allocation; rounded up to a 
+            //              power of two, it is also what doubling ends at. 
+            uint64_t Capacity = MaxByteCount;
+            if(Capacity & (Capacity - 1))
+            {
+                Capacity = (uint64_t)1 << (MVMFloorLog2U64(Capacity) + 1);
+            }
+            printf("\t\tQuadratic copying: grows by about %llu bytes a step and copied %.1fx the bytes it grew by; reserve %llu bytes up front or grow geometrically\n", 
+                   (unsigned long long)(AdditiveGrownBytes / AdditiveStepsCount), 
+                   GrownBytes ? (double)CopiedBytes / (double)GrownBytes : 0.0, 
+                   (unsigned long long)Capacity);
+        }
+    }
+    printf("\n");
+}
+
+
+void MVMDebugMemoryPrintHighWaterMark(void)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+    double TimestampFrequency = MVMGetTimestampFrequency();
+    mvm_debug_memory_peak_snapshot *Snapshot = &GlobalDebugInfoList->PeakSnapshot;
+
+    printf("Live bytes now: %llu\n", 
+           (unsigned long long)GlobalDebugInfoList->LiveBytes);
+    uint64_t PeakLiveBytes = MVMAtomicLoadU64(&GlobalDebugInfoList->PeakLiveBytes);
+    if(Snapshot->LiveBytes && (Snapshot->LiveBytes < PeakLiveBytes))
+    {
+        // NOTE(Marko): The snapshot is only retaken after a large enough 
+        //              climb, so say which total its sites add up to. 
+        printf("Peak live bytes: %llu (top sites snapshotted at %llu)\n", 
+               (unsigned long long)PeakLiveBytes, 
+               (unsigned long long)Snapshot->LiveBytes);
+    }
+    else
+    {
+        printf("Peak live bytes: %llu\n", (unsigned long long)PeakLiveBytes);
+    }
+    if(Snapshot->LiveBytes)
+    {
+        printf("Top sites when live bytes last reached %llu (%.3f s after start):\n", 
+               (unsigned long long)Snapshot->LiveBytes, 
+               (double)(Snapshot->Timestamp - 
+                        GlobalDebugInfoList->CreationTimestamp) / 
+               TimestampFrequency);
+        for(size_t SiteIndex = 0; SiteIndex < Snapshot->SitesCount; SiteIndex++)
+        {
+            mvm_debug_memory_site_report *Report = Snapshot->Sites + SiteIndex;
+            printf("\t%14llu bytes  %s:%d\n", 
+                   (unsigned long long)Report->LiveBytes, 
+                   Report->Filename, 
+                   Report->LineNumber);
+        }
+    }
+    printf("\n");
+}
+
+
+// NOTE(Marko): Copies the timeline into Samples (live bytes, the highest 
+//              seen in each interval) and returns how many were copied. 
+//              Intervals without any operation repeat the previous value. 
+//              *IntervalSeconds receives the current resolution. Returns 0 
+//              if no timeline was configured. 
+size_t MVMDebugMemoryGetTimeline(uint64_t *Samples, 
+                                 size_t MaxSamples, 
+                                 double *IntervalSeconds)
+{
+    size_t Result = 0;
+    if(!GlobalDebugInfoList || !GlobalDebugInfoList->Timeline)
+    {
+        return(Result);
+    }
+    mvm_debug_memory_timeline *Timeline = GlobalDebugInfoList->Timeline;
+
+    MVMLockAcquire(&Timeline->Lock);
+    *IntervalSeconds = (double)Timeline->IntervalTicks / 
+        (double)Timeline->TimestampFrequency;
+    uint64_t PreviousLiveBytes = 0;
+    for(uint64_t SampleIndex = 0; 
+        (SampleIndex <= Timeline->LastSampleIndex) && (Result < MaxSamples); 
+        SampleIndex++)
+    {
+        uint64_t Sample = MVMAtomicLoadU64(Timeline->Samples + SampleIndex);
+        if(Sample)
+        {
+            PreviousLiveBytes = Sample - 1;
+        }
+        Samples[Result++] = PreviousLiveBytes;
+    }
+    MVMLockRelease(&Timeline->Lock);
+    return(Result);
+}
+
+
+#define DEBUG_TIMELINE_PRINT_WIDTH 60
+#define DEBUG_TIMELINE_PRINT_ROWS 32
+
+void MVMDebugMemoryPrintTimeline(void)
+{
+    uint64_t Samples[DEBUG_TIMELINE_SAMPLES_COUNT];
+    double IntervalSeconds = 0.0;
+    size_t SamplesCount = 
+        MVMDebugMemoryGetTimeline(Samples, 
+                                  DEBUG_TIMELINE_SAMPLES_COUNT, 
+                                  &IntervalSeconds);
+    if(!SamplesCount)
+    {
+        return;
+    }
+
+    // NOTE(Marko): Fold the samples into at most DEBUG_TIMELINE_PRINT_ROWS 
+    //              rows, keeping the highest value of each group. 
+    size_t SamplesPerRow = 
+        (SamplesCount + DEBUG_TIMELINE_PRINT_ROWS - 1) / DEBUG_TIMELINE_PRINT_ROWS;
+    size_t RowsCount = 0;
+    uint64_t MaxLiveBytes = 1;
+    for(size_t SampleIndex = 0; SampleIndex < SamplesCount; SampleIndex++)
+    {
+        size_t RowIndex = SampleIndex / SamplesPerRow;
+        if((RowIndex >= RowsCount) || (Samples[SampleIndex] > Samples[RowIndex]))
+        {
+            Samples[RowIndex] = Samples[SampleIndex];
+        }
+        RowsCount = RowIndex + 1;
+        if(Samples[SampleIndex] > MaxLiveBytes)
+        {
+            MaxLiveBytes = Samples[SampleIndex];
+        }
+    }
+
+    double RowSeconds = IntervalSeconds * (double)SamplesPerRow;
+    printf("Live bytes over time (peak of each %.6f s):\n", RowSeconds);
+    for(size_t RowIndex = 0; RowIndex < RowsCount; RowIndex++)
+    {
+        int BarLength = (int)((Samples[RowIndex] * DEBUG_TIMELINE_PRINT_WIDTH) / 
+                              MaxLiveBytes);
+        printf("\t%10.6f s %14llu |%.*s\n", 
+               (double)RowIndex * RowSeconds, 
+               (unsigned long long)Samples[RowIndex], 
+               BarLength, 
+               "############################################################");
+    }
+    printf("\n");
+}
+
+
+// NOTE(Marko): Live bytes and allocations per call site (or per call stack 
+//              with GroupByStack set), each tracked block weighted by the 
+//              inverse of its sampling probability. With sampling off every 
+//              weight is 1 and these are exact. Returns an arena array of 
+//              2*KeysCount doubles, bytes first and counts second, for the 
+//              caller to MVMArenaFree(); 0 if there is nothing to gather. 
+double *MVMGatherLiveEstimates(int GroupByStack, uint32_t *KeysCountOut)
+{
+    uint32_t KeysCount = GroupByStack ? 
+        GlobalDebugInfoList->StackTable.StacksCount : 
+        GlobalDebugInfoList->SiteTable.SitesCount;
+    double *Estimates = 0;
+    if(KeysCount)
+    {
+        Estimates = (double *)MVMArenaAllocate(&GlobalDebugArena, 
+                                               2 * (sizeof(double)) * KeysCount);
+    }
+    if(!Estimates)
+    {
+        return(0);
+    }
+    double *BytesEstimates = Estimates;
+    double *CountEstimates = Estimates + KeysCount;
+
+    for(int ShardIndex = 0; 
+        ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT; 
+        ShardIndex++)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            GlobalDebugInfoList->AddressTables + ShardIndex;
+        MVMLockAcquire(&AddressTable->Lock);
+        for(size_t SlotIndex = 0; 
+            SlotIndex < AddressTable->SlotsAllocated; 
+            SlotIndex++)
+        {
+            mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+            uint32_t Key = GroupByStack ? Slot->StackID : Slot->InitialSiteID;
+            if((Slot->CurrentAddress != DEBUG_ADDRESS_TABLE_EMPTY) && 
+               (Slot->CurrentAddress != DEBUG_ADDRESS_TABLE_TOMBSTONE) && 
+               (Key < KeysCount))
+            {
+                double Weight = 1.0 / (double)Slot->SampleProbability;
+                BytesEstimates[Key] += Weight * (double)Slot->ByteCount;
+                CountEstimates[Key] += Weight;
+            }
+        }
+        MVMLockRelease(&AddressTable->Lock);
+    }
+
+    *KeysCountOut = KeysCount;
+    return(Estimates);
+}
+
+
+void MVMDebugMemoryPrintLiveSites(void)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return;
+    }
+
+    uint32_t SitesCount = 0;
+    double *Estimates = MVMGatherLiveEstimates(0, &SitesCount);
+    if(!Estimates)
+    {
+        return;
+    }
+    double *BytesEstimates = Estimates;
+    double *CountEstimates = Estimates + SitesCount;
+
+    if(GlobalDebugInfoList->SampleIntervalBytes)
+    {
+        printf("Estimated live memory by call site (1 sample per %zu bytes):\n", 
+               GlobalDebugInfoList->SampleIntervalBytes);
+    }
+    else
+    {
+        printf("Live memory by call site:\n");
+    }
+    for(uint32_t SiteID = 0; SiteID < SitesCount; SiteID++)
+    {
+        if(CountEstimates[SiteID] > 0.0)
+        {
+            mvm_debug_memory_site *Site = MVMGetCallSite(SiteID);
+            printf("\t%s:%d\t%.0f bytes in %.0f allocations\n", 
+                   Site->Filename, 
+                   Site->LineNumber, 
+                   BytesEstimates[SiteID], 
+                   CountEstimates[SiteID]);
+        }
+    }
+    printf("\n");
+
+    MVMArenaFree(&GlobalDebugArena, Estimates, 2 * (sizeof(double)) * SitesCount);
+}
+
+
+// NOTE(Marko): LSD radix sort by address, one byte per pass. A byte that is 
+//              the same in every address, like the top ones, costs no pass. 
+//              Returns whichever of Entries and Scratch holds the result. 
+mvm_debug_memory_snapshot_entry *
+MVMSortSnapshotEntries(mvm_debug_memory_snapshot_entry *Entries, 
+                       mvm_debug_memory_snapshot_entry *Scratch, 
+                       size_t EntriesCount)
+{
+    size_t Counts[sizeof(uintptr_t)][256];
+    memset(Counts, 0, sizeof Counts);
+    for(size_t EntryIndex = 0; EntryIndex < EntriesCount; EntryIndex++)
+    {
+        uintptr_t Address = (uintptr_t)Entries[EntryIndex].Address;
+        for(int ByteIndex = 0; ByteIndex < (int)sizeof(uintptr_t); ByteIndex++)
+        {
+            Counts[ByteIndex][(Address >> (8*ByteIndex)) & 0xFF]++;
+        }
+    }
+
+    mvm_debug_memory_snapshot_entry *Source = Entries;
+    mvm_debug_memory_snapshot_entry *Dest = Scratch;
+    for(int ByteIndex = 0; ByteIndex < (int)sizeof(uintptr_t); ByteIndex++)
+    {
+        size_t *ByteCounts = Counts[ByteIndex];
+        size_t Offset = 0;
+        int Skip = 0;
+        for(int Digit = 0; Digit < 256; Digit++)
+        {
+            size_t Count = ByteCounts[Digit];
+            Skip |= (Count == EntriesCount);
+            ByteCounts[Digit] = Offset;
+            Offset += Count;
+        }
+        if(Skip)
+        {
+            continue;
+        }
+        for(size_t EntryIndex = 0; EntryIndex < EntriesCount; EntryIndex++)
+        {
+            uintptr_t Address = (uintptr_t)Source[EntryIndex].Address;
+            Dest[ByteCounts[(Address >> (8*ByteIndex)) & 0xFF]++] = 
+                Source[EntryIndex];
+        }
+        mvm_debug_memory_snapshot_entry *Temp = Source;
+        Source = Dest;
+        Dest = Temp;
+    }
+    return(Source);
+}
+
+
+void MVMDebugMemoryFreeSnapshot(mvm_debug_memory_snapshot *Snapshot)
+{
+    if(!GlobalDebugInfoList || !Snapshot)
+    {
+        return;
+    }
+    MVMArenaFree(&GlobalDebugArena, 
+                 Snapshot->Entries, 
+                 (sizeof *Snapshot->Entries) * Snapshot->EntriesAllocated);
+    MVMArenaFree(&GlobalDebugArena, Snapshot, sizeof *Snapshot);
+}
+
+
+// NOTE(Marko): Copies the live set, one shard at a time, and sorts it by 
+//              address. Each shard's lock is held only for its copy. Release 
+//              the result with MVMDebugMemoryFreeSnapshot(); returns 0 on 
+//              failure. 
+mvm_debug_memory_snapshot *MVMDebugMemorySnapshot(void)
+{
+    mvm_debug_memory_list *List = GlobalDebugInfoList;
+    if(!List)
+    {
+        return(0);
+    }
+    mvm_debug_memory_snapshot *Snapshot = 
+        (mvm_debug_memory_snapshot *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                      sizeof *Snapshot);
+    if(!Snapshot)
+    {
+        return(0);
+    }
+    Snapshot->Nanoseconds = MVMPlatformReadNanoseconds();
+
+    // NOTE(Marko): Sized from an unlocked count, with some room for blocks 
+    //              allocated while the shards are copied. A shard that still 
+    //              does not fit grows the array under its lock. 
+    size_t LiveCount = MVMCountLiveAllocations();
+    Snapshot->EntriesAllocated = LiveCount + LiveCount/8 + 64;
+    Snapshot->Entries = (mvm_debug_memory_snapshot_entry *)MVMArenaAllocate(
+        &GlobalDebugArena, 
+        (sizeof *Snapshot->Entries) * Snapshot->EntriesAllocated);
+
+    int Failed = !Snapshot->Entries;
+    for(int ShardIndex = 0; 
+        !Failed && (ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT); 
+        ShardIndex++)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            List->AddressTables + ShardIndex;
+        MVMLockAcquire(&AddressTable->Lock);
+        size_t NeededCount = Snapshot->EntriesCount + AddressTable->SlotsUsed;
+        if(NeededCount > Snapshot->EntriesAllocated)
+        {
+            size_t NewEntriesAllocated = 2*Snapshot->EntriesAllocated;
+            if(NewEntriesAllocated < NeededCount)
+            {
+                NewEntriesAllocated = NeededCount;
+            }
+            mvm_debug_memory_snapshot_entry *NewEntries = 
+                (mvm_debug_memory_snapshot_entry *)MVMArenaReallocate(
+                    &GlobalDebugArena, 
+                    Snapshot->Entries, 
+                    (sizeof *Snapshot->Entries) * Snapshot->EntriesAllocated, 
+                    (sizeof *Snapshot->Entries) * NewEntriesAllocated);
+            if(!NewEntries)
+            {
+                MVMLockRelease(&AddressTable->Lock);
+                Failed = 1;
+                break;
+            }
+            Snapshot->Entries = NewEntries;
+            Snapshot->EntriesAllocated = NewEntriesAllocated;
+        }
+        for(size_t SlotIndex = 0; 
+            SlotIndex < AddressTable->SlotsAllocated; 
+            SlotIndex++)
+        {
+            mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+            if((Slot->CurrentAddress != DEBUG_ADDRESS_TABLE_EMPTY) && 
+               (Slot->CurrentAddress != DEBUG_ADDRESS_TABLE_TOMBSTONE))
+            {
+                mvm_debug_memory_snapshot_entry *Entry = 
+                    Snapshot->Entries + Snapshot->EntriesCount++;
+                Entry->Address = Slot->CurrentAddress;
+                Entry->ByteCount = Slot->ByteCount;
+                Entry->SiteID = Slot->InitialSiteID;
+                Entry->SampleProbability = Slot->SampleProbability;
+            }
+        }
+        MVMLockRelease(&AddressTable->Lock);
+    }
+    if(Failed)
+    {
+        printf("Debug arena allocation failed while taking a heap snapshot.\n");
+        MVMDebugMemoryFreeSnapshot(Snapshot);
+        return(0);
+    }
+
+    mvm_debug_memory_snapshot_entry *Scratch = 
+        (mvm_debug_memory_snapshot_entry *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *Scratch) * Snapshot->EntriesAllocated);
+    if(!Scratch)
+    {
+        printf("Debug arena allocation failed while taking a heap snapshot.\n");
+        MVMDebugMemoryFreeSnapshot(Snapshot);
+        return(0);
+    }
+    mvm_debug_memory_snapshot_entry *Sorted = 
+        MVMSortSnapshotEntries(Snapshot->Entries, Scratch, 
+                               Snapshot->EntriesCount);
+    if(Sorted == Scratch)
+    {
+        Scratch = Snapshot->Entries;
+        Snapshot->Entries = Sorted;
+    }
+    MVMArenaFree(&GlobalDebugArena, 
+                 Scratch, 
+                 (sizeof *Scratch) * Snapshot->EntriesAllocated);
+    return(Snapshot);
+}
+
+
+typedef struct mvm_debug_memory_site_diff_totals
+{
+    double AddedCount;
+    double AddedBytes;
+    double FreedCount;
+    double FreedBytes;
+    double GrownCount;
+    double GrownBytes;
+    double ShrunkCount;
+    double ShrunkBytes;
+
+} mvm_debug_memory_site_diff_totals;
+
+
+int MVMCompareSiteDiffsByNetBytes(const void *A, const void *B)
+{
+    int64_t NetA = ((const mvm_debug_memory_site_diff *)A)->NetBytes;
+    int64_t NetB = ((const mvm_debug_memory_site_diff *)B)->NetBytes;
+    return((NetA < NetB) - (NetA > NetB));
+}
+
+
+// NOTE(Marko): Compares two snapshots in one pass over both and fills Diffs 
+//              with up to MaxDiffs sites that changed, largest net growth 
+//              first. Returns how many it filled. 
+size_t MVMDebugMemoryDiff(mvm_debug_memory_snapshot *Before, 
+                          mvm_debug_memory_snapshot *After, 
+                          mvm_debug_memory_site_diff *Diffs, 
+                          size_t MaxDiffs)
+{
+    size_t DiffsCount = 0;
+    if(!GlobalDebugInfoList || !Before || !After || !MaxDiffs)
+    {
+        return(DiffsCount);
+    }
+
+    uint32_t SitesCount = GlobalDebugInfoList->SiteTable.SitesCount;
+    mvm_debug_memory_site_diff_totals *Totals = 0;
+    if(SitesCount)
+    {
+        Totals = (mvm_debug_memory_site_diff_totals *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *Totals) * SitesCount);
+    }
+    if(!Totals)
+    {
+        return(DiffsCount);
+    }
+
+    mvm_debug_memory_snapshot_entry *Old = Before->Entries;
+    mvm_debug_memory_snapshot_entry *OldEnd = Old + Before->EntriesCount;
+    mvm_debug_memory_snapshot_entry *New = After->Entries;
+    mvm_debug_memory_snapshot_entry *NewEnd = New + After->EntriesCount;
+    while((Old < OldEnd) || (New < NewEnd))
+    {
+        mvm_debug_memory_snapshot_entry *Freed = 0;
+        mvm_debug_memory_snapshot_entry *Added = 0;
+        if((New == NewEnd) || 
+           ((Old < OldEnd) && ((uintptr_t)Old->Address < (uintptr_t)New->Address)))
+        {
+            Freed = Old++;
+        }
+        else if((Old == OldEnd) || 
+                ((uintptr_t)New->Address < (uintptr_t)Old->Address))
+        {
+            Added = New++;
+        }
+        else if(Old->SiteID != New->SiteID)
+        {
+            // NOTE(Marko): The address was freed and handed out again. 
+            Freed = Old++;
+            Added = New++;
+        }
+        else
+        {
+            if((New->ByteCount != Old->ByteCount) && (New->SiteID < SitesCount))
+            {
+                mvm_debug_memory_site_diff_totals *Site = Totals + New->SiteID;
+                double Weight = 1.0 / (double)New->SampleProbability;
+                if(New->ByteCount > Old->ByteCount)
+                {
+                    Site->GrownCount += Weight;
+                    Site->GrownBytes += 
+                        Weight * (double)(New->ByteCount - Old->ByteCount);
+                }
+                else
+                {
+                    Site->ShrunkCount += Weight;
+                    Site->ShrunkBytes += 
+                        Weight * (double)(Old->ByteCount - New->ByteCount);
+                }
+            }
+            Old++;
+            New++;
+        }
+
+        if(Freed && (Freed->SiteID < SitesCount))
+        {
+            double Weight = 1.0 / (double)Freed->SampleProbability;
+            Totals[Freed->SiteID].FreedCount += Weight;
+            Totals[Freed->SiteID].FreedBytes += Weight * (double)Freed->ByteCount;
+        }
+        if(Added && (Added->SiteID < SitesCount))
+        {
+            double Weight = 1.0 / (double)Added->SampleProbability;
+            Totals[Added->SiteID].AddedCount += Weight;
+            Totals[Added->SiteID].AddedBytes += Weight * (double)Added->ByteCount;
+        }
+    }
+
+    mvm_debug_memory_site_diff *Changed = 
+        (mvm_debug_memory_site_diff *)MVMArenaAllocate(
+            &GlobalDebugArena, 
+            (sizeof *Changed) * SitesCount);
+    size_t ChangedCount = 0;
+    for(uint32_t SiteID = 0; Changed && (SiteID < SitesCount); SiteID++)
+    {
+        mvm_debug_memory_site_diff_totals *Site = Totals + SiteID;
+        if((Site->AddedCount == 0.0) && (Site->FreedCount == 0.0) && 
+           (Site->GrownCount == 0.0) && (Site->ShrunkCount == 0.0))
+        {
+            continue;
+        }
+        mvm_debug_memory_site *CallSite = MVMGetCallSite(SiteID);
+        mvm_debug_memory_site_diff *Diff = Changed + ChangedCount++;
+        Diff->Filename = CallSite ? CallSite->Filename : "?";
+        Diff->LineNumber = CallSite ? CallSite->LineNumber : 0;
+        Diff->SiteID = SiteID;
+        Diff->AddedCount = (uint64_t)(Site->AddedCount + 0.5);
+        Diff->AddedBytes = (uint64_t)(Site->AddedBytes + 0.5);
+        Diff->FreedCount = (uint64_t)(Site->FreedCount + 0.5);
+        Diff->FreedBytes = (uint64_t)(Site->FreedBytes + 0.5);
+        Diff->GrownCount = (uint64_t)(Site->GrownCount + 0.5);
+        Diff->GrownBytes = (uint64_t)(Site->GrownBytes + 0.5);
+        Diff->ShrunkCount = (uint64_t)(Site->ShrunkCount + 0.5);
+        Diff->ShrunkBytes = (uint64_t)(Site->ShrunkBytes + 0.5);
+        Diff->NetBytes = (int64_t)(Diff->AddedBytes + Diff->GrownBytes) - 
+                         (int64_t)(Diff->FreedBytes + Diff->ShrunkBytes);
+    }
+    if(Changed)
+    {
+        qsort(Changed, ChangedCount, sizeof *Changed, 
+              MVMCompareSiteDiffsByNetBytes);
+        DiffsCount = (ChangedCount < MaxDiffs) ? ChangedCount : MaxDiffs;
+        memcpy(Diffs, Changed, (sizeof *Changed) * DiffsCount);
+        MVMArenaFree(&GlobalDebugArena, Changed, (sizeof *Changed) * SitesCount);
+    }
+    MVMArenaFree(&GlobalDebugArena, Totals, (sizeof *Totals) * SitesCount);
+    return(DiffsCount);
+}
+
+
+void MVMDebugMemoryPrintDiff(mvm_debug_memory_snapshot *Before, 
+                             mvm_debug_memory_snapshot *After)
+{
+    if(!GlobalDebugInfoList || !Before || !After)
+    {
+        return;
+    }
+    mvm_debug_memory_site_diff Diffs[DEBUG_PRINT_TOP_SITES_MAX];
+    size_t DiffsCount = 
+        MVMDebugMemoryDiff(Before, After, Diffs, DEBUG_PRINT_TOP_SITES_MAX);
+
+    printf("%s by call site over %.3f seconds:\n", 
+           GlobalDebugInfoList->SampleIntervalBytes ? 
+           "Estimated heap changes" : "Heap changes", 
+           (double)(int64_t)(After->Nanoseconds - Before->Nanoseconds) / 1e9);
+    if(!DiffsCount)
+    {
+        printf("\tNo changes.\n\n");
+        return;
+    }
+    printf("\t%10s %14s %10s %14s %10s %14s %14s  %s\n", 
+           "Added", "Added bytes", "Freed", "Freed bytes", 
+           "Resized", "Resized bytes", "Net bytes", "Site");
+    for(size_t DiffIndex = 0; DiffIndex < DiffsCount; DiffIndex++)
+    {
+        mvm_debug_memory_site_diff *Diff = Diffs + DiffIndex;
+        printf("\t%10llu %14llu %10llu %14llu %10llu %+14lld %+14lld  %s:%d\n", 
+               (unsigned long long)Diff->AddedCount, 
+               (unsigned long long)Diff->AddedBytes, 
+               (unsigned long long)Diff->FreedCount, 
+               (unsigned long long)Diff->FreedBytes, 
+               (unsigned long long)(Diff->GrownCount + Diff->ShrunkCount), 
+               (long long)Diff->GrownBytes - (long long)Diff->ShrunkBytes, 
+               (long long)Diff->NetBytes, 
+               Diff->Filename, 
+               Diff->LineNumber);
+    }
+    printf("\n");
+}
+
+
+#define DEBUG_LEAK_REPORT_MAX_ROWS 32
+
+// NOTE(Marko): qsort() has no context parameter, hence the global. Only the 
+//              leak report sorts with it, and only from one thread. 
+double *GlobalLeakSortEstimates = 0;
+uint32_t GlobalLeakSortKeysCount = 0;
+
+int MVMCompareLeaksByBytes(const void *A, const void *B)
+{
+    uint32_t SiteA = *(const uint32_t *)A;
+    uint32_t SiteB = *(const uint32_t *)B;
+    double *Bytes = GlobalLeakSortEstimates;
+    double *Counts = GlobalLeakSortEstimates + GlobalLeakSortKeysCount;
+    int Result = (Bytes[SiteA] < Bytes[SiteB]) - (Bytes[SiteA] > Bytes[SiteB]);
+    if(!Result)
+    {
+        Result = (Counts[SiteA] < Counts[SiteB]) - (Counts[SiteA] > Counts[SiteB]);
+    }
+    if(!Result)
+    {
+        Result = (SiteA > SiteB) - (SiteA < SiteB);
+    }
+    return(Result);
+}
+
+int MVMCompareLeaksByCount(const void *A, const void *B)
+{
+    uint32_t SiteA = *(const uint32_t *)A;
+    uint32_t SiteB = *(const uint32_t *)B;
+    double *Bytes = GlobalLeakSortEstimates;
+    double *Counts = GlobalLeakSortEstimates + GlobalLeakSortKeysCount;
+    int Result = (Counts[SiteA] < Counts[SiteB]) - (Counts[SiteA] > Counts[SiteB]);
+    if(!Result)
+    {
+        Result = (Bytes[SiteA] < Bytes[SiteB]) - (Bytes[SiteA] > Bytes[SiteB]);
+    }
+    if(!Result)
+    {
+        Result = (SiteA > SiteB) - (SiteA < SiteB);
+    }
+    return(Result);
+}
+
+
+void MVMPrintLeakTable(const char *Title, 
+                       uint32_t *LeakSites, 
+                       uint32_t LeakSitesCount, 
+                       double *BytesEstimates, 
+                       double *CountEstimates)
+{
+    uint32_t RowsCount = LeakSitesCount;
+    if(RowsCount > DEBUG_LEAK_REPORT_MAX_ROWS)
+    {
+        RowsCount = DEBUG_LEAK_REPORT_MAX_ROWS;
+    }
+    printf("%s:\n", Title);
+    printf("\t%14s %12s  %s\n", "Bytes", "Allocations", "Site");
+    for(uint32_t RowIndex = 0; RowIndex < RowsCount; RowIndex++)
+    {
+        uint32_t SiteID = LeakSites[RowIndex];
+        mvm_debug_memory_site *Site = MVMGetCallSite(SiteID);
+        printf("\t%14.0f %12.0f  %s:%d\n", 
+               BytesEstimates[SiteID], 
+               CountEstimates[SiteID], 
+               Site->Filename, 
+               Site->LineNumber);
+    }
+    if(RowsCount < LeakSitesCount)
+    {
+        printf("\t... %u more call sites\n", LeakSitesCount - RowsCount);
+    }
+    printf("\n");
+}
+
+
+#define DEBUG_LEAK_REPORT_MAX_STACKS 8
+
+// NOTE(Marko): The largest leaking call stacks, symbolized. 
+void MVMPrintLeakStacks(void)
+{
+    uint32_t StacksCount = 0;
+    double *Estimates = MVMGatherLiveEstimates(1, &StacksCount);
+    if(!Estimates)
+    {
+        return;
+    }
+    size_t LeakStacksSize = (sizeof(uint32_t)) * StacksCount;
+    uint32_t *LeakStacks = (uint32_t *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                        LeakStacksSize);
+    if(!LeakStacks)
+    {
+        printf("Debug arena allocation failed while reporting leaked call stacks.\n");
+        MVMArenaFree(&GlobalDebugArena, Estimates, 2 * (sizeof(double)) * StacksCount);
+        return;
+    }
+
+    uint32_t LeakStacksCount = 0;
+    for(uint32_t StackID = 0; StackID < StacksCount; StackID++)
+    {
+        if(Estimates[StacksCount + StackID] > 0.0)
+        {
+            LeakStacks[LeakStacksCount++] = StackID;
+        }
+    }
+    GlobalLeakSortEstimates = Estimates;
+    GlobalLeakSortKeysCount = StacksCount;
+    qsort(LeakStacks, LeakStacksCount, sizeof(uint32_t), 
+          MVMCompareLeaksByBytes);
+
+    uint32_t RowsCount = LeakStacksCount;
+    if(RowsCount > DEBUG_LEAK_REPORT_MAX_STACKS)
+    {
+        RowsCount = DEBUG_LEAK_REPORT_MAX_STACKS;
+    }
+    printf("Leaks by call stack:\n");
+    for(uint32_t RowIndex = 0; RowIndex < RowsCount; RowIndex++)
+    {
+        uint32_t StackID = LeakStacks[RowIndex];
+        printf("\t%.0f bytes in %.0f allocations from\n", 
+               Estimates[StackID], 
+               Estimates[StacksCount + StackID]);
+        mvm_debug_memory_stack *Stack = 
+            MVMGetStack(&GlobalDebugInfoList->StackTable, StackID);
+        if(Stack)
+        {
+            MVMPlatformPrintStackFrames(Stack->Frames, Stack->FramesCount);
+        }
+        else
+        {
+            printf("\t\t<no stack>\n");
+        }
+    }
+    if(RowsCount < LeakStacksCount)
+    {
+        printf("\t... %u more call stacks\n", LeakStacksCount - RowsCount);
+    }
+    printf("\n");
+
+    MVMArenaFree(&GlobalDebugArena, LeakStacks, LeakStacksSize);
+    MVMArenaFree(&GlobalDebugArena, Estimates, 2 * (sizeof(double)) * StacksCount);
+}
+
+
+// NOTE(Marko): One CSV row per leaking call site, largest first. Filenames 
+//              are quoted since paths may contain commas. 
+void MVMWriteLeakReportFile(const char *Filename, 
+                            uint32_t *LeakSites, 
+                            uint32_t LeakSitesCount, 
+                            double *BytesEstimates, 
+                            double *CountEstimates)
+{
+    FILE *File = fopen(Filename, "w");
+    if(!File)
+    {
+        printf("Could not open leak report file %s\n", Filename);
+        return;
+    }
+    fprintf(File, "bytes,allocations,file,line\n");
+    for(uint32_t RowIndex = 0; RowIndex < LeakSitesCount; RowIndex++)
+    {
+        uint32_t SiteID = LeakSites[RowIndex];
+        mvm_debug_memory_site *Site = MVMGetCallSite(SiteID);
+        fprintf(File, "%.0f,%.0f,\"", 
+                BytesEstimates[SiteID], 
+                CountEstimates[SiteID]);
+        for(const char *Char = Site->Filename; *Char; Char++)
+        {
+            if(*Char == '"')
+            {
+                fputc('"', File);
+            }
+            fputc(*Char, File);
+        }
+        fprintf(File, "\",%d\n", Site->LineNumber);
+    }
+    if(fclose(File) != 0)
+    {
+        printf("Failed to write leak report file %s\n", Filename);
+    }
+}
+
+
+// NOTE(Marko): Reports what is still live, grouped by the call site of each 
+//              allocation's initial malloc()/realloc(). Only the address 
+//              table is walked, so the cost is proportional to the number of 
+//              leaks rather than to the history. Returns the leaked bytes 
+//              (an estimate when sampling). Filename may be 0. 
+uint64_t MVMDebugMemoryReportLeaks(const char *Filename)
+{
+    if(!GlobalDebugInfoList)
+    {
+        return(0);
+    }
+
+    uint32_t SitesCount = 0;
+    double *Estimates = MVMGatherLiveEstimates(0, &SitesCount);
+    if(!Estimates)
+    {
+        printf("No leaks.\n\n");
+        return(0);
+    }
+    double *BytesEstimates = Estimates;
+    double *CountEstimates = Estimates + SitesCount;
+
+    size_t LeakSitesSize = (sizeof(uint32_t)) * SitesCount;
+    uint32_t *LeakSites = (uint32_t *)MVMArenaAllocate(&GlobalDebugArena, 
+                                                       LeakSitesSize);
+    if(!LeakSites)
+    {
+        printf("Debug arena allocation failed while reporting leaks.\n");
+        MVMArenaFree(&GlobalDebugArena, Estimates, 2 * (sizeof(double)) * SitesCount);
+        return(0);
+    }
+
+    uint32_t LeakSitesCount = 0;
+    double LeakedBytes = 0.0;
+    double LeakedCount = 0.0;
+    for(uint32_t SiteID = 0; SiteID < SitesCount; SiteID++)
+    {
+        if(CountEstimates[SiteID] > 0.0)
+        {
+            LeakSites[LeakSitesCount++] = SiteID;
+            LeakedBytes += BytesEstimates[SiteID];
+            LeakedCount += CountEstimates[SiteID];
+        }
+    }
+
+    if(!LeakSitesCount)
+    {
+        printf("No leaks.\n\n");
+    }
+    else
+    {
+        printf("%sLeaked %.0f bytes in %.0f allocations from %u call sites.\n\n", 
+               GlobalDebugInfoList->SampleIntervalBytes ? "Estimated: " : "", 
+               LeakedBytes, 
+               LeakedCount, 
+               LeakSitesCount);
+
+        GlobalLeakSortEstimates = Estimates;
+        GlobalLeakSortKeysCount = SitesCount;
+        qsort(LeakSites, LeakSitesCount, sizeof(uint32_t), 
+              MVMCompareLeaksByCount);
+        MVMPrintLeakTable("Leaks by allocation count", LeakSites, LeakSitesCount, 
+                          BytesEstimates, CountEstimates);
+        qsort(LeakSites, LeakSitesCount, sizeof(uint32_t), 
+              MVMCompareLeaksByBytes);
+        MVMPrintLeakTable("Leaks by bytes", LeakSites, LeakSitesCount, 
+                          BytesEstimates, CountEstimates);
+        if(GlobalDebugInfoList->StackDepth)
+        {
+            MVMPrintLeakStacks();
+        }
+    }
+    if(Filename)
+    {
+        MVMWriteLeakReportFile(Filename, LeakSites, LeakSitesCount, 
+                               BytesEstimates, CountEstimates);
+    }
+
+    MVMArenaFree(&GlobalDebugArena, LeakSites, LeakSitesSize);
+    MVMArenaFree(&GlobalDebugArena, Estimates, 2 * (sizeof(double)) * SitesCount);
+    return((uint64_t)(LeakedBytes + 0.5));
+}
+
+
+// NOTE(Marko): Registered with atexit() when ReportLeaksAtExit is set. An 
+//              atexit() handler cannot change the exit status through 
+//              exit(), so a failing run flushes stdio and leaves through 
+//              _Exit() instead, skipping any handlers registered before ours. 
+void MVMDebugMemoryLeakCheckAtExit(void)
+{
+    mvm_debug_memory_config *Config = &GlobalDebugConfig;
+    if(!GlobalDebugInfoList || !Config->ReportLeaksAtExit)
+    {
+        return;
+    }
+    uint64_t LeakedBytes = MVMDebugMemoryReportLeaks(Config->LeakReportFilename);
+    if(Config->LeakExitCode && (LeakedBytes > Config->LeakThresholdBytes))
+    {
+        printf("Leaked bytes exceed the threshold of %zu; exiting with code %d.\n", 
+               Config->LeakThresholdBytes, 
+               Config->LeakExitCode);
+        fflush(0);
+        _Exit(Config->LeakExitCode);
+    }
+}
+
+
+//
+// NOTE(Marko): Report writer. Formats the event log into one large buffer 
+//              and hands it to the OS a few megabytes at a time, instead of 
+//              going through printf() several times per event. 
+//
+
+#define DEBUG_REPORT_BUFFER_SIZE (4 * 1024 * 1024)
+
+typedef enum report_allocation_state
+{
+    ReportAllocationState_Any = 0,
+
+    // NOTE(Marko): Events of allocations that are still live. 
+    ReportAllocationState_Live,
+
+    // NOTE(Marko): Events of allocations that have been freed, including 
+    //              the free itself. 
+    ReportAllocationState_Freed,
+
+} report_allocation_state;
+
+
+// NOTE(Marko): Which events MVMDebugMemoryWriteReport() writes. A zeroed 
+//              filter lets everything through; every field that is set must 
+//              match. 
+typedef struct mvm_debug_memory_report_filter
+{
+    // NOTE(Marko): Bit (1 << memory_operation_type) for each type to keep. 
+    uint32_t OperationTypesMask;
+
+    // NOTE(Marko): Keeps sites whose filename ends in this, so "foo.c" 
+    //              matches "src/foo.c". 
+    const char *Filename;
+    int MinLineNumber;
+    int MaxLineNumber;
+
+    size_t MinBytes;
+    size_t MaxBytes;
+
+    report_allocation_state AllocationState;
+
+} mvm_debug_memory_report_filter;
+
+
+typedef struct mvm_debug_memory_report_writer
+{
+    mvm_debug_memory_file File;
+    char *Buffer;
+    size_t BufferSize;
+    size_t BytesUsed;
+    int Failed;
+
+} mvm_debug_memory_report_writer;
+
+
+void MVMReportFlush(mvm_debug_memory_report_writer *Writer)
+{
+    if(Writer->BytesUsed && !Writer->Failed)
+    {
+        Writer->Failed = !MVMPlatformWriteFile(&Writer->File, 
+                                               Writer->Buffer, 
+                                               Writer->BytesUsed);
+    }
+    Writer->BytesUsed = 0;
+}
+
+
+void MVMReportAppendBytes(mvm_debug_memory_report_writer *Writer, 
+                          const char *Bytes, 
+                          size_t Size)
+{
+    while(Size)
+    {
+        if(Writer->BytesUsed == Writer->BufferSize)
+        {
+            MVMReportFlush(Writer);
+        }
+        size_t ChunkSize = Writer->BufferSize - Writer->BytesUsed;
+        if(ChunkSize > Size)
+        {
+            ChunkSize = Size;
+        }
+        memcpy(Writer->Buffer + Writer->BytesUsed, Bytes, ChunkSize);
+        Writer->BytesUsed += ChunkSize;
+        Bytes += ChunkSize;
+        Size -= ChunkSize;
+    }
+}
+
+
+void MVMReportAppendString(mvm_debug_memory_report_writer *Writer, 
+                           const char *String)
+{
+    MVMReportAppendBytes(Writer, String, strlen(String));
+}
+
+
+void MVMReportAppendU64(mvm_debug_memory_report_writer *Writer, 
+                        uint64_t Value)
+{
+    char Digits[20];
+    int DigitsCount = 0;
+    do
+    {
+        Digits[sizeof(Digits) - 1 - DigitsCount++] = (char)('0' + (Value % 10));
+        Value /= 10;
+    } while(Value);
+    MVMReportAppendBytes(Writer, 
+                         Digits + sizeof(Digits) - DigitsCount, 
+                         (size_t)DigitsCount);
+}
+
+
+void MVMReportAppendAddress(mvm_debug_memory_report_writer *Writer, 
+                            uint64_t Address)
+{
+    static const char HexDigits[] = "0123456789abcdef";
+    char Digits[18];
+    int DigitsCount = 0;
+    do
+    {
+        Digits[sizeof(Digits) - 1 - DigitsCount++] = HexDigits[Address & 0xF];
+        Address >>= 4;
+    } while(Address);
+    Digits[sizeof(Digits) - 1 - DigitsCount++] = 'x';
+    Digits[sizeof(Digits) - 1 - DigitsCount++] = '0';
+    MVMReportAppendBytes(Writer, 
+                         Digits + sizeof(Digits) - DigitsCount, 
+                         (size_t)DigitsCount);
+}
+
+
+// NOTE(Marko): Site-level parts of the filter, decided once per call site 
+//              rather than once per event. 
+uint8_t *MVMMatchReportSites(mvm_debug_memory_report_filter *Filter, 
+                             uint32_t SitesCount)
+{
+    uint8_t *Result = (uint8_t *)MVMArenaAllocate(&GlobalDebugArena, SitesCount);
+    if(!Result)
+    {
+        return(Result);
+    }
+    size_t SuffixLength = Filter->Filename ? strlen(Filter->Filename) : 0;
+    for(uint32_t SiteID = 0; SiteID < SitesCount; SiteID++)
+    {
+        mvm_debug_memory_site *Site = MVMGetCallSite(SiteID);
+        int Matches = 1;
+        if(Filter->Filename)
+        {
+            size_t FilenameLength = strlen(Site->Filename);
+            Matches = (FilenameLength >= SuffixLength) && 
+                !memcmp(Site->Filename + FilenameLength - SuffixLength, 
+                        Filter->Filename, 
+                        SuffixLength);
+        }
+        if(Filter->MinLineNumber && (Site->LineNumber < Filter->MinLineNumber))
+        {
+            Matches = 0;
+        }
+        if(Filter->MaxLineNumber && (Site->LineNumber > Filter->MaxLineNumber))
+        {
+            Matches = 0;
+        }
+        Result[SiteID] = (uint8_t)Matches;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): One bit per event slot, set for every event on the chain of 
+//              an allocation that is still live. Walks only the live table 
+//              and those chains, never the whole log. 
+uint8_t *MVMMarkLiveEvents(size_t *BitmapSizeOut)
+{
+    uint64_t SlotsCount = GlobalDebugInfoList->EventsReserved;
+    if(GlobalDebugInfoList->EventRingCapacity && 
+       (SlotsCount > GlobalDebugInfoList->EventRingCapacity))
+    {
+        SlotsCount = GlobalDebugInfoList->EventRingCapacity;
+    }
+    size_t BitmapSize = (size_t)(SlotsCount / 8) + 1;
+    uint8_t *Bitmap = (uint8_t *)MVMArenaAllocate(&GlobalDebugArena, BitmapSize);
+    if(!Bitmap)
+    {
+        return(Bitmap);
+    }
+
+    for(int ShardIndex = 0; 
+        ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT; 
+        ShardIndex++)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            GlobalDebugInfoList->AddressTables + ShardIndex;
+        MVMLockAcquire(&AddressTable->Lock);
+        for(size_t SlotIndex = 0; 
+            SlotIndex < AddressTable->SlotsAllocated; 
+            SlotIndex++)
+        {
+            mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+            if((Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_EMPTY) || 
+               (Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_TOMBSTONE))
+            {
+                continue;
+            }
+            uint64_t EventIndex = Slot->LastEventIndex;
+            mvm_debug_memory_event *Event = MVMGetEvent(EventIndex);
+            while(Event)
+            {
+                uint64_t BitIndex = EventIndex % SlotsCount;
+                Bitmap[BitIndex >> 3] |= (uint8_t)(1 << (BitIndex & 7));
+                EventIndex = MVMGetPreviousEventIndex(EventIndex, Event);
+                Event = MVMGetEvent(EventIndex);
+            }
+        }
+        MVMLockRelease(&AddressTable->Lock);
+    }
+
+    *BitmapSizeOut = BitmapSize;
+    return(Bitmap);
+}
+
+
+void MVMReportWriteEvent(mvm_debug_memory_report_writer *Writer, 
+                         uint64_t EventIndex, 
+                         mvm_debug_memory_event *Event, 
+                         mvm_debug_memory_site *Site)
+{
+    MVMReportAppendString(Writer, "\t---------\n\tMemory Operation #");
+    MVMReportAppendU64(Writer, EventIndex);
+    MVMReportAppendString(Writer, "\n\t\tMemory Operation Type: ");
+    switch(MVMGetEventType(Event))
+    {
+        case MemoryOperationType_InitialAllocation: 
+        {
+            MVMReportAppendString(Writer, "Initial Allocation.\n\t\tAllocated ");
+            MVMReportAppendU64(Writer, Event->ByteCount);
+            MVMReportAppendString(Writer, " bytes into address ");
+            MVMReportAppendAddress(Writer, Event->Address);
+            MVMReportAppendString(Writer, "\n");
+        } break;
+
+        case MemoryOperationType_ReAllocation: 
+        {
+            mvm_debug_memory_event *PreviousEvent = 
+                MVMGetEvent(MVMGetPreviousEventIndex(EventIndex, Event));
+            mvm_debug_memory_event *InitialEvent = 
+                MVMFindInitialEvent(EventIndex);
+
+            MVMReportAppendString(Writer, "Reallocation\n");
+            if(PreviousEvent)
+            {
+                MVMReportAppendString(Writer, "\t\tOld allocation: ");
+                MVMReportAppendU64(Writer, PreviousEvent->ByteCount);
+                MVMReportAppendString(Writer, " bytes from address ");
+                MVMReportAppendAddress(Writer, PreviousEvent->Address);
+                MVMReportAppendString(Writer, "\n");
+            }
+            MVMReportAppendString(Writer, "\t\tNew allocation: ");
+            MVMReportAppendU64(Writer, Event->ByteCount);
+            MVMReportAppendString(Writer, " bytes into address ");
+            MVMReportAppendAddress(Writer, Event->Address);
+            MVMReportAppendString(Writer, "\n");
+            if(PreviousEvent)
+            {
+                int Grew = (Event->ByteCount >= PreviousEvent->ByteCount);
+                MVMReportAppendString(Writer, Grew ? 
+                                      "\t\tAllocation changed by +" : 
+                                      "\t\tAllocation changed by -");
+                MVMReportAppendU64(Writer, Grew ? 
+                                   (Event->ByteCount - PreviousEvent->ByteCount) : 
+                                   (PreviousEvent->ByteCount - Event->ByteCount));
+                MVMReportAppendString(Writer, " bytes\n");
+            }
+            if(InitialEvent)
+            {
+                MVMReportAppendString(Writer, "\t\tInitial address: ");
+                MVMReportAppendAddress(Writer, InitialEvent->Address);
+                MVMReportAppendString(Writer, "\n");
+            }
+        } break;
+
+        case MemoryOperationType_Free: 
+        {
+            mvm_debug_memory_event *InitialEvent = 
+                MVMFindInitialEvent(EventIndex);
+
+            MVMReportAppendString(Writer, "Free\n\t\tFreed ");
+            MVMReportAppendU64(Writer, Event->ByteCount);
+            MVMReportAppendString(Writer, " bytes from address ");
+            MVMReportAppendAddress(Writer, Event->Address);
+            MVMReportAppendString(Writer, "\n");
+            if(InitialEvent)
+            {
+                MVMReportAppendString(Writer, 
+                                      "\t\tMemory Initially allocated into address ");
+                MVMReportAppendAddress(Writer, InitialEvent->Address);
+                MVMReportAppendString(Writer, "\n");
+            }
+        } break;
+
+        case MemoryOperationType_Comment: 
+        {
+            MVMReportAppendString(Writer, "Comment\n");
+        } break;
+
+        case MemoryOperationType_TurnOn: 
+        {
+            MVMReportAppendString(Writer, "Turn On Debug Tool\n");
+        } break;
+        
+        case MemoryOperationType_TurnOff: 
+        {
+            MVMReportAppendString(Writer, "Turn Off Debug Tool\n");
+        } break;
+
+        default: 
+        {
+            MVMReportAppendString(Writer, "Not Assigned\n");
+        } break;
+    }
+    MVMReportAppendString(Writer, "\t\tin file ");
+    MVMReportAppendString(Writer, Site->Filename);
+    MVMReportAppendString(Writer, "\n\t\ton line ");
+    MVMReportAppendU64(Writer, (uint64_t)(int64_t)Site->LineNumber);
+    MVMReportAppendString(Writer, "\n");
+}
+
+
+// NOTE(Marko): Writes the events that pass Filter (0 for all of them) in 
+//              time order to FileDescriptor, which stays open. Anything 
+//              buffered in stdio is flushed first so the two do not 
+//              interleave. Returns 0 if the report could not be written. 
+int MVMDebugMemoryWriteReport(int FileDescriptor, 
+                              mvm_debug_memory_report_filter *Filter)
+{
+    mvm_debug_memory_report_filter NoFilter = {0};
+    if(!Filter)
+    {
+        Filter = &NoFilter;
+    }
+    if(!GlobalDebugInfoList)
+    {
+        return(0);
+    }
+
+    mvm_debug_memory_report_writer Writer = {0};
+    if(!MVMPlatformFileFromDescriptor(&Writer.File, FileDescriptor))
+    {
+        printf("Invalid file descriptor %d for the memory report.\n", 
+               FileDescriptor);
+        return(0);
+    }
+    if(!GlobalDebugInfoList->ReportBuffer)
+    {
+        GlobalDebugInfoList->ReportBuffer = 
+            (char *)MVMArenaAllocate(&GlobalDebugArena, DEBUG_REPORT_BUFFER_SIZE);
+        if(!GlobalDebugInfoList->ReportBuffer)
+        {
+            printf("Debug arena allocation failed while allocating the report buffer.\n");
+            return(0);
+        }
+    }
+    Writer.Buffer = GlobalDebugInfoList->ReportBuffer;
+    Writer.BufferSize = DEBUG_REPORT_BUFFER_SIZE;
+
+    uint32_t SitesCount = GlobalDebugInfoList->SiteTable.SitesCount;
+    uint8_t *SiteMatches = 0;
+    if(Filter->Filename || Filter->MinLineNumber || Filter->MaxLineNumber)
+    {
+        SiteMatches = MVMMatchReportSites(Filter, SitesCount);
+        if(!SiteMatches)
+        {
+            printf("Debug arena allocation failed while filtering the report.\n");
+            return(0);
+        }
+    }
+    uint8_t *LiveEvents = 0;
+    size_t LiveEventsSize = 0;
+    uint64_t LiveEventSlotsCount = 0;
+    if(Filter->AllocationState != ReportAllocationState_Any)
+    {
+        LiveEvents = MVMMarkLiveEvents(&LiveEventsSize);
+        if(!LiveEvents)
+        {
+            printf("Debug arena allocation failed while filtering the report.\n");
+            if(SiteMatches)
+            {
+                MVMArenaFree(&GlobalDebugArena, SiteMatches, SitesCount);
+            }
+            return(0);
+        }
+        LiveEventSlotsCount = GlobalDebugInfoList->EventsReserved;
+        if(GlobalDebugInfoList->EventRingCapacity && 
+           (LiveEventSlotsCount > GlobalDebugInfoList->EventRingCapacity))
+        {
+            LiveEventSlotsCount = GlobalDebugInfoList->EventRingCapacity;
+        }
+    }
+    size_t MaxBytes = Filter->MaxBytes ? Filter->MaxBytes : (size_t)-1;
+
+    fflush(0);
+    MVMReportAppendString(&Writer, "\n\n------------\n");
+
+    // NOTE(Marko): Stream through the log in time order. Only a realloc or 
+    //              free has to look anywhere else, to find the event(s) it 
+    //              continues. 
+    mvm_debug_memory_event_merge Merge;
+    MVMBeginEventMerge(&Merge);
+    for(uint64_t EventIndex = MVMNextMergedEvent(&Merge); 
+        EventIndex != DEBUG_EVENT_INDEX_NONE; 
+        EventIndex = MVMNextMergedEvent(&Merge))
+    {
+        mvm_debug_memory_event *Event = MVMGetEvent(EventIndex);
+        memory_operation_type Type = MVMGetEventType(Event);
+        uint32_t SiteID = MVMGetEventSiteID(Event);
+
+        if(Filter->OperationTypesMask && 
+           !(Filter->OperationTypesMask & (1u << Type)))
+        {
+            continue;
+        }
+        if(SiteMatches && (SiteID < SitesCount) && !SiteMatches[SiteID])
+        {
+            continue;
+        }
+        if((Event->ByteCount < Filter->MinBytes) || (Event->ByteCount > MaxBytes))
+        {
+            continue;
+        }
+        if(LiveEvents)
+        {
+            if((Type != MemoryOperationType_InitialAllocation) && 
+               (Type != MemoryOperationType_ReAllocation) && 
+               (Type != MemoryOperationType_Free))
+            {
+                continue;
+            }
+            uint64_t BitIndex = EventIndex % LiveEventSlotsCount;
+            int IsLive = (LiveEvents[BitIndex >> 3] >> (BitIndex & 7)) & 1;
+            if(IsLive != (Filter->AllocationState == ReportAllocationState_Live))
+            {
+                continue;
+            }
+        }
+
+        MVMReportWriteEvent(&Writer, EventIndex, Event, MVMGetCallSite(SiteID));
+    }
+    MVMEndEventMerge(&Merge);
+    MVMReportAppendString(&Writer, "--------------------------------------------\n\n\n\n");
+    MVMReportFlush(&Writer);
+
+    if(LiveEvents)
+    {
+        MVMArenaFree(&GlobalDebugArena, LiveEvents, LiveEventsSize);
+    }
+    if(SiteMatches)
+    {
+        MVMArenaFree(&GlobalDebugArena, SiteMatches, SitesCount);
+    }
+    if(Writer.Failed)
+    {
+        printf("Failed to write the memory report to file descriptor %d.\n", 
+               FileDescriptor);
+    }
+    return(!Writer.Failed);
+}
+
+
+void MVMDebugMemoryPrintAllocations(void)
+{
+    printf("*************************************************************\n");
+    printf("*************************************************************\n");
+    printf("Printing memory allocation information. \n\n");
+
+    if(!GlobalDebugInfoList)
+    {
+        printf("Nothing recorded: MVMTurnOnDebugInfo() was never called.\n\n");
+        return;
+    }
+
+    uint64_t EventsCount = 0;
+    for(mvm_debug_memory_thread_state *ThreadState = 
+            GlobalDebugInfoList->Threads; 
+        ThreadState; 
+        ThreadState = ThreadState->Next)
+    {
+        EventsCount += ThreadState->EventsCount;
+    }
+
+    printf("Turn on - Turn Off calls (0 means debug is off now): %zu\n", 
+           GlobalDebugInfoList->TurnOnCount);
+    printf("Debug Memory Events Count: %llu\n", 
+           (unsigned long long)EventsCount);
+    if(GlobalDebugInfoList->TraceWriter)
+    {
+        printf("Events are being streamed to the trace file, not kept in memory.\n");
+    }
+    if(GlobalDebugInfoList->EventRingCapacity)
+    {
+        uint64_t EventsReserved = GlobalDebugInfoList->EventsReserved;
+        uint64_t EventsOverwritten = 
+            (EventsReserved > GlobalDebugInfoList->EventRingCapacity) ? 
+            (EventsReserved - GlobalDebugInfoList->EventRingCapacity) : 0;
+        printf("Event Ring Capacity: %llu (%llu oldest event slots overwritten)\n", 
+               (unsigned long long)GlobalDebugInfoList->EventRingCapacity,
+               (unsigned long long)EventsOverwritten);
+    }
+    printf("Threads Recorded: %u\n", 
+           GlobalDebugInfoList->ThreadsCount);
+    printf("Live Allocations Count: %zu\n", 
+           MVMCountLiveAllocations());
+    if(GlobalDebugInfoList->StackDepth)
+    {
+        uint32_t StacksCount = GlobalDebugInfoList->StackTable.StacksCount;
+        printf("Call Stacks Recorded: %u\n", StacksCount ? (StacksCount - 1) : 0);
+    }
+    printf("Debug Memory Bytes In Use: %zu\n", 
+           GlobalDebugArena.BytesInUse);
+    printf("Debug Memory Bytes Mapped: %zu\n", 
+           GlobalDebugArena.BytesMapped);
+    printf("\n");
+    if(GlobalDebugInfoList->SampleIntervalBytes)
+    {
+        MVMDebugMemoryPrintLiveSites();
+    }
+    MVMDebugMemoryPrintHighWaterMark();
+    MVMDebugMemoryPrintTopSites(SiteStatMetric_LiveBytes, 10);
+    MVMDebugMemoryPrintTimeline();
+
+    MVMDebugMemoryWriteReport(1, 0);
+}
+
+
+//
+// NOTE(Marko): Optional C++ layer. #define MVM_DEBUG_MEMORY_NEW before 
+//              including the header to replace the global operator new and 
+//              delete, in their plain, array, nothrow, sized and aligned 
+//              forms. Blocks are tracked like malloc() ones, under the sites 
+//              "<new>" and "<new[]>"; turn on StackDepth to see where they 
+//              come from, or write MVM_DEBUG_NEW instead of new to record 
+//              the file and line (#define new MVM_DEBUG_NEW after including 
+//              the header does this for a whole file). 
+//
+//              A block released by the wrong family (new with free(), new[] 
+//              with delete, malloc() with delete), a sized delete whose size 
+//              differs from the one allocated, or an aligned delete whose 
+//              alignment does is reported, from the record that the release 
+//              looks up anyway. 
+//
+
+#if defined(__cplusplus) && defined(MVM_DEBUG_MEMORY) && \
+    defined(MVM_DEBUG_MEMORY_NEW)
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    #define MVM_DEBUG_THROW_BAD_ALLOC() throw std::bad_alloc()
+#else
+    #define MVM_DEBUG_THROW_BAD_ALLOC() abort()
+#endif
+
+
+MVM_DEBUG_NOINLINE 
+void *MVMDebugOperatorNew(size_t MemorySize, 
+                          size_t Alignment, 
+                          allocation_kind Kind, 
+                          int NoThrow, 
+                          const char *Filename, 
+                          int LineNumber, 
+                          uint32_t ToolFrames)
+{
+    // NOTE(Marko): new hands out distinct pointers even for 0 bytes. 
+    size_t AllocationSize = MemorySize ? MemorySize : 1;
+    void *Result = 0;
+    uint8_t BlockFlags = 0;
+    for(;;)
+    {
+        Result = MVMAllocateBlock(AllocationSize, Alignment, 0, 
+                                  Filename, LineNumber, &BlockFlags);
+        if(Result)
+        {
+            break;
+        }
+
+        // NOTE(Marko): Out of memory. Like the standard operators, let the 
+        //              new_handler try to make room before giving up. 
+        std::new_handler Handler = std::get_new_handler();
+        if(!Handler)
+        {
+            if(NoThrow)
+            {
+                break;
+            }
+            MVM_DEBUG_THROW_BAD_ALLOC();
+        }
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+        if(NoThrow)
+        {
+            try
+            {
+                Handler();
+            }
+            catch(...)
+            {
+                break;
             }
+            continue;
         }
-        printf("--------------------------------------------\n\n");
-    }      
-    printf("\n\n");
+#endif
+        Handler();
+    }
+    MVMTrackAllocation(Result, MemorySize, Alignment, Kind, BlockFlags, 
+                       Filename, LineNumber, ToolFrames + 1);
+    return(Result);
+}
+
+
+void MVMDebugOperatorDelete(void *Buffer, 
+                            size_t MemorySize, 
+                            size_t Alignment, 
+                            allocation_kind Kind)
+{
+    void *Memory = MVMUntrackAllocation(Buffer, Kind, MemorySize, Alignment, 
+                                        (Kind == AllocationKind_NewArray) ? 
+                                        "<delete[]>" : "<delete>", 0);
+#if defined(_WIN32)
+    if(Alignment)
+    {
+        MVM_DEBUG_REAL_ALIGNED_FREE(Memory);
+        return;
+    }
+#endif
+    MVM_DEBUG_REAL_FREE(Memory);
+}
+
+
+MVM_DEBUG_NOINLINE void *operator new(size_t Size)
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_New, 0, 
+                               "<new>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new[](size_t Size)
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_NewArray, 0, 
+                               "<new[]>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new(size_t Size, 
+                                      const std::nothrow_t &) noexcept
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_New, 1, 
+                               "<new>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new[](size_t Size, 
+                                        const std::nothrow_t &) noexcept
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_NewArray, 1, 
+                               "<new[]>", 0, 1));
+}
+
+// NOTE(Marko): The MVM_DEBUG_NEW forms. 
+MVM_DEBUG_NOINLINE void *operator new(size_t Size, 
+                                      const char *Filename, 
+                                      int LineNumber)
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_New, 0, 
+                               Filename, LineNumber, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new[](size_t Size, 
+                                        const char *Filename, 
+                                        int LineNumber)
+{
+    return(MVMDebugOperatorNew(Size, 0, AllocationKind_NewArray, 0, 
+                               Filename, LineNumber, 1));
+}
+
+void operator delete(void *Buffer) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_NewArray);
+}
+
+void operator delete(void *Buffer, const std::nothrow_t &) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, const std::nothrow_t &) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_NewArray);
+}
+
+// NOTE(Marko): Only called when a constructor throws inside MVM_DEBUG_NEW. 
+void operator delete(void *Buffer, const char *, int) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, const char *, int) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, 0, AllocationKind_NewArray);
+}
+
+#if defined(__cpp_sized_deallocation)
+
+void operator delete(void *Buffer, size_t Size) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, Size, 0, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, size_t Size) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, Size, 0, AllocationKind_NewArray);
+}
+
+#endif
+
+#if defined(__cpp_aligned_new)
+
+MVM_DEBUG_NOINLINE void *operator new(size_t Size, std::align_val_t Alignment)
+{
+    return(MVMDebugOperatorNew(Size, (size_t)Alignment, AllocationKind_New, 0, 
+                               "<new>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new[](size_t Size, 
+                                        std::align_val_t Alignment)
+{
+    return(MVMDebugOperatorNew(Size, (size_t)Alignment, 
+                               AllocationKind_NewArray, 0, 
+                               "<new[]>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new(size_t Size, 
+                                      std::align_val_t Alignment, 
+                                      const std::nothrow_t &) noexcept
+{
+    return(MVMDebugOperatorNew(Size, (size_t)Alignment, AllocationKind_New, 1, 
+                               "<new>", 0, 1));
+}
+
+MVM_DEBUG_NOINLINE void *operator new[](size_t Size, 
+                                        std::align_val_t Alignment, 
+                                        const std::nothrow_t &) noexcept
+{
+    return(MVMDebugOperatorNew(Size, (size_t)Alignment, 
+                               AllocationKind_NewArray, 1, 
+                               "<new[]>", 0, 1));
+}
+
+void operator delete(void *Buffer, std::align_val_t Alignment) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, (size_t)Alignment, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, std::align_val_t Alignment) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, (size_t)Alignment, 
+                           AllocationKind_NewArray);
 }
 
+void operator delete(void *Buffer, 
+                     std::align_val_t Alignment, 
+                     const std::nothrow_t &) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, (size_t)Alignment, AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, 
+                       std::align_val_t Alignment, 
+                       const std::nothrow_t &) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, 0, (size_t)Alignment, 
+                           AllocationKind_NewArray);
+}
+
+void operator delete(void *Buffer, 
+                     size_t Size, 
+                     std::align_val_t Alignment) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, Size, (size_t)Alignment, 
+                           AllocationKind_New);
+}
+
+void operator delete[](void *Buffer, 
+                       size_t Size, 
+                       std::align_val_t Alignment) noexcept
+{
+    MVMDebugOperatorDelete(Buffer, Size, (size_t)Alignment, 
+                           AllocationKind_NewArray);
+}
+
+#endif
+
+#endif
+
 
 // NOTE(Marko): These #define replacements need to come after the function 
 //              declarations to avoid infinite recursion problems. 
@@ -1231,6 +8713,29 @@ void MVMDebugMemoryPrintAllocations(void)
     #define malloc(n) MVMDebugMalloc(n, __FILE__, __LINE__)
     #define realloc(m, n) MVMDebugRealloc(m, n, __FILE__, __LINE__)
     #define free(n) MVMDebugFree(n, __FILE__, __LINE__)
+    #define calloc(c, n) MVMDebugCalloc(c, n, __FILE__, __LINE__)
+    #define reallocarray(m, c, n) MVMDebugReallocArray(m, c, n, __FILE__, __LINE__)
+
+    // NOTE(Marko): Some C libraries define these as macros of their own. 
+    #undef strdup
+    #undef strndup
+    #define strdup(s) MVMDebugStrdup(s, __FILE__, __LINE__)
+    #define strndup(s, n) MVMDebugStrndup(s, n, __FILE__, __LINE__)
+
+    #if defined(_WIN32)
+        #define _strdup(s) MVMDebugStrdup(s, __FILE__, __LINE__)
+        #define _aligned_malloc(n, a) MVMDebugAlignedMalloc(n, a, __FILE__, __LINE__)
+        #define _aligned_free(m) MVMDebugAlignedFree(m, __FILE__, __LINE__)
+    #else
+        #define posix_memalign(m, a, n) MVMDebugPosixMemalign(m, a, n, __FILE__, __LINE__)
+        #define aligned_alloc(a, n) MVMDebugAlignedAlloc(a, n, __FILE__, __LINE__)
+    #endif
+
+    #if defined(__cplusplus) && defined(MVM_DEBUG_MEMORY_NEW)
+        #define MVM_DEBUG_NEW new(__FILE__, __LINE__)
+    #else
+        #define MVM_DEBUG_NEW new
+    #endif
 
     #define MVMTurnOnDebugInfo() MVMTurnOnDebugInfo(__FILE__, __LINE__)
     #define MVMTurnOffDebugInfo() MVMTurnOffDebugInfo(__FILE__, __LINE__)
@@ -1246,6 +8751,26 @@ void MVMDebugMemoryPrintAllocations(void)
     #define FreeDebugInfo()
     #define MVMTurnOnDebugInfo() 
     #define MVMTurnOffDebugInfo() 
+    #define MVMDebugMemoryShutdown() 
+    #define MVMDebugMemoryInitialize(Config) (1)
+    #define MVMDebugMemoryGetTopSites(Metric, Reports, MaxReports) (0)
+    #define MVMDebugMemoryPrintTopSites(Metric, MaxSites) 
+    #define MVMDebugMemoryPrintSizeClasses(MaxSites) 
+    #define MVMDebugMemoryPrintLifetimes(MaxSites) 
+    #define MVMDebugMemoryPrintReallocPatterns(MaxSites) 
+    #define MVMDebugMemoryPrintHighWaterMark() 
+    #define MVMDebugMemoryGetTimeline(Samples, MaxSamples, IntervalSeconds) (0)
+    #define MVMDebugMemoryPrintTimeline() 
+    #define MVMDebugMemoryReportLeaks(Filename) (0)
+    #define MVMDebugMemoryWriteReport(FileDescriptor, Filter) (1)
+    #define MVMDebugMemoryCheckRedzones() (0)
+    #define MVMDebugMemoryGuardSite(Filename, LineNumber) (1)
+    #define MVMDebugMemoryFlushQuarantine()
+    #define MVMDebugMemorySnapshot() (0)
+    #define MVMDebugMemoryFreeSnapshot(Snapshot) 
+    #define MVMDebugMemoryDiff(Before, After, Diffs, MaxDiffs) (0)
+    #define MVMDebugMemoryPrintDiff(Before, After) 
+    #define MVM_DEBUG_NEW new
 
 #endif
 
@@ -0,0 +1,864 @@
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+// NOTE(Marko): Included without MVM_DEBUG_MEMORY so that malloc() and free()
+//              below are the real ones; only the trace format and the
+//              platform layer are used.
+#include "mvm_debug_memory.h"
+
+/*
+    NOTE(Marko): Offline analyzer for traces written with
+                 mvm_debug_memory_config.TraceFilename. Maps the trace, splits
+                 it into its chunks and decodes those on every core, then
+                 rebuilds each allocation's chain (initial allocation, any
+                 reallocations, the free) from the events' back links.
+
+                 Prints the peak of live memory, the allocations still live
+                 at the end of the trace grouped by call site, and per-site
+                 totals. Sampled traces are scaled back up like the
+                 in-process report does.
+
+                 USAGE: mvm_debug_memory_analyzer TraceFile [ThreadsCount] [TopSitesCount]
+                        ThreadsCount defaults to the number of cores.
+                        TopSitesCount defaults to 20.
+*/
+
+#define ANALYZER_MAX_THREADS 64
+#define ANALYZER_DEFAULT_TOP_SITES 20
+#define ANALYZER_EVENT_NONE ((uint64_t)-1)
+
+
+typedef struct analyzer_site
+{
+    const char *Filename;
+    uint32_t FilenameLength;
+    int32_t LineNumber;
+
+} analyzer_site;
+
+
+typedef struct analyzer_event_chunk
+{
+    uint64_t FirstEventIndex;
+    uint32_t EventsCount;
+    mvm_debug_memory_event *Events;
+
+} analyzer_event_chunk;
+
+
+typedef struct analyzer_site_stats
+{
+    double AllocationsCount;
+    double BytesAllocated;
+    double ReallocationsCount;
+    double FreesCount;
+    double LiveCount;
+    double LiveBytes;
+
+} analyzer_site_stats;
+
+
+typedef struct analyzer
+{
+    uint8_t *Trace;
+    size_t TraceSize;
+    mvm_debug_memory_trace_header *Header;
+
+    uint32_t SitesCount;
+    uint32_t SitesAllocated;
+    analyzer_site *Sites;
+
+    size_t EventChunksCount;
+    size_t EventChunksAllocated;
+    analyzer_event_chunk *EventChunks;
+
+    // NOTE(Marko): One past the highest event index in the trace. The arrays
+    //              below are indexed by event index; indices that were
+    //              reserved but never filled stay empty.
+    uint64_t EventIndexLimit;
+    mvm_debug_memory_event **EventsByIndex;
+    uint64_t *NextEventIndices;
+    double *LiveByteDeltas;
+
+    // NOTE(Marko): Work distribution. Each pass hands out event chunks one
+    //              at a time through this counter.
+    volatile uint64_t NextChunkToProcess;
+    int ThreadsCount;
+    analyzer_site_stats *ThreadSiteStats[ANALYZER_MAX_THREADS];
+
+} analyzer;
+
+
+typedef void analyzer_chunk_proc(analyzer *Analyzer,
+                                 analyzer_event_chunk *Chunk,
+                                 int ThreadIndex);
+
+typedef struct analyzer_worker
+{
+    analyzer *Analyzer;
+    analyzer_chunk_proc *ChunkProc;
+    int ThreadIndex;
+    mvm_debug_memory_thread Thread;
+
+} analyzer_worker;
+
+
+double GetWallClockSeconds(void)
+{
+    return (double)MVMPlatformReadNanoseconds() * 1e-9;
+}
+
+
+int GetProcessorCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    return (int)SystemInfo.dwNumberOfProcessors;
+#else
+    long ProcessorCount = sysconf(_SC_NPROCESSORS_ONLN);
+    return (ProcessorCount > 0) ? (int)ProcessorCount : 1;
+#endif
+}
+
+
+// NOTE(Marko): Maps the whole file read-only. Returns 0 on failure.
+uint8_t *MapFileForReading(const char *Filename, size_t *Size)
+{
+    uint8_t *Result = 0;
+#if defined(_WIN32)
+    HANDLE File = CreateFileA(Filename, GENERIC_READ, FILE_SHARE_READ, 0,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(File != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize;
+        if(GetFileSizeEx(File, &FileSize) && FileSize.QuadPart)
+        {
+            HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+            if(Mapping)
+            {
+                Result = (uint8_t *)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(Mapping);
+                *Size = (size_t)FileSize.QuadPart;
+            }
+        }
+        CloseHandle(File);
+    }
+#else
+    int Descriptor = open(Filename, O_RDONLY);
+    if(Descriptor >= 0)
+    {
+        struct stat FileStatus;
+        if((fstat(Descriptor, &FileStatus) == 0) && FileStatus.st_size)
+        {
+            void *Mapping = mmap(0, (size_t)FileStatus.st_size, PROT_READ,
+                                 MAP_PRIVATE, Descriptor, 0);
+            if(Mapping != MAP_FAILED)
+            {
+                // NOTE(Marko): Chunks are read front to back.
+                madvise(Mapping, (size_t)FileStatus.st_size, MADV_SEQUENTIAL);
+                Result = (uint8_t *)Mapping;
+                *Size = (size_t)FileStatus.st_size;
+            }
+        }
+        close(Descriptor);
+    }
+#endif
+    return(Result);
+}
+
+
+void UnmapFile(uint8_t *Memory, size_t Size)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(Memory);
+#else
+    munmap(Memory, Size);
+#endif
+}
+
+
+int AddSite(analyzer *Analyzer, uint32_t SiteID, analyzer_site *Site)
+{
+    if(SiteID >= Analyzer->SitesAllocated)
+    {
+        uint32_t NewSitesAllocated =
+            Analyzer->SitesAllocated ? Analyzer->SitesAllocated : 256;
+        while(NewSitesAllocated <= SiteID)
+        {
+            NewSitesAllocated *= 2;
+        }
+        analyzer_site *NewSites = (analyzer_site *)realloc(
+            Analyzer->Sites, (sizeof *NewSites) * NewSitesAllocated);
+        if(!NewSites)
+        {
+            return(0);
+        }
+        memset(NewSites + Analyzer->SitesAllocated,
+               0,
+               (sizeof *NewSites) * (NewSitesAllocated - Analyzer->SitesAllocated));
+        Analyzer->Sites = NewSites;
+        Analyzer->SitesAllocated = NewSitesAllocated;
+    }
+    Analyzer->Sites[SiteID] = *Site;
+    if(SiteID >= Analyzer->SitesCount)
+    {
+        Analyzer->SitesCount = SiteID + 1;
+    }
+    return(1);
+}
+
+
+// NOTE(Marko): Walks the chunk headers once. This only touches one header
+//              per chunk, and site chunks are rare, so it is cheap even for
+//              a large trace. Returns 0 if the trace is malformed.
+int IndexTrace(analyzer *Analyzer)
+{
+    mvm_debug_memory_trace_header *Header = Analyzer->Header;
+    if((Analyzer->TraceSize < sizeof *Header) ||
+       (Header->Magic != DEBUG_TRACE_MAGIC))
+    {
+        printf("Not a debug memory trace.\n");
+        return(0);
+    }
+    if((Header->Version != DEBUG_TRACE_VERSION) ||
+       (Header->EventSize != sizeof(mvm_debug_memory_event)) ||
+       (Header->HeaderSize < sizeof *Header) ||
+       (Header->HeaderSize > Analyzer->TraceSize))
+    {
+        printf("Unsupported trace: version %u, event size %u.\n",
+               Header->Version,
+               Header->EventSize);
+        return(0);
+    }
+
+    size_t Offset = Header->HeaderSize;
+    while(Offset + sizeof(mvm_debug_memory_trace_chunk_header) <=
+          Analyzer->TraceSize)
+    {
+        mvm_debug_memory_trace_chunk_header *ChunkHeader =
+            (mvm_debug_memory_trace_chunk_header *)(Analyzer->Trace + Offset);
+        uint8_t *Payload = (uint8_t *)(ChunkHeader + 1);
+        Offset += sizeof *ChunkHeader;
+        if(ChunkHeader->PayloadSize > Analyzer->TraceSize - Offset)
+        {
+            // NOTE(Marko): The writer was cut off mid-chunk, e.g. by a
+            //              crash. Everything before it is still good.
+            printf("Trace ends in a truncated chunk; ignoring its last %zu bytes.\n",
+                   Analyzer->TraceSize - Offset + sizeof *ChunkHeader);
+            break;
+        }
+        Offset += (size_t)ChunkHeader->PayloadSize;
+
+        if(ChunkHeader->Type == TraceChunkType_SiteTable)
+        {
+            uint8_t *Record = Payload;
+            uint8_t *PayloadEnd = Payload + ChunkHeader->PayloadSize;
+            for(uint32_t SiteIndex = 0;
+                SiteIndex < ChunkHeader->ItemsCount;
+                SiteIndex++)
+            {
+                mvm_debug_memory_trace_site *TraceSite =
+                    (mvm_debug_memory_trace_site *)Record;
+                size_t BytesLeft = (size_t)(PayloadEnd - Record);
+                if((BytesLeft < sizeof *TraceSite) ||
+                   (BytesLeft < MVMTraceSiteRecordSize(TraceSite->FilenameLength)))
+                {
+                    printf("Trace has a corrupt site table chunk; ignoring its last %u sites.\n",
+                           ChunkHeader->ItemsCount - SiteIndex);
+                    break;
+                }
+                analyzer_site Site;
+                Site.Filename = (const char *)(TraceSite + 1);
+                Site.FilenameLength = TraceSite->FilenameLength;
+                Site.LineNumber = TraceSite->LineNumber;
+                if(!AddSite(Analyzer, TraceSite->SiteID, &Site))
+                {
+                    printf("Out of memory while reading the site table.\n");
+                    return(0);
+                }
+                Record += MVMTraceSiteRecordSize(TraceSite->FilenameLength);
+            }
+        }
+        else if(ChunkHeader->Type == TraceChunkType_EventBlock)
+        {
+            if((uint64_t)ChunkHeader->ItemsCount*sizeof(mvm_debug_memory_event) >
+               (uint64_t)ChunkHeader->PayloadSize)
+            {
+                printf("Trace has an event chunk of %u events in %llu bytes; rejecting it.\n",
+                       ChunkHeader->ItemsCount,
+                       (unsigned long long)ChunkHeader->PayloadSize);
+                return(0);
+            }
+            if(Analyzer->EventChunksCount >= Analyzer->EventChunksAllocated)
+            {
+                size_t NewEventChunksAllocated = Analyzer->EventChunksAllocated ?
+                    Analyzer->EventChunksAllocated*2 : 1024;
+                analyzer_event_chunk *NewEventChunks =
+                    (analyzer_event_chunk *)realloc(
+                        Analyzer->EventChunks,
+                        (sizeof *NewEventChunks) * NewEventChunksAllocated);
+                if(!NewEventChunks)
+                {
+                    printf("Out of memory while indexing the trace.\n");
+                    return(0);
+                }
+                Analyzer->EventChunks = NewEventChunks;
+                Analyzer->EventChunksAllocated = NewEventChunksAllocated;
+            }
+            analyzer_event_chunk *Chunk =
+                Analyzer->EventChunks + Analyzer->EventChunksCount++;
+            Chunk->FirstEventIndex = ChunkHeader->FirstEventIndex;
+            Chunk->EventsCount = ChunkHeader->ItemsCount;
+            Chunk->Events = (mvm_debug_memory_event *)Payload;
+
+            uint64_t EventIndexLimit =
+                Chunk->FirstEventIndex + Chunk->EventsCount;
+            if(EventIndexLimit > Analyzer->EventIndexLimit)
+            {
+                Analyzer->EventIndexLimit = EventIndexLimit;
+            }
+        }
+        else
+        {
+            printf("Unknown chunk type %u at offset %zu; stopping there.\n",
+                   ChunkHeader->Type,
+                   Offset - (size_t)ChunkHeader->PayloadSize - sizeof *ChunkHeader);
+            break;
+        }
+    }
+    return(1);
+}
+
+
+void RunWorkerThread(void *Parameter)
+{
+    analyzer_worker *Worker = (analyzer_worker *)Parameter;
+    analyzer *Analyzer = Worker->Analyzer;
+    for(;;)
+    {
+        uint64_t ChunkIndex = MVMAtomicAddU64(&Analyzer->NextChunkToProcess, 1);
+        if(ChunkIndex >= Analyzer->EventChunksCount)
+        {
+            break;
+        }
+        Worker->ChunkProc(Analyzer,
+                          Analyzer->EventChunks + ChunkIndex,
+                          Worker->ThreadIndex);
+    }
+}
+
+
+// NOTE(Marko): Runs ChunkProc over every event chunk on all threads and
+//              returns once every chunk is done.
+void RunParallelPass(analyzer *Analyzer, analyzer_chunk_proc *ChunkProc)
+{
+    analyzer_worker Workers[ANALYZER_MAX_THREADS];
+    int ThreadsStarted = 0;
+    Analyzer->NextChunkToProcess = 0;
+    for(int ThreadIndex = 1; ThreadIndex < Analyzer->ThreadsCount; ThreadIndex++)
+    {
+        analyzer_worker *Worker = Workers + ThreadIndex;
+        Worker->Analyzer = Analyzer;
+        Worker->ChunkProc = ChunkProc;
+        Worker->ThreadIndex = ThreadIndex;
+        if(!MVMPlatformCreateThread(&Worker->Thread, RunWorkerThread, Worker))
+        {
+            break;
+        }
+        ThreadsStarted++;
+    }
+
+    // NOTE(Marko): The calling thread is worker 0.
+    Workers[0].Analyzer = Analyzer;
+    Workers[0].ChunkProc = ChunkProc;
+    Workers[0].ThreadIndex = 0;
+    RunWorkerThread(Workers);
+
+    for(int ThreadIndex = 1; ThreadIndex <= ThreadsStarted; ThreadIndex++)
+    {
+        MVMPlatformJoinThread(&Workers[ThreadIndex].Thread);
+    }
+}
+
+
+mvm_debug_memory_event *GetEvent(analyzer *Analyzer, uint64_t EventIndex)
+{
+    mvm_debug_memory_event *Result = 0;
+    if(EventIndex < Analyzer->EventIndexLimit)
+    {
+        Result = Analyzer->EventsByIndex[EventIndex];
+    }
+    return(Result);
+}
+
+
+uint64_t GetPreviousEventIndex(uint64_t EventIndex,
+                               mvm_debug_memory_event *Event)
+{
+    uint64_t Result = ANALYZER_EVENT_NONE;
+    if(Event->PreviousEventOffset)
+    {
+        Result = EventIndex - (uint64_t)(int64_t)Event->PreviousEventOffset;
+    }
+    return(Result);
+}
+
+
+// NOTE(Marko): Pass 1. Places every event at its index.
+void IndexEventsProc(analyzer *Analyzer,
+                     analyzer_event_chunk *Chunk,
+                     int ThreadIndex)
+{
+    (void)ThreadIndex;
+    for(uint32_t EventIndex = 0; EventIndex < Chunk->EventsCount; EventIndex++)
+    {
+        Analyzer->EventsByIndex[Chunk->FirstEventIndex + EventIndex] =
+            Chunk->Events + EventIndex;
+    }
+}
+
+
+// NOTE(Marko): Pass 2. Turns the back links into forward links. Every event
+//              is the successor of at most one other, so no two threads
+//              write the same entry.
+void LinkEventsProc(analyzer *Analyzer,
+                    analyzer_event_chunk *Chunk,
+                    int ThreadIndex)
+{
+    (void)ThreadIndex;
+    for(uint32_t EventIndex = 0; EventIndex < Chunk->EventsCount; EventIndex++)
+    {
+        mvm_debug_memory_event *Event = Chunk->Events + EventIndex;
+        uint64_t PreviousEventIndex =
+            GetPreviousEventIndex(Chunk->FirstEventIndex + EventIndex, Event);
+        if(GetEvent(Analyzer, PreviousEventIndex))
+        {
+            Analyzer->NextEventIndices[PreviousEventIndex] =
+                Chunk->FirstEventIndex + EventIndex;
+        }
+    }
+}
+
+
+// NOTE(Marko): Pass 3. Follows every chain from its initial allocation,
+//              attributing it to the site that made the initial allocation,
+//              and records how each event changed the amount of live memory.
+void WalkChainsProc(analyzer *Analyzer,
+                    analyzer_event_chunk *Chunk,
+                    int ThreadIndex)
+{
+    analyzer_site_stats *SiteStats = Analyzer->ThreadSiteStats[ThreadIndex];
+    double SampleIntervalBytes = (double)Analyzer->Header->SampleIntervalBytes;
+    uint32_t SiteIDMask = (1u << Analyzer->Header->SiteIDBits) - 1;
+
+    for(uint32_t ChunkEventIndex = 0;
+        ChunkEventIndex < Chunk->EventsCount;
+        ChunkEventIndex++)
+    {
+        mvm_debug_memory_event *Event = Chunk->Events + ChunkEventIndex;
+        if(MVMGetEventType(Event) != MemoryOperationType_InitialAllocation)
+        {
+            continue;
+        }
+
+        uint32_t SiteID = Event->SiteAndType & SiteIDMask;
+        analyzer_site_stats *Stats = SiteStats + SiteID;
+        if(SiteID >= Analyzer->SitesCount)
+        {
+            Stats = SiteStats + DEBUG_SITE_ID_NONE;
+        }
+
+        // NOTE(Marko): Same weighting as MVMSampleAllocation(): the chain was
+        //              recorded with probability 1 - exp(-Size/Interval).
+        double Weight = 1.0;
+        if(SampleIntervalBytes > 0.0)
+        {
+            double Probability =
+                1.0 - exp(-(double)Event->ByteCount / SampleIntervalBytes);
+            Weight = (Probability > 0.0) ? (1.0 / Probability) : 1.0;
+        }
+
+        uint64_t EventIndex = Chunk->FirstEventIndex + ChunkEventIndex;
+        Stats->AllocationsCount += Weight;
+        Stats->BytesAllocated += Weight * (double)Event->ByteCount;
+        Analyzer->LiveByteDeltas[EventIndex] = Weight * (double)Event->ByteCount;
+
+        mvm_debug_memory_event *LastEvent = Event;
+        for(uint64_t NextEventIndex = Analyzer->NextEventIndices[EventIndex];
+            NextEventIndex != ANALYZER_EVENT_NONE;
+            NextEventIndex = Analyzer->NextEventIndices[NextEventIndex])
+        {
+            mvm_debug_memory_event *NextEvent = Analyzer->EventsByIndex[NextEventIndex];
+            if(MVMGetEventType(NextEvent) == MemoryOperationType_ReAllocation)
+            {
+                Stats->ReallocationsCount += Weight;
+                Analyzer->LiveByteDeltas[NextEventIndex] =
+                    Weight * ((double)NextEvent->ByteCount -
+                              (double)LastEvent->ByteCount);
+            }
+            else if(MVMGetEventType(NextEvent) == MemoryOperationType_Free)
+            {
+                Stats->FreesCount += Weight;
+                Analyzer->LiveByteDeltas[NextEventIndex] =
+                    -Weight * (double)NextEvent->ByteCount;
+            }
+            LastEvent = NextEvent;
+        }
+
+        if(MVMGetEventType(LastEvent) != MemoryOperationType_Free)
+        {
+            Stats->LiveCount += Weight;
+            Stats->LiveBytes += Weight * (double)LastEvent->ByteCount;
+        }
+    }
+}
+
+
+//
+// NOTE(Marko): Peak usage. Each chunk is already in time order, so a binary
+//              heap of one cursor per chunk replays the whole trace in time
+//              order, the same way the in-process report merges blocks.
+//
+
+typedef struct analyzer_cursor
+{
+    analyzer_event_chunk *Chunk;
+    uint32_t EventIndex;
+
+} analyzer_cursor;
+
+
+uint64_t GetCursorTimestamp(analyzer_cursor *Cursor)
+{
+    return Cursor->Chunk->Events[Cursor->EventIndex].Timestamp;
+}
+
+
+void SiftCursorDown(analyzer_cursor *Cursors,
+                    size_t CursorsCount,
+                    size_t CursorIndex)
+{
+    for(;;)
+    {
+        size_t Smallest = CursorIndex;
+        size_t Left = 2*CursorIndex + 1;
+        size_t Right = Left + 1;
+        if((Left < CursorsCount) &&
+           (GetCursorTimestamp(Cursors + Left) <
+            GetCursorTimestamp(Cursors + Smallest)))
+        {
+            Smallest = Left;
+        }
+        if((Right < CursorsCount) &&
+           (GetCursorTimestamp(Cursors + Right) <
+            GetCursorTimestamp(Cursors + Smallest)))
+        {
+            Smallest = Right;
+        }
+        if(Smallest == CursorIndex)
+        {
+            break;
+        }
+        analyzer_cursor Temp = Cursors[CursorIndex];
+        Cursors[CursorIndex] = Cursors[Smallest];
+        Cursors[Smallest] = Temp;
+        CursorIndex = Smallest;
+    }
+}
+
+
+void PrintPeakUsage(analyzer *Analyzer)
+{
+    analyzer_cursor *Cursors = (analyzer_cursor *)malloc(
+        (sizeof *Cursors) * (Analyzer->EventChunksCount + 1));
+    if(!Cursors)
+    {
+        printf("Out of memory while computing peak usage.\n");
+        return;
+    }
+    size_t CursorsCount = 0;
+    for(size_t ChunkIndex = 0; ChunkIndex < Analyzer->EventChunksCount; ChunkIndex++)
+    {
+        if(Analyzer->EventChunks[ChunkIndex].EventsCount)
+        {
+            Cursors[CursorsCount].Chunk = Analyzer->EventChunks + ChunkIndex;
+            Cursors[CursorsCount].EventIndex = 0;
+            CursorsCount++;
+        }
+    }
+    for(size_t CursorIndex = CursorsCount / 2; CursorIndex > 0; CursorIndex--)
+    {
+        SiftCursorDown(Cursors, CursorsCount, CursorIndex - 1);
+    }
+
+    uint64_t FirstTimestamp = CursorsCount ? GetCursorTimestamp(Cursors) : 0;
+    uint64_t LastTimestamp = FirstTimestamp;
+    uint64_t PeakTimestamp = FirstTimestamp;
+    double LiveBytes = 0.0;
+    double PeakLiveBytes = 0.0;
+    while(CursorsCount)
+    {
+        analyzer_cursor *Cursor = Cursors;
+        uint64_t EventIndex = Cursor->Chunk->FirstEventIndex + Cursor->EventIndex;
+        LastTimestamp = GetCursorTimestamp(Cursor);
+        LiveBytes += Analyzer->LiveByteDeltas[EventIndex];
+        if(LiveBytes > PeakLiveBytes)
+        {
+            PeakLiveBytes = LiveBytes;
+            PeakTimestamp = LastTimestamp;
+        }
+
+        if(++Cursor->EventIndex >= Cursor->Chunk->EventsCount)
+        {
+            Cursors[0] = Cursors[--CursorsCount];
+        }
+        SiftCursorDown(Cursors, CursorsCount, 0);
+    }
+    free(Cursors);
+
+    double TimestampFrequency = Analyzer->Header->TimestampFrequency ?
+        (double)Analyzer->Header->TimestampFrequency : 1.0;
+    printf("Peak live memory: %.0f bytes, %.6f s into the trace (trace spans %.6f s)\n",
+           PeakLiveBytes,
+           (double)(PeakTimestamp - FirstTimestamp) / TimestampFrequency,
+           (double)(LastTimestamp - FirstTimestamp) / TimestampFrequency);
+    printf("Live memory at end of trace: %.0f bytes\n\n", LiveBytes);
+}
+
+
+// NOTE(Marko): qsort() has no context parameter, hence the global.
+analyzer_site_stats *GlobalSortSiteStats;
+int GlobalSortByLiveBytes;
+
+int CompareSiteIDs(const void *A, const void *B)
+{
+    analyzer_site_stats *StatsA = GlobalSortSiteStats + *(const uint32_t *)A;
+    analyzer_site_stats *StatsB = GlobalSortSiteStats + *(const uint32_t *)B;
+    double KeyA = GlobalSortByLiveBytes ? StatsA->LiveBytes : StatsA->BytesAllocated;
+    double KeyB = GlobalSortByLiveBytes ? StatsB->LiveBytes : StatsB->BytesAllocated;
+    return (KeyA < KeyB) - (KeyA > KeyB);
+}
+
+
+void PrintSiteName(analyzer *Analyzer, uint32_t SiteID)
+{
+    analyzer_site *Site = Analyzer->Sites + SiteID;
+    if(Site->Filename)
+    {
+        printf("%.*s:%d",
+               (int)Site->FilenameLength,
+               Site->Filename,
+               Site->LineNumber);
+    }
+    else
+    {
+        printf("<site %u>", SiteID);
+    }
+}
+
+
+void PrintSiteReports(analyzer *Analyzer, uint32_t TopSitesCount)
+{
+    // NOTE(Marko): Sum the per-thread tallies into thread 0's.
+    analyzer_site_stats *SiteStats = Analyzer->ThreadSiteStats[0];
+    for(int ThreadIndex = 1; ThreadIndex < Analyzer->ThreadsCount; ThreadIndex++)
+    {
+        analyzer_site_stats *ThreadStats = Analyzer->ThreadSiteStats[ThreadIndex];
+        for(uint32_t SiteID = 0; SiteID < Analyzer->SitesCount; SiteID++)
+        {
+            SiteStats[SiteID].AllocationsCount += ThreadStats[SiteID].AllocationsCount;
+            SiteStats[SiteID].BytesAllocated += ThreadStats[SiteID].BytesAllocated;
+            SiteStats[SiteID].ReallocationsCount += ThreadStats[SiteID].ReallocationsCount;
+            SiteStats[SiteID].FreesCount += ThreadStats[SiteID].FreesCount;
+            SiteStats[SiteID].LiveCount += ThreadStats[SiteID].LiveCount;
+            SiteStats[SiteID].LiveBytes += ThreadStats[SiteID].LiveBytes;
+        }
+    }
+
+    uint32_t *SiteIDs = (uint32_t *)malloc((sizeof *SiteIDs) * (Analyzer->SitesCount + 1));
+    if(!SiteIDs)
+    {
+        printf("Out of memory while sorting sites.\n");
+        return;
+    }
+    for(uint32_t SiteID = 0; SiteID < Analyzer->SitesCount; SiteID++)
+    {
+        SiteIDs[SiteID] = SiteID;
+    }
+    GlobalSortSiteStats = SiteStats;
+
+    double TotalLiveCount = 0.0;
+    double TotalLiveBytes = 0.0;
+    for(uint32_t SiteID = 0; SiteID < Analyzer->SitesCount; SiteID++)
+    {
+        TotalLiveCount += SiteStats[SiteID].LiveCount;
+        TotalLiveBytes += SiteStats[SiteID].LiveBytes;
+    }
+    printf("Leaks (live at end of trace): %.0f bytes in %.0f allocations\n",
+           TotalLiveBytes,
+           TotalLiveCount);
+    GlobalSortByLiveBytes = 1;
+    qsort(SiteIDs, Analyzer->SitesCount, sizeof *SiteIDs, CompareSiteIDs);
+    for(uint32_t Rank = 0;
+        (Rank < Analyzer->SitesCount) && (Rank < TopSitesCount);
+        Rank++)
+    {
+        analyzer_site_stats *Stats = SiteStats + SiteIDs[Rank];
+        if(Stats->LiveCount <= 0.0)
+        {
+            break;
+        }
+        printf("\t%14.0f bytes in %10.0f allocations from ",
+               Stats->LiveBytes,
+               Stats->LiveCount);
+        PrintSiteName(Analyzer, SiteIDs[Rank]);
+        printf("\n");
+    }
+    printf("\n");
+
+    printf("Allocation sites by bytes allocated:\n");
+    printf("\t%14s %12s %12s %12s  %s\n",
+           "Bytes", "Allocations", "Reallocs", "Frees", "Site");
+    GlobalSortByLiveBytes = 0;
+    qsort(SiteIDs, Analyzer->SitesCount, sizeof *SiteIDs, CompareSiteIDs);
+    for(uint32_t Rank = 0;
+        (Rank < Analyzer->SitesCount) && (Rank < TopSitesCount);
+        Rank++)
+    {
+        analyzer_site_stats *Stats = SiteStats + SiteIDs[Rank];
+        if(Stats->AllocationsCount <= 0.0)
+        {
+            break;
+        }
+        printf("\t%14.0f %12.0f %12.0f %12.0f  ",
+               Stats->BytesAllocated,
+               Stats->AllocationsCount,
+               Stats->ReallocationsCount,
+               Stats->FreesCount);
+        PrintSiteName(Analyzer, SiteIDs[Rank]);
+        printf("\n");
+    }
+    printf("\n");
+
+    free(SiteIDs);
+}
+
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        printf("USAGE: %s TraceFile [ThreadsCount] [TopSitesCount]\n", argv[0]);
+        return(1);
+    }
+
+    analyzer Analyzer = {0};
+    Analyzer.ThreadsCount = GetProcessorCount();
+    if(argc > 2)
+    {
+        Analyzer.ThreadsCount = atoi(argv[2]);
+    }
+    if(Analyzer.ThreadsCount < 1)
+    {
+        Analyzer.ThreadsCount = 1;
+    }
+    if(Analyzer.ThreadsCount > ANALYZER_MAX_THREADS)
+    {
+        Analyzer.ThreadsCount = ANALYZER_MAX_THREADS;
+    }
+    uint32_t TopSitesCount = ANALYZER_DEFAULT_TOP_SITES;
+    if(argc > 3)
+    {
+        TopSitesCount = (uint32_t)strtoul(argv[3], 0, 10);
+    }
+
+    double StartSeconds = GetWallClockSeconds();
+
+    Analyzer.Trace = MapFileForReading(argv[1], &Analyzer.TraceSize);
+    if(!Analyzer.Trace)
+    {
+        printf("Unable to map trace file %s\n", argv[1]);
+        return(1);
+    }
+    Analyzer.Header = (mvm_debug_memory_trace_header *)Analyzer.Trace;
+    if(!IndexTrace(&Analyzer))
+    {
+        return(1);
+    }
+
+    // NOTE(Marko): calloc() so that indices that were reserved but never
+    //              filled read as empty.
+    size_t EventIndexLimit = (size_t)Analyzer.EventIndexLimit;
+    Analyzer.EventsByIndex = (mvm_debug_memory_event **)calloc(
+        EventIndexLimit + 1, sizeof *Analyzer.EventsByIndex);
+    Analyzer.NextEventIndices = (uint64_t *)malloc(
+        (EventIndexLimit + 1) * sizeof *Analyzer.NextEventIndices);
+    Analyzer.LiveByteDeltas = (double *)calloc(
+        EventIndexLimit + 1, sizeof *Analyzer.LiveByteDeltas);
+    int AllocationsSucceeded = (Analyzer.EventsByIndex &&
+                                Analyzer.NextEventIndices &&
+                                Analyzer.LiveByteDeltas);
+    for(int ThreadIndex = 0; ThreadIndex < Analyzer.ThreadsCount; ThreadIndex++)
+    {
+        Analyzer.ThreadSiteStats[ThreadIndex] = (analyzer_site_stats *)calloc(
+            Analyzer.SitesCount + 1, sizeof(analyzer_site_stats));
+        AllocationsSucceeded &= (Analyzer.ThreadSiteStats[ThreadIndex] != 0);
+    }
+    if(!AllocationsSucceeded)
+    {
+        printf("Out of memory: the trace has %zu event slots.\n", EventIndexLimit);
+        return(1);
+    }
+    memset(Analyzer.NextEventIndices, 0xFF,
+           (EventIndexLimit + 1) * sizeof *Analyzer.NextEventIndices);
+
+    RunParallelPass(&Analyzer, IndexEventsProc);
+    RunParallelPass(&Analyzer, LinkEventsProc);
+    RunParallelPass(&Analyzer, WalkChainsProc);
+
+    uint64_t EventsCount = 0;
+    for(size_t ChunkIndex = 0; ChunkIndex < Analyzer.EventChunksCount; ChunkIndex++)
+    {
+        EventsCount += Analyzer.EventChunks[ChunkIndex].EventsCount;
+    }
+    printf("Trace %s: %zu bytes, %llu events in %zu chunks, %u call sites\n",
+           argv[1],
+           Analyzer.TraceSize,
+           (unsigned long long)EventsCount,
+           Analyzer.EventChunksCount,
+           Analyzer.SitesCount);
+    if(Analyzer.Header->SampleIntervalBytes)
+    {
+        printf("Sampled trace (1 sample per %llu bytes); figures below are estimates.\n",
+               (unsigned long long)Analyzer.Header->SampleIntervalBytes);
+    }
+    printf("\n");
+
+    PrintPeakUsage(&Analyzer);
+    PrintSiteReports(&Analyzer, TopSitesCount);
+
+    printf("Analyzed with %d threads in %.3f s\n",
+           Analyzer.ThreadsCount,
+           GetWallClockSeconds() - StartSeconds);
+
+    for(int ThreadIndex = 0; ThreadIndex < Analyzer.ThreadsCount; ThreadIndex++)
+    {
+        free(Analyzer.ThreadSiteStats[ThreadIndex]);
+    }
+    free(Analyzer.LiveByteDeltas);
+    free(Analyzer.NextEventIndices);
+    free(Analyzer.EventsByIndex);
+    free(Analyzer.EventChunks);
+    free(Analyzer.Sites);
+    UnmapFile(Analyzer.Trace, Analyzer.TraceSize);
+
+    return(0);
+}
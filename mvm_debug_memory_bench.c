@@ -0,0 +1,495 @@
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "mvm_debug_memory.h"
+
+/*
+    NOTE(Marko): Overhead benchmarks for the hot path. Every measurement is
+                 taken twice, once with the tool on (tracked) and once with it
+                 off (untracked), and reported in nanoseconds per call.
+                 Operations are timed in batches so the clock reads do not
+                 swamp what is being measured.
+
+                 1. Allocation patterns over a fixed working set:
+                    - LIFO: allocate a batch, free it newest first.
+                    - FIFO: a queue; every block lives for exactly one trip
+                      around it.
+                    - Random lifetimes: free random victims, then replace
+                      them.
+                    - Realloc growth: grow blocks by 1.5x from 16 bytes to
+                      16 KB, the way a dynamic array does.
+
+                 2. A live-set sweep from 1K to MaxLiveCount live blocks. Each
+                    round frees a random tenth of the live set and then
+                    reallocates it, so the live set stays between 90% and
+                    100% of its target size. Also reports the tracker's own
+                    memory per tracked allocation.
+
+                 3. Throughput when 1 to MaxThreads threads malloc()/free()
+                    concurrently, each over its own small ring of live blocks.
+
+                 USAGE: mvm_debug_memory_bench [MaxLiveCount] [MaxThreads]
+                        MaxLiveCount defaults to 1000000. Pass 10000000 for
+                        the full sweep (needs several GB for the history).
+                        MaxThreads defaults to 32.
+*/
+
+#define BENCH_MIN_TIMED_FREES 100000
+#define BENCH_MAX_THREADS 32
+#define BENCH_THREAD_RING_SIZE 64
+#define BENCH_THREAD_OPERATIONS 200000
+
+#define BENCH_PATTERN_LIVE_COUNT 10000
+#define BENCH_PATTERN_BATCH_SIZE 1000
+#define BENCH_PATTERN_ROUNDS 100
+#define BENCH_GROWTH_BLOCKS_COUNT 1000
+#define BENCH_GROWTH_ROUNDS 20
+#define BENCH_GROWTH_MIN_BYTES 16
+#define BENCH_GROWTH_MAX_BYTES 16384
+
+
+double GetWallClockSeconds(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER Counter;
+    LARGE_INTEGER Frequency;
+    QueryPerformanceCounter(&Counter);
+    QueryPerformanceFrequency(&Frequency);
+    return (double)Counter.QuadPart / (double)Frequency.QuadPart;
+#else
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return (double)Time.tv_sec + (double)Time.tv_nsec*1e-9;
+#endif
+}
+
+
+uint64_t XorShift64(uint64_t *State)
+{
+    uint64_t Result = *State;
+    Result ^= Result << 13;
+    Result ^= Result >> 7;
+    Result ^= Result << 17;
+    *State = Result;
+    return Result;
+}
+
+
+size_t RandomBlockSize(uint64_t *RandomState)
+{
+    return 16 + (size_t)(XorShift64(RandomState) & 127);
+}
+
+
+typedef struct bench_timings
+{
+    double MallocSeconds;
+    uint64_t MallocsCount;
+    double ReallocSeconds;
+    uint64_t ReallocsCount;
+    double FreeSeconds;
+    uint64_t FreesCount;
+
+} bench_timings;
+
+
+typedef struct bench_context
+{
+    void **Blocks;
+    size_t *Permutation;
+    uint64_t RandomState;
+
+} bench_context;
+
+
+typedef void bench_pattern_proc(bench_context *Context, bench_timings *Timings);
+
+
+double NanosecondsPerCall(double Seconds, uint64_t CallsCount)
+{
+    return CallsCount ? (Seconds * 1e9) / (double)CallsCount : 0.0;
+}
+
+
+void RunLifoPattern(bench_context *Context, bench_timings *Timings)
+{
+    void **Blocks = Context->Blocks;
+    for(int Round = 0; Round < BENCH_PATTERN_ROUNDS; Round++)
+    {
+        double StartSeconds = GetWallClockSeconds();
+        for(size_t BlockIndex = 0; BlockIndex < BENCH_PATTERN_LIVE_COUNT; BlockIndex++)
+        {
+            Blocks[BlockIndex] = malloc(RandomBlockSize(&Context->RandomState));
+        }
+        double MiddleSeconds = GetWallClockSeconds();
+        for(size_t BlockIndex = BENCH_PATTERN_LIVE_COUNT; BlockIndex > 0; BlockIndex--)
+        {
+            free(Blocks[BlockIndex - 1]);
+        }
+        double EndSeconds = GetWallClockSeconds();
+
+        Timings->MallocSeconds += MiddleSeconds - StartSeconds;
+        Timings->FreeSeconds += EndSeconds - MiddleSeconds;
+        Timings->MallocsCount += BENCH_PATTERN_LIVE_COUNT;
+        Timings->FreesCount += BENCH_PATTERN_LIVE_COUNT;
+    }
+}
+
+
+// NOTE(Marko): Blocks is a ring; the batch at Head is always the oldest, and
+//              its replacements become the newest.
+void RunFifoPattern(bench_context *Context, bench_timings *Timings)
+{
+    void **Blocks = Context->Blocks;
+    for(size_t BlockIndex = 0; BlockIndex < BENCH_PATTERN_LIVE_COUNT; BlockIndex++)
+    {
+        Blocks[BlockIndex] = malloc(RandomBlockSize(&Context->RandomState));
+    }
+
+    size_t Head = 0;
+    size_t RoundsCount =
+        (BENCH_PATTERN_ROUNDS * BENCH_PATTERN_LIVE_COUNT) / BENCH_PATTERN_BATCH_SIZE;
+    for(size_t Round = 0; Round < RoundsCount; Round++)
+    {
+        double StartSeconds = GetWallClockSeconds();
+        for(size_t BatchIndex = 0; BatchIndex < BENCH_PATTERN_BATCH_SIZE; BatchIndex++)
+        {
+            free(Blocks[Head + BatchIndex]);
+        }
+        double MiddleSeconds = GetWallClockSeconds();
+        for(size_t BatchIndex = 0; BatchIndex < BENCH_PATTERN_BATCH_SIZE; BatchIndex++)
+        {
+            Blocks[Head + BatchIndex] = malloc(RandomBlockSize(&Context->RandomState));
+        }
+        double EndSeconds = GetWallClockSeconds();
+        Head = (Head + BENCH_PATTERN_BATCH_SIZE) % BENCH_PATTERN_LIVE_COUNT;
+
+        Timings->FreeSeconds += MiddleSeconds - StartSeconds;
+        Timings->MallocSeconds += EndSeconds - MiddleSeconds;
+        Timings->FreesCount += BENCH_PATTERN_BATCH_SIZE;
+        Timings->MallocsCount += BENCH_PATTERN_BATCH_SIZE;
+    }
+
+    for(size_t BlockIndex = 0; BlockIndex < BENCH_PATTERN_LIVE_COUNT; BlockIndex++)
+    {
+        free(Blocks[BlockIndex]);
+    }
+}
+
+
+// NOTE(Marko): Frees a random batch of the live set and then replaces it.
+//              Shared by the random-lifetimes pattern and the live-set sweep.
+void RunRandomLifetimes(bench_context *Context,
+                        size_t LiveCount,
+                        size_t BatchSize,
+                        uint64_t MinTimedFrees,
+                        bench_timings *Timings)
+{
+    void **Blocks = Context->Blocks;
+    size_t *Permutation = Context->Permutation;
+    for(size_t BlockIndex = 0; BlockIndex < LiveCount; BlockIndex++)
+    {
+        Blocks[BlockIndex] = malloc(RandomBlockSize(&Context->RandomState));
+        Permutation[BlockIndex] = BlockIndex;
+    }
+
+    uint64_t TimedFrees = 0;
+    while(TimedFrees < MinTimedFrees)
+    {
+        // NOTE(Marko): Partial Fisher-Yates: pick BatchSize random victims
+        //              into the front of the permutation.
+        for(size_t PickIndex = 0; PickIndex < BatchSize; PickIndex++)
+        {
+            size_t SwapIndex = PickIndex +
+                (size_t)(XorShift64(&Context->RandomState) % (LiveCount - PickIndex));
+            size_t Temp = Permutation[PickIndex];
+            Permutation[PickIndex] = Permutation[SwapIndex];
+            Permutation[SwapIndex] = Temp;
+        }
+
+        double StartSeconds = GetWallClockSeconds();
+        for(size_t PickIndex = 0; PickIndex < BatchSize; PickIndex++)
+        {
+            free(Blocks[Permutation[PickIndex]]);
+        }
+        double MiddleSeconds = GetWallClockSeconds();
+        for(size_t PickIndex = 0; PickIndex < BatchSize; PickIndex++)
+        {
+            Blocks[Permutation[PickIndex]] =
+                malloc(RandomBlockSize(&Context->RandomState));
+        }
+        double EndSeconds = GetWallClockSeconds();
+
+        Timings->FreeSeconds += MiddleSeconds - StartSeconds;
+        Timings->MallocSeconds += EndSeconds - MiddleSeconds;
+        Timings->FreesCount += BatchSize;
+        Timings->MallocsCount += BatchSize;
+        TimedFrees += BatchSize;
+    }
+
+    for(size_t BlockIndex = 0; BlockIndex < LiveCount; BlockIndex++)
+    {
+        free(Blocks[BlockIndex]);
+    }
+}
+
+
+void RunRandomLifetimesPattern(bench_context *Context, bench_timings *Timings)
+{
+    RunRandomLifetimes(Context,
+                       BENCH_PATTERN_LIVE_COUNT,
+                       BENCH_PATTERN_BATCH_SIZE,
+                       BENCH_PATTERN_ROUNDS * BENCH_PATTERN_LIVE_COUNT,
+                       Timings);
+}
+
+
+void RunReallocGrowthPattern(bench_context *Context, bench_timings *Timings)
+{
+    void **Blocks = Context->Blocks;
+    for(int Round = 0; Round < BENCH_GROWTH_ROUNDS; Round++)
+    {
+        double StartSeconds = GetWallClockSeconds();
+        for(size_t BlockIndex = 0; BlockIndex < BENCH_GROWTH_BLOCKS_COUNT; BlockIndex++)
+        {
+            Blocks[BlockIndex] = malloc(BENCH_GROWTH_MIN_BYTES);
+        }
+        Timings->MallocSeconds += GetWallClockSeconds() - StartSeconds;
+        Timings->MallocsCount += BENCH_GROWTH_BLOCKS_COUNT;
+
+        for(size_t Size = BENCH_GROWTH_MIN_BYTES + BENCH_GROWTH_MIN_BYTES/2;
+            Size <= BENCH_GROWTH_MAX_BYTES;
+            Size += Size/2)
+        {
+            StartSeconds = GetWallClockSeconds();
+            for(size_t BlockIndex = 0; BlockIndex < BENCH_GROWTH_BLOCKS_COUNT; BlockIndex++)
+            {
+                Blocks[BlockIndex] = realloc(Blocks[BlockIndex], Size);
+            }
+            Timings->ReallocSeconds += GetWallClockSeconds() - StartSeconds;
+            Timings->ReallocsCount += BENCH_GROWTH_BLOCKS_COUNT;
+        }
+
+        StartSeconds = GetWallClockSeconds();
+        for(size_t BlockIndex = 0; BlockIndex < BENCH_GROWTH_BLOCKS_COUNT; BlockIndex++)
+        {
+            free(Blocks[BlockIndex]);
+        }
+        Timings->FreeSeconds += GetWallClockSeconds() - StartSeconds;
+        Timings->FreesCount += BENCH_GROWTH_BLOCKS_COUNT;
+    }
+}
+
+
+void PrintNanosecondsPair(double TrackedSeconds,
+                          double UntrackedSeconds,
+                          uint64_t CallsCount)
+{
+    if(CallsCount)
+    {
+        printf(" %9.1f %9.1f",
+               NanosecondsPerCall(TrackedSeconds, CallsCount),
+               NanosecondsPerCall(UntrackedSeconds, CallsCount));
+    }
+    else
+    {
+        printf(" %9s %9s", "-", "-");
+    }
+}
+
+
+void MeasurePattern(const char *Name,
+                    bench_pattern_proc *Pattern,
+                    bench_context *Context)
+{
+    bench_timings Tracked = {0};
+    bench_timings Untracked = {0};
+
+    MVMTurnOnDebugInfo();
+    Pattern(Context, &Tracked);
+    MVMTurnOffDebugInfo();
+    MVMDebugMemoryShutdown();
+
+    Pattern(Context, &Untracked);
+
+    printf("%-18s", Name);
+    PrintNanosecondsPair(Tracked.MallocSeconds, Untracked.MallocSeconds,
+                         Tracked.MallocsCount);
+    PrintNanosecondsPair(Tracked.ReallocSeconds, Untracked.ReallocSeconds,
+                         Tracked.ReallocsCount);
+    PrintNanosecondsPair(Tracked.FreeSeconds, Untracked.FreeSeconds,
+                         Tracked.FreesCount);
+    printf("\n");
+}
+
+
+// NOTE(Marko): Returns the tracker's memory divided by the number of blocks
+//              it tracks, right after the live set has been built.
+double MeasureTrackerBytesPerAllocation(bench_context *Context, size_t LiveCount)
+{
+    MVMTurnOnDebugInfo();
+    for(size_t BlockIndex = 0; BlockIndex < LiveCount; BlockIndex++)
+    {
+        Context->Blocks[BlockIndex] = malloc(RandomBlockSize(&Context->RandomState));
+    }
+    double Result = (double)GlobalDebugArena.BytesInUse / (double)LiveCount;
+    for(size_t BlockIndex = 0; BlockIndex < LiveCount; BlockIndex++)
+    {
+        free(Context->Blocks[BlockIndex]);
+    }
+    MVMTurnOffDebugInfo();
+    MVMDebugMemoryShutdown();
+    return Result;
+}
+
+
+typedef struct bench_thread_work
+{
+    uint64_t RandomState;
+    size_t OperationsCount;
+
+} bench_thread_work;
+
+
+void RunThreadWork(void *Parameter)
+{
+    bench_thread_work *Work = (bench_thread_work *)Parameter;
+    void *Ring[BENCH_THREAD_RING_SIZE] = {0};
+    for(size_t OperationIndex = 0;
+        OperationIndex < Work->OperationsCount;
+        OperationIndex++)
+    {
+        size_t RingIndex = OperationIndex & (BENCH_THREAD_RING_SIZE - 1);
+        free(Ring[RingIndex]);
+        Ring[RingIndex] = malloc(RandomBlockSize(&Work->RandomState));
+    }
+    for(size_t RingIndex = 0; RingIndex < BENCH_THREAD_RING_SIZE; RingIndex++)
+    {
+        free(Ring[RingIndex]);
+    }
+}
+
+
+// NOTE(Marko): Returns millions of malloc()+free() pairs per second summed
+//              over all threads.
+double MeasureThreadThroughput(int ThreadsCount)
+{
+    mvm_debug_memory_thread Threads[BENCH_MAX_THREADS];
+    bench_thread_work Work[BENCH_MAX_THREADS];
+    int ThreadsStarted = 0;
+
+    double StartSeconds = GetWallClockSeconds();
+    for(int ThreadIndex = 0; ThreadIndex < ThreadsCount; ThreadIndex++)
+    {
+        Work[ThreadIndex].RandomState =
+            0x9E3779B97F4A7C15ULL * (uint64_t)(ThreadIndex + 1);
+        Work[ThreadIndex].OperationsCount = BENCH_THREAD_OPERATIONS;
+        if(!MVMPlatformCreateThread(Threads + ThreadIndex,
+                                    RunThreadWork,
+                                    Work + ThreadIndex))
+        {
+            printf("Failed to start benchmark thread %d\n", ThreadIndex);
+            break;
+        }
+        ThreadsStarted++;
+    }
+    for(int ThreadIndex = 0; ThreadIndex < ThreadsStarted; ThreadIndex++)
+    {
+        MVMPlatformJoinThread(Threads + ThreadIndex);
+    }
+    double ElapsedSeconds = GetWallClockSeconds() - StartSeconds;
+
+    return ((double)ThreadsStarted * (double)BENCH_THREAD_OPERATIONS) /
+        (ElapsedSeconds * 1e6);
+}
+
+
+int main(int argc, char **argv)
+{
+    size_t MaxLiveCount = 1000000;
+    if(argc > 1)
+    {
+        MaxLiveCount = (size_t)strtoull(argv[1], 0, 10);
+    }
+    int MaxThreads = BENCH_MAX_THREADS;
+    if(argc > 2)
+    {
+        MaxThreads = atoi(argv[2]);
+        if(MaxThreads > BENCH_MAX_THREADS)
+        {
+            MaxThreads = BENCH_MAX_THREADS;
+        }
+    }
+
+    // NOTE(Marko): The bookkeeping arrays are allocated before the tool is
+    //              turned on so they do not show up in the tracked live set.
+    size_t BlocksCount = MaxLiveCount;
+    if(BlocksCount < BENCH_PATTERN_LIVE_COUNT)
+    {
+        BlocksCount = BENCH_PATTERN_LIVE_COUNT;
+    }
+    bench_context Context;
+    Context.Blocks = (void **)malloc((sizeof *Context.Blocks) * BlocksCount);
+    Context.Permutation = (size_t *)malloc((sizeof *Context.Permutation) * BlocksCount);
+    Context.RandomState = 0x2545F4914F6CDD1DULL;
+
+    printf("Nanoseconds per call over %d live blocks, tracked (T) and untracked (U):\n",
+           BENCH_PATTERN_LIVE_COUNT);
+    printf("%-18s %9s %9s %9s %9s %9s %9s\n", "Pattern",
+           "malloc T", "malloc U", "realloc T", "realloc U", "free T", "free U");
+    MeasurePattern("LIFO", RunLifoPattern, &Context);
+    MeasurePattern("FIFO", RunFifoPattern, &Context);
+    MeasurePattern("Random lifetimes", RunRandomLifetimesPattern, &Context);
+    MeasurePattern("Realloc growth", RunReallocGrowthPattern, &Context);
+
+    printf("\n%12s %9s %9s %9s %9s %16s\n", "Live set",
+           "malloc T", "malloc U", "free T", "free U", "Tracker B/alloc");
+    for(size_t LiveCount = 1000; LiveCount <= MaxLiveCount; LiveCount *= 10)
+    {
+        size_t BatchSize = LiveCount / 10;
+        bench_timings Tracked = {0};
+        bench_timings Untracked = {0};
+
+        double TrackerBytes = MeasureTrackerBytesPerAllocation(&Context, LiveCount);
+
+        MVMTurnOnDebugInfo();
+        RunRandomLifetimes(&Context, LiveCount, BatchSize,
+                           BENCH_MIN_TIMED_FREES, &Tracked);
+        MVMTurnOffDebugInfo();
+        MVMDebugMemoryShutdown();
+
+        RunRandomLifetimes(&Context, LiveCount, BatchSize,
+                           BENCH_MIN_TIMED_FREES, &Untracked);
+
+        printf("%12zu", LiveCount);
+        PrintNanosecondsPair(Tracked.MallocSeconds, Untracked.MallocSeconds,
+                             Tracked.MallocsCount);
+        PrintNanosecondsPair(Tracked.FreeSeconds, Untracked.FreeSeconds,
+                             Tracked.FreesCount);
+        printf(" %16.1f\n", TrackerBytes);
+    }
+
+    free(Context.Permutation);
+    free(Context.Blocks);
+
+    printf("\n%12s %18s %18s\n", "Threads", "Tracked Mops/s", "Untracked Mops/s");
+    for(int ThreadsCount = 1; ThreadsCount <= MaxThreads; ThreadsCount *= 2)
+    {
+        MVMTurnOnDebugInfo();
+        double TrackedThroughput = MeasureThreadThroughput(ThreadsCount);
+        MVMTurnOffDebugInfo();
+        MVMDebugMemoryShutdown();
+
+        double UntrackedThroughput = MeasureThreadThroughput(ThreadsCount);
+
+        printf("%12d %18.2f %18.2f\n",
+               ThreadsCount,
+               TrackedThroughput,
+               UntrackedThroughput);
+    }
+
+    return(0);
+}
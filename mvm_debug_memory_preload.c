@@ -0,0 +1,613 @@
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <dlfcn.h>
+#include <malloc.h>
+
+/*
+    NOTE(Marko): LD_PRELOAD build of the tool, for tracking programs (and the 
+                 libraries they load) without recompiling them: 
+
+                     LD_PRELOAD=./libmvm_debug_memory.so ./program 
+
+                 Interposes malloc, calloc, realloc, free, posix_memalign, 
+                 aligned_alloc, memalign, valloc, pvalloc and 
+                 malloc_usable_size. Sites are named after the interposed 
+                 function, so attribution comes from call stacks, which are 
+                 on by default. Build with -fno-omit-frame-pointer (or set 
+                 MVM_DEBUG_MEMORY_UNWINDER=1 for code built without it). 
+
+                 Environment variables, all optional: 
+
+                 MVM_DEBUG_MEMORY_ENABLED       0 loads the library but records 
+                                                nothing. Default 1. 
+                 MVM_DEBUG_MEMORY_MAX_EVENTS    mvm_debug_memory_config fields 
+                 MVM_DEBUG_MEMORY_MAX_EVENT_BYTES  of the same names. 
+                 MVM_DEBUG_MEMORY_SAMPLE_BYTES 
+                 MVM_DEBUG_MEMORY_TRACE 
+                 MVM_DEBUG_MEMORY_TIMELINE_US 
+                 MVM_DEBUG_MEMORY_STACK_DEPTH   Default 16; 0 turns stacks off. 
+                 MVM_DEBUG_MEMORY_UNWINDER      1 always uses the unwinder. 
+                 MVM_DEBUG_MEMORY_QUARANTINE_BYTES  Holds freed blocks back to 
+                                                catch use after free; checked 
+                                                again at exit. 
+                 MVM_DEBUG_MEMORY_LEAK_REPORT   0 skips the leak report at 
+                                                exit. Default 1. 
+                 MVM_DEBUG_MEMORY_LEAK_FILE     CSV copy of the leak report. 
+                 MVM_DEBUG_MEMORY_LEAK_THRESHOLD  Exit with 
+                 MVM_DEBUG_MEMORY_LEAK_EXIT_CODE  MVM_DEBUG_MEMORY_LEAK_EXIT_CODE 
+                                                when more bytes than this leak. 
+                 MVM_DEBUG_MEMORY_PRINT_AT_EXIT 1 also prints the full report 
+                                                (MVMDebugMemoryPrintAllocations) 
+                                                at exit. 
+
+                 Reports at exit go to stderr, as it was when the program 
+                 started. Linux/glibc only. 
+*/
+
+void *MVMPreloadRealMalloc(size_t Size);
+void *MVMPreloadRealCalloc(size_t Count, size_t Size);
+void *MVMPreloadRealRealloc(void *Memory, size_t Size);
+void MVMPreloadRealFree(void *Memory);
+int MVMPreloadRealPosixMemalign(void **Memory, size_t Alignment, size_t Size);
+
+#define MVM_DEBUG_REAL_MALLOC(Size) MVMPreloadRealMalloc(Size)
+#define MVM_DEBUG_REAL_CALLOC(Count, Size) MVMPreloadRealCalloc(Count, Size)
+#define MVM_DEBUG_REAL_REALLOC(Memory, Size) MVMPreloadRealRealloc(Memory, Size)
+#define MVM_DEBUG_REAL_FREE(Memory) MVMPreloadRealFree(Memory)
+#define MVM_DEBUG_REAL_POSIX_MEMALIGN(Memory, Alignment, Size) \
+    MVMPreloadRealPosixMemalign(Memory, Alignment, Size)
+
+#ifndef MVM_DEBUG_MEMORY
+    #define MVM_DEBUG_MEMORY 1
+#endif
+#include "mvm_debug_memory.h"
+
+// NOTE(Marko): This file defines the real malloc/realloc/free etc., so the 
+//              header's call-site macros must not rename them. 
+#undef malloc
+#undef calloc
+#undef realloc
+#undef reallocarray
+#undef free
+#undef posix_memalign
+#undef aligned_alloc
+#undef strdup
+#undef strndup
+
+#define MVM_PRELOAD_EXPORT __attribute__((visibility("default")))
+
+// NOTE(Marko): dlsym() can itself allocate (glibc's calloc()s an error 
+//              buffer), before any real allocator is known. Those few early 
+//              requests are carved from this buffer and never given back. 
+#define PRELOAD_BOOTSTRAP_SIZE (64 * 1024)
+#define PRELOAD_BOOTSTRAP_ALIGNMENT 16
+
+#define PRELOAD_STACK_DEPTH_DEFAULT 16
+
+typedef void *preload_malloc_proc(size_t Size);
+typedef void *preload_calloc_proc(size_t Count, size_t Size);
+typedef void *preload_realloc_proc(void *Memory, size_t Size);
+typedef void preload_free_proc(void *Memory);
+typedef int preload_posix_memalign_proc(void **Memory, size_t Alignment, size_t Size);
+typedef void *preload_aligned_alloc_proc(size_t Alignment, size_t Size);
+typedef void *preload_valloc_proc(size_t Size);
+typedef size_t preload_malloc_usable_size_proc(void *Memory);
+
+typedef struct preload_real_allocator
+{
+    preload_malloc_proc *Malloc;
+    preload_calloc_proc *Calloc;
+    preload_realloc_proc *Realloc;
+    preload_free_proc *Free;
+    preload_posix_memalign_proc *PosixMemalign;
+    preload_aligned_alloc_proc *AlignedAlloc;
+    preload_aligned_alloc_proc *Memalign;
+    preload_valloc_proc *Valloc;
+    preload_valloc_proc *Pvalloc;
+    preload_malloc_usable_size_proc *MallocUsableSize;
+
+} preload_real_allocator;
+
+preload_real_allocator GlobalPreloadReal;
+volatile uint32_t GlobalPreloadResolving = 0;
+
+uint8_t GlobalPreloadBootstrap[PRELOAD_BOOTSTRAP_SIZE]
+    __attribute__((aligned(PRELOAD_BOOTSTRAP_ALIGNMENT)));
+volatile uint64_t GlobalPreloadBootstrapUsed = 0;
+
+// NOTE(Marko): Set once the tool is initialized, cleared again at exit. 
+volatile uint32_t GlobalPreloadRecording = 0;
+
+// NOTE(Marko): Our own copy of stderr, taken at startup. Programs may close 
+//              stdout and stderr from an atexit() handler of their own 
+//              (coreutils' close_stdout does), which runs before ours. 
+int GlobalPreloadReportDescriptor = -1;
+
+// NOTE(Marko): Set while a thread is inside the tool. Anything the tool (or 
+//              the C library on its behalf: printf(), fopen(), backtrace()) 
+//              allocates meanwhile goes straight to the real allocator. 
+//              initial-exec keeps the access itself from allocating. 
+__thread uint32_t ThreadLocalPreloadInTool
+    __attribute__((tls_model("initial-exec")));
+
+
+void *MVMPreloadBootstrapAllocate(size_t Size)
+{
+    // NOTE(Marko): Each block is preceded by its size, for realloc() and 
+    //              malloc_usable_size(). 
+    size_t BlockSize = PRELOAD_BOOTSTRAP_ALIGNMENT +
+        ((Size + PRELOAD_BOOTSTRAP_ALIGNMENT - 1) &
+         ~(size_t)(PRELOAD_BOOTSTRAP_ALIGNMENT - 1));
+    uint64_t Offset = MVMAtomicAddU64(&GlobalPreloadBootstrapUsed, BlockSize);
+    if(Offset + BlockSize > PRELOAD_BOOTSTRAP_SIZE)
+    {
+        return(0);
+    }
+    uint8_t *Block = GlobalPreloadBootstrap + Offset;
+    *(size_t *)Block = Size;
+    return(Block + PRELOAD_BOOTSTRAP_ALIGNMENT);
+}
+
+
+int MVMPreloadIsBootstrap(void *Memory)
+{
+    return(((uint8_t *)Memory >= GlobalPreloadBootstrap) &&
+           ((uint8_t *)Memory < GlobalPreloadBootstrap + PRELOAD_BOOTSTRAP_SIZE));
+}
+
+
+size_t MVMPreloadBootstrapSize(void *Memory)
+{
+    return(*(size_t *)((uint8_t *)Memory - PRELOAD_BOOTSTRAP_ALIGNMENT));
+}
+
+
+// NOTE(Marko): Returns 0 while the lookup is still in progress, in which 
+//              case the caller must fall back to the bootstrap buffer. 
+int MVMPreloadResolve(void)
+{
+    if(__atomic_load_n(&GlobalPreloadReal.Free, __ATOMIC_ACQUIRE))
+    {
+        return(1);
+    }
+    if(MVMAtomicCompareExchangeU32(&GlobalPreloadResolving, 0, 1) != 0)
+    {
+        // NOTE(Marko): Either our own dlsym() call allocating, or another 
+        //              thread resolving at the same moment, which only has 
+        //              to wait. 
+        if(ThreadLocalPreloadInTool)
+        {
+            return(0);
+        }
+        while(!__atomic_load_n(&GlobalPreloadReal.Free, __ATOMIC_ACQUIRE))
+        {
+            MVMPlatformYield();
+        }
+        return(1);
+    }
+
+    ThreadLocalPreloadInTool = 1;
+    preload_real_allocator Real;
+    Real.Malloc = (preload_malloc_proc *)dlsym(RTLD_NEXT, "malloc");
+    Real.Calloc = (preload_calloc_proc *)dlsym(RTLD_NEXT, "calloc");
+    Real.Realloc = (preload_realloc_proc *)dlsym(RTLD_NEXT, "realloc");
+    Real.PosixMemalign =
+        (preload_posix_memalign_proc *)dlsym(RTLD_NEXT, "posix_memalign");
+    Real.AlignedAlloc =
+        (preload_aligned_alloc_proc *)dlsym(RTLD_NEXT, "aligned_alloc");
+    Real.Memalign = (preload_aligned_alloc_proc *)dlsym(RTLD_NEXT, "memalign");
+    Real.Valloc = (preload_valloc_proc *)dlsym(RTLD_NEXT, "valloc");
+    Real.Pvalloc = (preload_valloc_proc *)dlsym(RTLD_NEXT, "pvalloc");
+    Real.MallocUsableSize =
+        (preload_malloc_usable_size_proc *)dlsym(RTLD_NEXT, "malloc_usable_size");
+    Real.Free = (preload_free_proc *)dlsym(RTLD_NEXT, "free");
+    ThreadLocalPreloadInTool = 0;
+
+    if(!Real.Malloc || !Real.Calloc || !Real.Realloc || !Real.Free)
+    {
+        // NOTE(Marko): Nothing sensible can continue without an allocator. 
+        static const char Message[] =
+            "mvm_debug_memory: could not find the real allocator.\n";
+        (void)!write(2, Message, sizeof(Message) - 1);
+        _exit(127);
+    }
+
+    // NOTE(Marko): Free is the flag other threads check, so it goes last. 
+    preload_free_proc *RealFree = Real.Free;
+    Real.Free = 0;
+    GlobalPreloadReal = Real;
+    __atomic_store_n(&GlobalPreloadReal.Free, RealFree, __ATOMIC_RELEASE);
+    return(1);
+}
+
+
+void *MVMPreloadRealMalloc(size_t Size)
+{
+    return(GlobalPreloadReal.Malloc(Size));
+}
+
+
+void *MVMPreloadRealCalloc(size_t Count, size_t Size)
+{
+    return(GlobalPreloadReal.Calloc(Count, Size));
+}
+
+
+void *MVMPreloadRealRealloc(void *Memory, size_t Size)
+{
+    return(GlobalPreloadReal.Realloc(Memory, Size));
+}
+
+
+void MVMPreloadRealFree(void *Memory)
+{
+    GlobalPreloadReal.Free(Memory);
+}
+
+
+int MVMPreloadRealPosixMemalign(void **Memory, size_t Alignment, size_t Size)
+{
+    return(GlobalPreloadReal.PosixMemalign(Memory, Alignment, Size));
+}
+
+
+// NOTE(Marko): Whether this call should be recorded. If so the thread is 
+//              marked as inside the tool and must call MVMPreloadLeaveTool(). 
+int MVMPreloadEnterTool(void)
+{
+    if(!GlobalPreloadRecording || ThreadLocalPreloadInTool)
+    {
+        return(0);
+    }
+    ThreadLocalPreloadInTool = 1;
+    return(1);
+}
+
+
+void MVMPreloadLeaveTool(void)
+{
+    ThreadLocalPreloadInTool = 0;
+}
+
+
+// NOTE(Marko): Every interposed entry point is a single tool frame above the 
+//              user's code when it calls MVMTrackAllocation(); the stack 
+//              capture skips it. They must stay out of line for that. 
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *malloc(size_t Size)
+{
+    if(!MVMPreloadResolve())
+    {
+        return(MVMPreloadBootstrapAllocate(Size));
+    }
+    void *Result = GlobalPreloadReal.Malloc(Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Size, 0, 
+                           AllocationKind_Malloc, 0, "<malloc>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *calloc(size_t Count, size_t Size)
+{
+    if(!MVMPreloadResolve())
+    {
+        // NOTE(Marko): The bootstrap buffer is static, so already zero. 
+        size_t TotalSize = 0;
+        if(__builtin_mul_overflow(Count, Size, &TotalSize))
+        {
+            return(0);
+        }
+        return(MVMPreloadBootstrapAllocate(TotalSize));
+    }
+    void *Result = GlobalPreloadReal.Calloc(Count, Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Count * Size, 0, 
+                           AllocationKind_Malloc, 0, "<calloc>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *realloc(void *Memory, size_t Size)
+{
+    if(!MVMPreloadResolve())
+    {
+        void *Result = MVMPreloadBootstrapAllocate(Size);
+        if(Result && Memory)
+        {
+            size_t OldSize = MVMPreloadBootstrapSize(Memory);
+            memcpy(Result, Memory, (OldSize < Size) ? OldSize : Size);
+        }
+        return(Result);
+    }
+    if(Memory && MVMPreloadIsBootstrap(Memory))
+    {
+        // NOTE(Marko): Move it to the real heap; the old block is not 
+        //              reclaimed. 
+        void *Result = malloc(Size);
+        if(Result)
+        {
+            size_t OldSize = MVMPreloadBootstrapSize(Memory);
+            memcpy(Result, Memory, (OldSize < Size) ? OldSize : Size);
+        }
+        return(Result);
+    }
+    if(!Memory)
+    {
+        void *Result = GlobalPreloadReal.Malloc(Size);
+        if(MVMPreloadEnterTool())
+        {
+            MVMTrackAllocation(Result, Size, 0, 
+                               AllocationKind_Malloc, 0, "<realloc>", 0, 1);
+            MVMPreloadLeaveTool();
+        }
+        return(Result);
+    }
+    if(!Size)
+    {
+        // NOTE(Marko): glibc's realloc(Memory, 0) frees Memory. 
+        if(MVMPreloadEnterTool())
+        {
+            MVMDebugFree(Memory, "<realloc>", 0);
+            MVMPreloadLeaveTool();
+        }
+        else
+        {
+            GlobalPreloadReal.Free(Memory);
+        }
+        return(0);
+    }
+
+    void *Result = 0;
+    if(MVMPreloadEnterTool())
+    {
+        Result = MVMDebugRealloc(Memory, Size, "<realloc>", 0);
+        MVMPreloadLeaveTool();
+    }
+    else
+    {
+        Result = GlobalPreloadReal.Realloc(Memory, Size);
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT
+void free(void *Memory)
+{
+    if(!Memory || MVMPreloadIsBootstrap(Memory))
+    {
+        return;
+    }
+    if(!MVMPreloadResolve())
+    {
+        // NOTE(Marko): Only bootstrap blocks can exist before the real 
+        //              allocator is known. 
+        return;
+    }
+    if(MVMPreloadEnterTool())
+    {
+        MVMDebugFree(Memory, "<free>", 0);
+        MVMPreloadLeaveTool();
+    }
+    else
+    {
+        GlobalPreloadReal.Free(Memory);
+    }
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+int posix_memalign(void **Memory, size_t Alignment, size_t Size)
+{
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.PosixMemalign)
+    {
+        return(ENOMEM);
+    }
+    int Result = GlobalPreloadReal.PosixMemalign(Memory, Alignment, Size);
+    if((Result == 0) && MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(*Memory, Size, Alignment, 
+                           AllocationKind_Malloc, 0, "<posix_memalign>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *aligned_alloc(size_t Alignment, size_t Size)
+{
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.AlignedAlloc)
+    {
+        return(0);
+    }
+    void *Result = GlobalPreloadReal.AlignedAlloc(Alignment, Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Size, Alignment, 
+                           AllocationKind_Malloc, 0, "<aligned_alloc>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *memalign(size_t Alignment, size_t Size)
+{
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.Memalign)
+    {
+        return(0);
+    }
+    void *Result = GlobalPreloadReal.Memalign(Alignment, Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Size, Alignment, 
+                           AllocationKind_Malloc, 0, "<memalign>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *valloc(size_t Size)
+{
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.Valloc)
+    {
+        return(0);
+    }
+    void *Result = GlobalPreloadReal.Valloc(Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Size, (size_t)getpagesize(), 
+                           AllocationKind_Malloc, 0, "<valloc>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT MVM_DEBUG_NOINLINE
+void *pvalloc(size_t Size)
+{
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.Pvalloc)
+    {
+        return(0);
+    }
+    void *Result = GlobalPreloadReal.Pvalloc(Size);
+    if(MVMPreloadEnterTool())
+    {
+        MVMTrackAllocation(Result, Size, (size_t)getpagesize(), 
+                           AllocationKind_Malloc, 0, "<pvalloc>", 0, 1);
+        MVMPreloadLeaveTool();
+    }
+    return(Result);
+}
+
+
+MVM_PRELOAD_EXPORT
+size_t malloc_usable_size(void *Memory)
+{
+    if(!Memory)
+    {
+        return(0);
+    }
+    if(MVMPreloadIsBootstrap(Memory))
+    {
+        return(MVMPreloadBootstrapSize(Memory));
+    }
+    if(!MVMPreloadResolve() || !GlobalPreloadReal.MallocUsableSize)
+    {
+        return(0);
+    }
+    return(GlobalPreloadReal.MallocUsableSize(Memory));
+}
+
+
+uint64_t MVMPreloadReadEnvironmentU64(const char *Name, uint64_t DefaultValue)
+{
+    const char *Value = getenv(Name);
+    return((Value && *Value) ? (uint64_t)strtoull(Value, 0, 0) : DefaultValue);
+}
+
+
+// NOTE(Marko): Registered after the tool's own leak check, so atexit() runs 
+//              it first: the reports must not record their own allocations. 
+void MVMPreloadStopRecording(void)
+{
+    ThreadLocalPreloadInTool = 1;
+    if(MVMAtomicCompareExchangeU32(&GlobalPreloadRecording, 1, 0) == 1)
+    {
+        MVMTurnOffDebugInfo();
+
+        // NOTE(Marko): The tool reports with printf(). The program is done 
+        //              writing by now, so point stdout at our copy of stderr 
+        //              to keep the reports out of its output (pipes, $(...) 
+        //              in scripts), even if the program has closed its own 
+        //              streams. glibc lets stdout be assigned. 
+        fflush(stdout);
+        FILE *ReportFile = 0;
+        if(GlobalPreloadReportDescriptor >= 0)
+        {
+            ReportFile = fdopen(GlobalPreloadReportDescriptor, "w");
+        }
+        if(ReportFile)
+        {
+            stdout = ReportFile;
+        }
+        else
+        {
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+        }
+
+        MVMDebugMemoryFlushQuarantine();
+        if(MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_PRINT_AT_EXIT", 0))
+        {
+            MVMDebugMemoryPrintAllocations();
+        }
+    }
+    ThreadLocalPreloadInTool = 0;
+}
+
+
+__attribute__((constructor))
+void MVMPreloadInitialize(void)
+{
+    MVMPreloadResolve();
+    if(!MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_ENABLED", 1))
+    {
+        return;
+    }
+
+    ThreadLocalPreloadInTool = 1;
+    // NOTE(Marko): Close-on-exec, so that programs we exec() do not hold a 
+    //              pipe on stderr open. 
+    GlobalPreloadReportDescriptor = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 0);
+
+    mvm_debug_memory_config Config = {0};
+    Config.MaxEventsCount =
+        (size_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_MAX_EVENTS", 0);
+    Config.MaxEventBytes =
+        (size_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_MAX_EVENT_BYTES", 0);
+    Config.SampleIntervalBytes =
+        (size_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_SAMPLE_BYTES", 0);
+    Config.TraceFilename = getenv("MVM_DEBUG_MEMORY_TRACE");
+    Config.TimelineResolutionMicroseconds =
+        (uint32_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_TIMELINE_US", 0);
+    Config.ReportLeaksAtExit =
+        (int)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_LEAK_REPORT", 1);
+    Config.LeakReportFilename = getenv("MVM_DEBUG_MEMORY_LEAK_FILE");
+    Config.LeakThresholdBytes =
+        (size_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_LEAK_THRESHOLD", 0);
+    Config.LeakExitCode =
+        (int)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_LEAK_EXIT_CODE", 0);
+    Config.StackDepth =
+        (uint32_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_STACK_DEPTH",
+                                               PRELOAD_STACK_DEPTH_DEFAULT);
+    Config.StackUseUnwinder =
+        (int)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_UNWINDER", 0);
+    Config.QuarantineBytes =
+        (size_t)MVMPreloadReadEnvironmentU64("MVM_DEBUG_MEMORY_QUARANTINE_BYTES", 0);
+    // NOTE(Marko): Anything allocated before this point, or by the loader, 
+    //              is freed without ever having been seen. 
+    Config.IgnoreUntrackedPointers = 1;
+
+    if(MVMDebugMemoryInitialize(&Config))
+    {
+        atexit(MVMPreloadStopRecording);
+        MVMTurnOnDebugInfo();
+        MVMAtomicStoreU32(&GlobalPreloadRecording, 1);
+    }
+    ThreadLocalPreloadInTool = 0;
+}
@@ -0,0 +1,114 @@
+#include "mvm_debug_memory.h"
+
+/* 
+    NOTE(Marko): Checks the event ring when one thread laps another. The 
+                 main thread takes one event block and leaves it mostly 
+                 empty, while a second thread makes more allocations than 
+                 the whole ring holds. Every live block's last event must 
+                 then still be its own allocation event, at its own 
+                 address, or be gone from the ring altogether. 
+
+                 Exits with 0 when the ring is consistent, 1 otherwise. 
+*/
+
+#define RING_TEST_LAPPING_COUNT \
+    (DEBUG_EVENT_RING_MIN_BLOCKS*DEBUG_EVENT_BLOCK_SIZE + 100)
+
+static void **LappingBlocks;
+
+
+static void LapRing(void *Parameter)
+{
+    (void)Parameter;
+    for(size_t BlockIndex = 0; 
+        BlockIndex < RING_TEST_LAPPING_COUNT; 
+        BlockIndex++)
+    {
+        LappingBlocks[BlockIndex] = malloc(16);
+    }
+}
+
+
+// NOTE(Marko): Returns how many live blocks have a last event that is not 
+//              their own allocation. 
+static size_t CheckLiveEvents(void)
+{
+    size_t Result = 0;
+    for(int ShardIndex = 0; 
+        ShardIndex < DEBUG_ADDRESS_TABLE_SHARD_COUNT; 
+        ShardIndex++)
+    {
+        mvm_debug_memory_address_table *AddressTable = 
+            GlobalDebugInfoList->AddressTables + ShardIndex;
+        for(size_t SlotIndex = 0; 
+            SlotIndex < AddressTable->SlotsAllocated; 
+            SlotIndex++)
+        {
+            mvm_debug_memory_info *Slot = AddressTable->Slots + SlotIndex;
+            if((Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_EMPTY) || 
+               (Slot->CurrentAddress == DEBUG_ADDRESS_TABLE_TOMBSTONE) || 
+               (Slot->LastEventIndex == DEBUG_EVENT_INDEX_NONE))
+            {
+                continue;
+            }
+            mvm_debug_memory_event *Event = MVMGetEvent(Slot->LastEventIndex);
+            if(Event && 
+               ((Event->Address != (uint64_t)(uintptr_t)Slot->CurrentAddress) || 
+                (MVMGetEventType(Event) != MemoryOperationType_InitialAllocation)))
+            {
+                printf("Block %p: event %llu belongs to %p.\n", 
+                       Slot->CurrentAddress, 
+                       (unsigned long long)Slot->LastEventIndex, 
+                       (void *)(uintptr_t)Event->Address);
+                Result++;
+            }
+        }
+    }
+    return(Result);
+}
+
+
+int main(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    mvm_debug_memory_config Config = {0};
+    Config.MaxEventsCount = 1;
+    MVMDebugMemoryInitialize(&Config);
+    MVMTurnOnDebugInfo();
+
+    LappingBlocks = (void **)MVM_DEBUG_REAL_MALLOC( 
+        (sizeof *LappingBlocks) * RING_TEST_LAPPING_COUNT);
+    void *First = malloc(100);
+
+    mvm_debug_memory_thread Thread;
+    if(!MVMPlatformCreateThread(&Thread, LapRing, 0))
+    {
+        printf("Unable to start the lapping thread.\n");
+        return(1);
+    }
+    MVMPlatformJoinThread(&Thread);
+
+    // NOTE(Marko): This thread's block has been lapped by now. 
+    free(First);
+    void *Second = malloc(200);
+
+    size_t BadCount = CheckLiveEvents();
+
+    free(Second);
+    for(size_t BlockIndex = 0; 
+        BlockIndex < RING_TEST_LAPPING_COUNT; 
+        BlockIndex++)
+    {
+        free(LappingBlocks[BlockIndex]);
+    }
+    MVM_DEBUG_REAL_FREE(LappingBlocks);
+
+    MVMTurnOffDebugInfo();
+    MVMDebugMemoryShutdown();
+
+    printf("%s: %zu blocks with a foreign last event.\n", 
+           BadCount ? "FAILED" : "OK", BadCount);
+    return(BadCount ? 1 : 0);
+}
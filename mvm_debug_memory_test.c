@@ -21,6 +21,8 @@ int main(int argc, char **argv)
 
     MVMDebugMemoryPrintAllocations();
 
+    MVMDebugMemoryShutdown();
+
 
     return(0);   
 }